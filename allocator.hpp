@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+//* Allocators for the Matrix storage, standard style so any std-compatible allocator plugs in too
+//*
+//* AlignedAllocator is the default: every buffer starts on a cache line (64 bytes, also an AVX-512 register),
+//* so the first element of every row is aligned as well when the leading dimension is padded.
+//* HugePageAllocator asks the kernel for transparent huge pages, fewer TLB misses on big matrices.
+
+namespace rage {
+
+template <typename T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                  "Alignment must be a power of two, at least alignof(T)");
+
+public:
+    using value_type = T;
+    static constexpr std::size_t alignment{Alignment};
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    constexpr AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    constexpr AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    [[nodiscard]] constexpr T* allocate(std::size_t count) {
+        if consteval {
+            return std::allocator<T>{}.allocate(count);
+        } else {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+        }
+    }
+
+    constexpr void deallocate(T* ptr, std::size_t count) noexcept {
+        if consteval {
+            std::allocator<T>{}.deallocate(ptr, count);
+        } else {
+            ::operator delete(ptr, count * sizeof(T), std::align_val_t{Alignment});
+        }
+    }
+
+    template <typename U>
+    constexpr bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+};
+
+//* Buffers of at least a huge page are aligned to one and advised with MADV_HUGEPAGE,
+//* smaller ones are not worth a 2 MiB page and fall back to cache line alignment.
+//* Only a hint: without THP (or outside Linux) it behaves like AlignedAllocator.
+template <typename T>
+class HugePageAllocator
+{
+public:
+    using value_type = T;
+    static constexpr std::size_t huge_page_size{2 * 1024 * 1024};
+
+    template <typename U>
+    struct rebind { using other = HugePageAllocator<U>; };
+
+    constexpr HugePageAllocator() noexcept = default;
+
+    template <typename U>
+    constexpr HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t count) {
+        const auto bytes{count * sizeof(T)};
+        if (bytes < huge_page_size)
+            return AlignedAllocator<T>{}.allocate(count);
+
+        void* ptr{::operator new(RoundUp_(bytes), std::align_val_t{huge_page_size})};
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        ::madvise(ptr, RoundUp_(bytes), MADV_HUGEPAGE);
+#endif
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, std::size_t count) noexcept {
+        const auto bytes{count * sizeof(T)};
+        if (bytes < huge_page_size)
+            return AlignedAllocator<T>{}.deallocate(ptr, count);
+
+        ::operator delete(ptr, RoundUp_(bytes), std::align_val_t{huge_page_size});
+    }
+
+    template <typename U>
+    constexpr bool operator==(const HugePageAllocator<U>&) const noexcept { return true; }
+
+private:
+    static constexpr std::size_t RoundUp_(std::size_t bytes) {
+        return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    }
+};
+
+//* A leading dimension (elements between the start of two rows) for cols columns of T:
+//* rows start on a 64 byte boundary, and rows whose size is a multiple of 512 bytes get one more cache line.
+//* Walking down a column of such a matrix (power of two widths: 64 doubles, 128 floats, ...) would keep
+//* hitting the same few L1 sets, the extra line spreads the rows over all of them.
+template <typename T>
+constexpr std::size_t PaddedLeadingDimension(std::size_t cols)
+{
+    constexpr std::size_t line{64};
+    if constexpr (line % sizeof(T) != 0) {
+        return cols;
+    } else {
+        constexpr std::size_t per_line{line / sizeof(T)};
+        auto ld{(cols + per_line - 1) / per_line * per_line};
+        if (ld != 0 && (ld * sizeof(T)) % 512 == 0)
+            ld += per_line;
+        return ld;
+    }
+}
+
+} // namespace rage
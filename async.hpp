@@ -0,0 +1,135 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+//* Asynchronous calls on the thread pool, rage::Async(fn) -> Future<R>
+//*
+//* fn runs as a pool task. Future::Get() does not block its thread: like a ParallelFor it runs queued
+//* tasks until the value is there, so waiting from inside a pool task cannot deadlock.
+//* A Future is also awaitable from any C++20 coroutine: co_await suspends it and the thread that
+//* finishes fn resumes it. Matrices are captured the way fn captures them: by reference, they must
+//* outlive the call.
+//*
+//*   auto ab{rage::Async([&] { return a * b; })};
+//*   auto cd{rage::Async([&] { return c * d; })};   // runs next to a * b
+//*   rage::Matrix<double> sum{ab.Get() + cd.Get()};
+
+namespace internal_impl {
+
+template <typename T>
+struct AsyncState_ {
+    using Stored = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    std::optional<Stored> value;
+    std::exception_ptr error;
+    std::atomic<bool> ready{false};
+    std::mutex mutex;                     //* orders ready against a coroutine registering
+    std::coroutine_handle<> continuation; //* the coroutine waiting in co_await, if any
+
+    template <typename F>
+    void Run(F& fn) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                fn();
+                value.emplace();
+            } else {
+                value.emplace(fn());
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        std::coroutine_handle<> waiting;
+        {
+            std::lock_guard lock{mutex};
+            ready.store(true, std::memory_order_release);
+            waiting = std::exchange(continuation, {});
+        }
+        if (waiting)
+            waiting.resume();
+    }
+
+    T Take() {
+        if (error)
+            std::rethrow_exception(error);
+        if constexpr (!std::is_void_v<T>)
+            return std::move(*value);
+    }
+};
+
+} // namespace internal_impl
+
+namespace rage {
+
+//* The result of Async: Get() (or co_await) it once
+template <typename T>
+class Future
+{
+public:
+    explicit Future(std::shared_ptr<internal_impl::AsyncState_<T>> state, ThreadPool& pool)
+        :   state_{std::move(state)},
+            pool_{&pool}
+    {}
+
+public:
+    bool Ready() const { return state_->ready.load(std::memory_order_acquire); }
+
+    //* runs other pool tasks until the result is there
+    void Wait() const { pool_->RunUntil([this] { return Ready(); }); }
+
+    //* the value fn returned, or the exception it threw
+    T Get() {
+        Wait();
+        return state_->Take();
+    }
+
+    auto operator co_await() {
+        struct Awaiter {
+            internal_impl::AsyncState_<T>& state;
+
+            bool await_ready() const { return state.ready.load(std::memory_order_acquire); }
+
+            //* false, do not suspend: fn finished in the meantime
+            bool await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard lock{state.mutex};
+                if (state.ready.load(std::memory_order_relaxed))
+                    return false;
+                state.continuation = handle;
+                return true;
+            }
+
+            T await_resume() { return state.Take(); }
+        };
+        return Awaiter{*state_};
+    }
+
+private:
+    std::shared_ptr<internal_impl::AsyncState_<T>> state_;
+    ThreadPool* pool_;
+};
+
+//* fn() as a task of the pool, right away; with a single thread pool it runs before Async returns
+template <typename F, typename R = std::invoke_result_t<std::decay_t<F>&>>
+Future<R> Async(F&& fn, ThreadPool& pool)
+{
+    auto state{std::make_shared<internal_impl::AsyncState_<R>>()};
+    // pool tasks are std::function, which copies: a move-only fn goes through a shared_ptr
+    pool.Submit([state, task = std::make_shared<std::decay_t<F>>(std::forward<F>(fn))] { state->Run(*task); });
+    return Future<R>{std::move(state), pool};
+}
+
+template <typename F>
+inline auto Async(F&& fn) { return Async(std::forward<F>(fn), ThreadPool::Default()); }
+
+} // namespace rage
@@ -0,0 +1,351 @@
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//* Micro-benchmarks of the kernels, the results go out as JSON (progress on stderr)
+//*
+//*   ./benchmark [--quick] [--filter text] [--threads n] [--min-time seconds]
+//*               [--max-size n] [--gemm-max-size n] [--naive-max-size n] [--out file.json]
+//*
+//* Cases are named kernel/type/variant: add, add_scalar, mul_scalar and gemm, on float, double and int,
+//* over a dense Matrix, a sub-view (offset and padded), a morph view, and "naive": plain loops over
+//* std::vector, the reference to beat. Sizes go 8, 64, 512, 2048, 8192 (n x n).
+//* A case runs until min-time has passed (and at least 3 samples); the median and best time per call are reported
+//* with the throughput: one operation per element (2 n^3 for a product), and the bytes read and written once.
+
+namespace {
+
+constexpr std::array<std::size_t, 5> Sizes{8, 64, 512, 2048, 8192};
+
+struct Options {
+    std::string filter;
+    std::string out;
+    std::size_t threads{0};
+    double min_time{0.2};
+    std::size_t max_size{8192};
+    std::size_t gemm_max_size{2048};
+    std::size_t naive_max_size{512};
+};
+
+struct Result {
+    std::string kernel;
+    std::string type;
+    std::string variant;
+    std::size_t size;
+    std::size_t calls;
+    double median_ns;
+    double best_ns;
+    double flops;
+    double bytes;
+};
+
+template <typename T>
+void KeepAlive(const T& value) { asm volatile("" : : "r"(&value) : "memory"); }
+
+template <typename T>
+constexpr std::string_view TypeName()
+{
+    if constexpr (std::is_same_v<T, float>)
+        return "float";
+    else if constexpr (std::is_same_v<T, double>)
+        return "double";
+    else
+        return "int";
+}
+
+std::string_view IsaName(internal_impl::simd::Isa isa)
+{
+    switch (isa) {
+        case internal_impl::simd::Isa::AVX512: return "AVX512";
+        case internal_impl::simd::Isa::AVX2:   return "AVX2";
+        case internal_impl::simd::Isa::SSE2:   return "SSE2";
+        case internal_impl::simd::Isa::Scalar: break;
+    }
+    return "Scalar";
+}
+
+class Bench
+{
+public:
+    explicit Bench(const Options& options)
+        :   options_{options}
+    {}
+
+public:
+    template <typename F>
+    void Run(std::string_view kernel, std::string_view type, std::string_view variant, std::size_t size,
+             double flops, double bytes, const F& fn) {
+        std::string name{kernel};
+        name.append("/").append(type).append("/").append(variant);
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos)
+            return;
+
+        using Clock = std::chrono::steady_clock;
+        const auto time{[&fn](std::size_t calls) {
+            const auto start{Clock::now()};
+            for (std::size_t call{0}; call < calls; ++call)
+                fn();
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        }};
+
+        //* calls per sample, so that a sample is long enough for the clock; these first runs warm the caches up
+        std::size_t calls{1};
+        while (time(calls) < 20'000 && calls < (std::size_t{1} << 20))
+            calls *= 2;
+
+        std::vector<double> samples;
+        double elapsed{0};
+        while (samples.size() < 3 || elapsed < options_.min_time * 1e9) {
+            const auto ns{time(calls)};
+            samples.push_back(ns / static_cast<double>(calls));
+            elapsed += ns;
+        }
+        std::ranges::sort(samples);
+
+        const Result result{std::string{kernel}, std::string{type}, std::string{variant}, size, samples.size() * calls,
+                            samples[samples.size() / 2], samples.front(), flops, bytes};
+        std::cerr << name << " " << size << ": " << result.median_ns / 1e6 << " ms, "
+                  << flops / result.median_ns << " GFLOP/s\n";
+        results_.push_back(result);
+    }
+
+    void Write(std::ostream& out) const {
+        out << "{\n"
+            << "  \"library\": \"rage\",\n"
+#ifdef __VERSION__
+            << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+#endif
+            << "  \"isa\": \"" << IsaName(internal_impl::simd::ActiveIsa()) << "\",\n"
+            << "  \"threads\": " << rage::ThreadPool::Default().ThreadsCount() << ",\n"
+            << "  \"min_time_s\": " << options_.min_time << ",\n"
+            << "  \"results\": [";
+        for (std::size_t i{0}; i < results_.size(); ++i) {
+            const auto& result{results_[i]};
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\"kernel\": \"" << result.kernel << "\", \"type\": \"" << result.type
+                << "\", \"variant\": \"" << result.variant << "\", \"size\": " << result.size
+                << ", \"calls\": " << result.calls << ", \"median_ns\": " << result.median_ns
+                << ", \"best_ns\": " << result.best_ns << ", \"gflops\": " << result.flops / result.median_ns
+                << ", \"gbps\": " << result.bytes / result.median_ns << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+private:
+    const Options& options_;
+    std::vector<Result> results_;
+};
+
+template <typename T>
+T Value(std::size_t r, std::size_t c) { return static_cast<T>((r * 7 + c * 3) % 13); }
+
+template <typename T>
+rage::Matrix<T> Filled(std::size_t rows, std::size_t cols)
+{
+    rage::Matrix<T> m(rows, cols);
+    for (std::size_t r{0}; r < rows; ++r) {
+        for (std::size_t c{0}; c < cols; ++c)
+            m.At(r, c) = Value<T>(r, c);
+    }
+    return m;
+}
+
+template <typename T>
+std::vector<T> FilledVector(std::size_t n)
+{
+    std::vector<T> v(n * n);
+    for (std::size_t r{0}; r < n; ++r) {
+        for (std::size_t c{0}; c < n; ++c)
+            v[r * n + c] = Value<T>(r, c);
+    }
+    return v;
+}
+
+//* out = x + y, x + 3 and x * 3
+template <typename T, typename X, typename Y>
+void ElementwiseCases(Bench& bench, std::string_view variant, std::size_t n, const X& x, const Y& y, rage::Matrix<T>& out)
+{
+    const auto elements{static_cast<double>(n * n)};
+    const auto bytes{elements * sizeof(T)};
+    bench.Run("add", TypeName<T>(), variant, n, elements, 3 * bytes, [&] { out = x + y; KeepAlive(out); });
+    bench.Run("add_scalar", TypeName<T>(), variant, n, elements, 2 * bytes, [&] { out = x + T{3}; KeepAlive(out); });
+    bench.Run("mul_scalar", TypeName<T>(), variant, n, elements, 2 * bytes, [&] { out = x * T{3}; KeepAlive(out); });
+}
+
+template <typename T>
+void Elementwise(Bench& bench, const Options& options, std::size_t n)
+{
+    rage::Matrix<T> out(n, n);
+    {
+        const auto a{Filled<T>(n, n)};
+        const auto b{Filled<T>(n, n)};
+        ElementwiseCases(bench, "dense", n, a, b, out);
+        ElementwiseCases(bench, "morph", n, a.View([](const T& elem) { return elem; }), b, out);
+    }
+    {
+        const auto a{Filled<T>(n + 1, n + 3)};
+        const auto b{Filled<T>(n + 1, n + 3)};
+        ElementwiseCases(bench, "subview", n, a.View({1, n + 1}, {1, n + 1}), b.View({1, n + 1}, {1, n + 1}), out);
+    }
+
+    if (n > options.naive_max_size)
+        return;
+    const auto a{FilledVector<T>(n)};
+    const auto b{FilledVector<T>(n)};
+    std::vector<T> c(n * n);
+    const auto elements{static_cast<double>(n * n)};
+    const auto bytes{elements * sizeof(T)};
+    bench.Run("add", TypeName<T>(), "naive", n, elements, 3 * bytes, [&] {
+        for (std::size_t i{0}; i < n * n; ++i)
+            c[i] = a[i] + b[i];
+        KeepAlive(c);
+    });
+    bench.Run("add_scalar", TypeName<T>(), "naive", n, elements, 2 * bytes, [&] {
+        for (std::size_t i{0}; i < n * n; ++i)
+            c[i] = a[i] + T{3};
+        KeepAlive(c);
+    });
+    bench.Run("mul_scalar", TypeName<T>(), "naive", n, elements, 2 * bytes, [&] {
+        for (std::size_t i{0}; i < n * n; ++i)
+            c[i] = a[i] * T{3};
+        KeepAlive(c);
+    });
+}
+
+template <typename T>
+void Products(Bench& bench, const Options& options, std::size_t n)
+{
+    const auto flops{2.0 * static_cast<double>(n) * static_cast<double>(n) * static_cast<double>(n)};
+    const auto bytes{3.0 * static_cast<double>(n * n * sizeof(T))};
+    {
+        const auto a{Filled<T>(n, n)};
+        const auto b{Filled<T>(n, n)};
+        bench.Run("gemm", TypeName<T>(), "dense", n, flops, bytes, [&] { KeepAlive(a * b); });
+        bench.Run("gemm", TypeName<T>(), "morph", n, flops, bytes, [&] { KeepAlive(a.View([](const T& elem) { return elem; }) * b); });
+    }
+    {
+        const auto a{Filled<T>(n + 1, n + 3)};
+        const auto b{Filled<T>(n + 1, n + 3)};
+        bench.Run("gemm", TypeName<T>(), "subview", n, flops, bytes, [&] {
+            KeepAlive(a.View({1, n + 1}, {1, n + 1}) * b.View({1, n + 1}, {1, n + 1}));
+        });
+    }
+
+    if (n > options.naive_max_size)
+        return;
+    const auto a{FilledVector<T>(n)};
+    const auto b{FilledVector<T>(n)};
+    std::vector<T> c(n * n);
+    bench.Run("gemm", TypeName<T>(), "naive", n, flops, bytes, [&] {
+        for (std::size_t i{0}; i < n; ++i) {
+            for (std::size_t j{0}; j < n; ++j) {
+                T sum{};
+                for (std::size_t k{0}; k < n; ++k)
+                    sum += a[i * n + k] * b[k * n + j];
+                c[i * n + j] = sum;
+            }
+        }
+        KeepAlive(c);
+    });
+}
+
+[[noreturn]] void Usage(std::string_view error, int status = 2)
+{
+    if (!error.empty())
+        std::cerr << error << "\n";
+    std::cerr << "usage: benchmark [--quick] [--filter text] [--threads n] [--min-time seconds]\n"
+              << "                 [--max-size n] [--gemm-max-size n] [--naive-max-size n] [--out file.json]\n";
+    std::exit(status);
+}
+
+Options ParseOptions(int argc, char** argv)
+{
+    Options options;
+    const auto value{[&](int& i) {
+        if (i + 1 >= argc)
+            Usage(std::string{argv[i]} + " needs a value");
+        return std::string_view{argv[++i]};
+    }};
+    const auto number{[&](int& i) {
+        const auto text{value(i)};
+        char* end{nullptr};
+        const auto parsed{std::strtod(text.data(), &end)};
+        if (end != text.data() + text.size() || parsed < 0)
+            Usage("bad number " + std::string{text});
+        return parsed;
+    }};
+
+    for (int i{1}; i < argc; ++i) {
+        const std::string_view arg{argv[i]};
+        if (arg == "--help") {
+            Usage("", 0);
+        } else if (arg == "--quick") {
+            options.min_time = 0.05;
+            options.max_size = std::min<std::size_t>(options.max_size, 512);
+            options.gemm_max_size = std::min<std::size_t>(options.gemm_max_size, 512);
+        } else if (arg == "--filter") {
+            options.filter = value(i);
+        } else if (arg == "--out") {
+            options.out = value(i);
+        } else if (arg == "--threads") {
+            options.threads = static_cast<std::size_t>(number(i));
+        } else if (arg == "--min-time") {
+            options.min_time = number(i);
+        } else if (arg == "--max-size") {
+            options.max_size = static_cast<std::size_t>(number(i));
+        } else if (arg == "--gemm-max-size") {
+            options.gemm_max_size = static_cast<std::size_t>(number(i));
+        } else if (arg == "--naive-max-size") {
+            options.naive_max_size = static_cast<std::size_t>(number(i));
+        } else {
+            Usage("unknown option " + std::string{arg});
+        }
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const auto options{ParseOptions(argc, argv)};
+    if (options.threads != 0)
+        rage::ThreadPool::SetDefaultThreadsCount(options.threads);
+
+    Bench bench{options};
+    for (const auto n : Sizes) {
+        if (n > options.max_size)
+            break;
+        Elementwise<float>(bench, options, n);
+        Elementwise<double>(bench, options, n);
+        Elementwise<int>(bench, options, n);
+    }
+    for (const auto n : Sizes) {
+        if (n > options.gemm_max_size)
+            break;
+        Products<float>(bench, options, n);
+        Products<double>(bench, options, n);
+        Products<int>(bench, options, n);
+    }
+
+    if (options.out.empty()) {
+        bench.Write(std::cout);
+        return 0;
+    }
+    std::ofstream file{options.out};
+    bench.Write(file);
+    if (!file) {
+        std::cerr << "Could not write " << options.out << "\n";
+        return 1;
+    }
+    return 0;
+}
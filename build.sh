@@ -1 +1,2 @@
-g++ -g -std=c++23 -Wall -Wpedantic -Wextra -Werror -Wconversion -Wshadow -Wundef -Wunused -fdiagnostics-show-template-tree -o tester_small test_small.cpp
\ No newline at end of file
+g++ -g -std=c++23 -pthread -Wall -Wpedantic -Wextra -Werror -Wconversion -Wshadow -Wundef -Wunused -fdiagnostics-show-template-tree -o tester_small test_small.cpp
+g++ -O3 -march=native -DNDEBUG -std=c++23 -pthread -Wall -Wpedantic -Wextra -Werror -Wconversion -Wshadow -Wundef -Wunused -o benchmark benchmark.cpp
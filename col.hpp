@@ -6,72 +6,77 @@
 namespace rage {
 
 // can rename to NonContiguousIterator
+//* Random access over every next_col_offset-th element; with a morph the elements are returned by value
 template <typename T, typename Morph>
 class ColumnIterator
 {
 public:
-    using iterator_category = std::forward_iterator_tag;
-    using difference_type   = std::ptrdiff_t;
-    using value_type        = T;
-    using pointer           = value_type*;
-    using reference         = value_type&;
-
-    using RealValueType = std::conditional_t<std::is_same_v<Morph, internal_impl::DefaultMorph<T>>,
+    using RealValueType = std::conditional_t<internal_impl::IsDefaultMorph<Morph>,
                                              T,
                                              std::invoke_result_t<Morph, T>>;
 
-    explicit ColumnIterator(T* start, std::size_t next_col_offset, std::optional<Morph> morph)
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::conditional_t<internal_impl::IsDefaultMorph<Morph>,
+                                                 std::random_access_iterator_tag,
+                                                 std::input_iterator_tag>;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = std::remove_cvref_t<RealValueType>;
+    using reference         = std::conditional_t<internal_impl::IsDefaultMorph<Morph>, T&, RealValueType>;
+
+    constexpr explicit ColumnIterator(T* start, std::size_t next_col_offset, Morph morph = {})
     :   start_{start},
-        next_col_offset_{next_col_offset}
-    {
-        if constexpr(!std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-            morph_ = morph.value();
-    }
+        next_col_offset_{next_col_offset},
+        morph_{std::move(morph)}
+    {}
 
-    explicit ColumnIterator(){} //! removing this breaks std::ranges::range<Matrix<T>>, aka breaks everything
+    constexpr ColumnIterator() = default; //! removing this breaks std::ranges::range<Matrix<T>>, aka breaks everything
 
-    reference operator*() const {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>) {
+    constexpr reference operator*() const {
+        if constexpr (internal_impl::IsDefaultMorph<Morph>)
             return *start_;
-        } else {
-            morphed_val_ = morph_(*start_);
-            return morphed_val_.value();
-        }
+        else
+            return morph_(*start_);
     }
 
-    pointer operator->() {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>) {
-            return start_;
-        } else {
-            morphed_val_ = morph_(*start_);
-            return &(morphed_val_.value());
-        }
-    }
+    constexpr reference operator[](difference_type n) const { return *(*this + n); }
 
-    ColumnIterator& operator++() {
-        start_ += next_col_offset_;
-        return *this;
-    }
+    constexpr ColumnIterator& operator++() { start_ += next_col_offset_; return *this; }
+    constexpr ColumnIterator& operator--() { start_ -= next_col_offset_; return *this; }
 
     // postfix
-    value_type operator++(int) {
+    constexpr ColumnIterator operator++(int) {
         auto cpy{*this};
         ++(*this);
         return cpy;
     }
-    
-    friend inline bool operator==(const ColumnIterator& a, const ColumnIterator& b) {
-        return a.start_ == b.start_;
+
+    constexpr ColumnIterator operator--(int) {
+        auto cpy{*this};
+        --(*this);
+        return cpy;
+    }
+
+    constexpr ColumnIterator& operator+=(difference_type n) {
+        start_ += n * static_cast<difference_type>(next_col_offset_);
+        return *this;
     }
+    constexpr ColumnIterator& operator-=(difference_type n) { return *this += -n; }
+
+    friend constexpr ColumnIterator operator+(ColumnIterator it, difference_type n) { return it += n; }
+    friend constexpr ColumnIterator operator+(difference_type n, ColumnIterator it) { return it += n; }
+    friend constexpr ColumnIterator operator-(ColumnIterator it, difference_type n) { return it -= n; }
 
-    friend inline bool operator!=(const ColumnIterator& a, const ColumnIterator& b) {
-        return a.start_ != b.start_;
+    friend constexpr difference_type operator-(const ColumnIterator& a, const ColumnIterator& b) {
+        return a.next_col_offset_ == 0 ? 0 : (a.start_ - b.start_) / static_cast<difference_type>(a.next_col_offset_);
     }
+
+    friend constexpr bool operator==(const ColumnIterator& a, const ColumnIterator& b) { return a.start_ == b.start_; }
+    friend constexpr auto operator<=>(const ColumnIterator& a, const ColumnIterator& b) { return a.start_ <=> b.start_; }
+
 private:
-    T* start_;
-    std::size_t next_col_offset_;
-    Morph morph_;
-    std::optional<RealValueType> morphed_val_;
+    T* start_{nullptr};
+    std::size_t next_col_offset_{0};
+    [[no_unique_address]] Morph morph_{};
 };
 
 
@@ -79,32 +84,30 @@ template <typename T, typename Morph = internal_impl::DefaultMorph<T>>
 class Column
 {
     //using S = std::remove_const_t<T>;
-    using RealValueType = std::conditional_t<std::is_same_v<Morph, internal_impl::DefaultMorph<T>>,
+    using RealValueType = std::conditional_t<internal_impl::IsDefaultMorph<Morph>,
                                              T,
                                              std::invoke_result_t<Morph, T>>;
 
 public:
-    constexpr explicit Column(T* start, std::size_t next_col_offset, std::size_t cols_count,
-                    std::optional<Morph> morph = std::nullopt)
+    constexpr explicit Column(T* start, std::size_t next_col_offset, std::size_t cols_count, Morph morph = {})
         :   start_{start},
             next_col_offset_{next_col_offset},
-            size_{cols_count}
-    {
-        if constexpr (!std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-            morph_ = morph.value();
-    }
+            size_{cols_count},
+            morph_{std::move(morph)}
+    {}
+    constexpr Column() = default;
     
-    constexpr std::conditional_t<std::is_same_v<Morph, internal_impl::DefaultMorph<T>>, T&, RealValueType>
+    constexpr std::conditional_t<internal_impl::IsDefaultMorph<Morph>, T&, RealValueType>
     operator[](std::size_t idx) {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
+        if constexpr (internal_impl::IsDefaultMorph<Morph>)
             return start_[idx * next_col_offset_];
         else
             return morph_(start_[idx * next_col_offset_]);
     }
     
-    constexpr std::conditional_t<std::is_same_v<Morph, internal_impl::DefaultMorph<T>>, const T&, RealValueType>
+    constexpr std::conditional_t<internal_impl::IsDefaultMorph<Morph>, const T&, RealValueType>
     operator[](std::size_t idx) const {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
+        if constexpr (internal_impl::IsDefaultMorph<Morph>)
             return start_[idx * next_col_offset_];
         else
             return morph_(start_[idx * next_col_offset_]);
@@ -112,13 +115,14 @@ public:
     
     //TODO since this is a range, to keep the api the same, maybe change to size() with lowercase s
     constexpr std::size_t Size() const { return size_; }
+    constexpr std::size_t size() const { return size_; }
 
     //* Iterators
     ColumnIterator<T, Morph> begin() { return ColumnIterator<T, Morph>{start_, next_col_offset_, morph_}; }
-    ColumnIterator<T, Morph> end() { return ColumnIterator<T, Morph>{start_ + next_col_offset_ * size_, 0, morph_}; }
+    ColumnIterator<T, Morph> end() { return ColumnIterator<T, Morph>{start_ + next_col_offset_ * size_, next_col_offset_, morph_}; }
     
     ColumnIterator<const T, Morph> begin() const { return ColumnIterator<const T, Morph>{start_, next_col_offset_, morph_}; }
-    ColumnIterator<const T, Morph> end() const { return ColumnIterator<const T, Morph>{start_ + next_col_offset_ * size_, 0, morph_}; }
+    ColumnIterator<const T, Morph> end() const { return ColumnIterator<const T, Morph>{start_ + next_col_offset_ * size_, next_col_offset_, morph_}; }
     
     ColumnIterator<const T, Morph> cbegin() const { return begin(); }
     ColumnIterator<const T, Morph> cend() const { return end(); }
@@ -127,7 +131,64 @@ private:
     T* start_;
     std::size_t next_col_offset_;
     std::size_t size_;
-    Morph morph_;
+    [[no_unique_address]] Morph morph_;
+};
+
+//* The rows of a column-major matrix/view: every row is a strided Column, the next one starts one element later
+template <typename T, typename Morph = internal_impl::DefaultMorph<T>>
+class StridedRowIterator
+{
+public:
+    using iterator_concept  = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type        = Column<T, Morph>;
+    using reference         = value_type;
+
+    constexpr explicit StridedRowIterator(T* start, std::size_t element_offset, std::size_t cols_count, Morph morph = {})
+        :   start_{start},
+            element_offset_{element_offset},
+            cols_count_{cols_count},
+            morph_{std::move(morph)}
+    {}
+
+    constexpr StridedRowIterator() = default; //! same as MatrixIterator, needed for std::ranges::range
+
+    constexpr reference operator*() const { return value_type{start_, element_offset_, cols_count_, morph_}; }
+    constexpr reference operator[](difference_type n) const { return *(*this + n); }
+
+    constexpr StridedRowIterator& operator++() { ++start_; return *this; }
+    constexpr StridedRowIterator& operator--() { --start_; return *this; }
+
+    // postfix
+    constexpr StridedRowIterator operator++(int) {
+        auto cpy{*this};
+        ++(*this);
+        return cpy;
+    }
+
+    constexpr StridedRowIterator operator--(int) {
+        auto cpy{*this};
+        --(*this);
+        return cpy;
+    }
+
+    constexpr StridedRowIterator& operator+=(difference_type n) { start_ += n; return *this; }
+    constexpr StridedRowIterator& operator-=(difference_type n) { start_ -= n; return *this; }
+
+    friend constexpr StridedRowIterator operator+(StridedRowIterator it, difference_type n) { return it += n; }
+    friend constexpr StridedRowIterator operator+(difference_type n, StridedRowIterator it) { return it += n; }
+    friend constexpr StridedRowIterator operator-(StridedRowIterator it, difference_type n) { return it -= n; }
+    friend constexpr difference_type operator-(const StridedRowIterator& a, const StridedRowIterator& b) { return a.start_ - b.start_; }
+
+    friend constexpr bool operator==(const StridedRowIterator& a, const StridedRowIterator& b) { return a.start_ == b.start_; }
+    friend constexpr auto operator<=>(const StridedRowIterator& a, const StridedRowIterator& b) { return a.start_ <=> b.start_; }
+
+private:
+    T* start_{nullptr};
+    std::size_t element_offset_{0};
+    std::size_t cols_count_{0};
+    [[no_unique_address]] Morph morph_{};
 };
 
 } // namespace rage
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "simd.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <type_traits>
+
+//* Comparison kernels over strided buffers (lines x length, ld between the start of two lines)
+//*
+//* Exact: types whose value is their bytes (integers...) are compared with memcmp, float and double with
+//* the SIMD FirstMismatch (an ordered compare: NaN != NaN and -0 == +0, like operator==), both stop at
+//* the first difference. Dense buffers are one run, padded ones one run per line.
+//*
+//* Approximate: a and b are close when a == b, |a - b| <= abs_tol, |a - b| <= rel_tol * max(|a|, |b|)
+//* or when at most ulps representable values separate them. NaN is close to nothing.
+//* A block is first checked against the tolerances with a branch-free loop the compiler vectorizes,
+//* only a block that fails goes through the full element by element test.
+
+namespace rage {
+
+//* ApproxEqual's answer: converts to bool, and tells where the first difference is
+struct ApproxResult {
+    bool equal{true};
+    bool same_shape{true};
+    std::size_t row{0}; //* of the first mismatch when !equal and same_shape
+    std::size_t col{0};
+
+    constexpr explicit operator bool() const { return equal; }
+};
+
+} // namespace rage
+
+namespace internal_impl {
+
+template <typename T>
+bool LinesEqual(const T* a, std::size_t lda, const T* b, std::size_t ldb, std::size_t lines, std::size_t length)
+{
+    constexpr bool bytewise{std::has_unique_object_representations_v<T>};
+    if constexpr (bytewise) {
+        if (a == b && lda == ldb)
+            return true;
+    }
+
+    const auto run_equal{[](const T* x, const T* y, std::size_t n) {
+        if constexpr (bytewise)
+            return n == 0 || std::memcmp(x, y, n * sizeof(T)) == 0;
+        else
+            return simd::FirstMismatch(x, y, n) == n;
+    }};
+
+    if (lda == length && ldb == length)
+        return run_equal(a, b, lines * length);
+
+    for (std::size_t line{0}; line < lines; ++line) {
+        if (!run_equal(a + line * lda, b + line * ldb, length))
+            return false;
+    }
+    return true;
+}
+
+template <std::floating_point T>
+struct Tolerance {
+    T abs_tol;
+    T rel_tol;
+    std::uint64_t ulps;
+};
+
+//* how many representable values lie between a and b (both finite or infinite, not NaN)
+template <std::floating_point T>
+std::uint64_t UlpDistance(T a, T b)
+{
+    using Int = std::conditional_t<sizeof(T) == 8, std::int64_t, std::int32_t>;
+    using UInt = std::make_unsigned_t<Int>;
+    // integers in the order of the floats: negative ones are sign-magnitude, flip them
+    const auto ordered{[](T v) {
+        const auto bits{std::bit_cast<Int>(v)};
+        return bits < 0 ? static_cast<Int>(std::numeric_limits<Int>::min() - bits) : bits;
+    }};
+    const auto x{ordered(a)};
+    const auto y{ordered(b)};
+    return x >= y ? static_cast<UInt>(static_cast<UInt>(x) - static_cast<UInt>(y))
+                  : static_cast<UInt>(static_cast<UInt>(y) - static_cast<UInt>(x));
+}
+
+template <std::floating_point T>
+bool Close(T a, T b, const Tolerance<T>& tol)
+{
+    if (a == b)
+        return true;
+    if (std::isnan(a) || std::isnan(b))
+        return false;
+    const auto diff{std::abs(a - b)};
+    return diff <= tol.abs_tol || diff <= tol.rel_tol * std::max(std::abs(a), std::abs(b)) || UlpDistance(a, b) <= tol.ulps;
+}
+
+inline constexpr std::size_t ApproxBlock{64};
+
+//* index of the first element of a that is not close to the one of b, n when there is none
+template <std::floating_point T>
+std::size_t FirstApproxMismatch(const T* a, const T* b, std::size_t n, const Tolerance<T>& tol)
+{
+    for (std::size_t first{0}; first < n; first += ApproxBlock) {
+        const auto last{std::min(n, first + ApproxBlock)};
+        // no branch and no early exit: NaNs and infinities fail here too and get the exact test below
+        bool all_close{true};
+        for (std::size_t i{first}; i < last; ++i) {
+            const auto diff{std::abs(a[i] - b[i])};
+            all_close &= diff <= std::max(tol.abs_tol, tol.rel_tol * std::max(std::abs(a[i]), std::abs(b[i])));
+        }
+        if (all_close)
+            continue;
+
+        for (std::size_t i{first}; i < last; ++i) {
+            if (!Close(a[i], b[i], tol))
+                return i;
+        }
+    }
+    return n;
+}
+
+} // namespace internal_impl
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+//* Delimited text (CSV) straight into a Matrix
+//*
+//* ParseCsv(text) never builds rows: a first pass counts the lines (memchr, at memory speed), the Matrix
+//* is allocated once and every line is parsed in place into its row with std::from_chars.
+//* Big inputs are cut in blocks on line boundaries, the blocks are counted and parsed in parallel.
+//* CsvReader takes the text in chunks of any size (a socket, a decompressor...), a line may span chunks.
+//*
+//* Fields are numbers, optionally surrounded by spaces or tabs; no quoting. Blank lines are skipped,
+//* "\r\n" line ends are fine. Malformed input throws std::runtime_error naming the row.
+
+namespace rage {
+
+struct CsvOptions {
+    char delimiter{','};
+    bool has_header{false}; //* skip the first line
+};
+
+} // namespace rage
+
+namespace internal_impl {
+
+inline constexpr std::size_t CsvBlockSize{1 << 20};
+
+[[noreturn]] inline void CsvError_(std::size_t row, const char* what)
+{
+    throw std::runtime_error{"CSV row " + std::to_string(row) + ": " + what};
+}
+
+//* end of the line starting at first, the '\n' or end
+inline const char* CsvLineEnd_(const char* first, const char* end)
+{
+    const auto* newline{static_cast<const char*>(std::memchr(first, '\n', static_cast<std::size_t>(end - first)))};
+    return newline != nullptr ? newline : end;
+}
+
+inline std::string_view CsvTrimLine_(const char* first, const char* last)
+{
+    if (last != first && last[-1] == '\r')
+        --last;
+    return std::string_view{first, static_cast<std::size_t>(last - first)};
+}
+
+inline bool CsvIsBlank_(std::string_view line)
+{
+    return line.find_first_not_of(" \t") == std::string_view::npos;
+}
+
+inline std::size_t CsvFieldsCount(std::string_view line, char delimiter)
+{
+    return static_cast<std::size_t>(std::count(line.begin(), line.end(), delimiter)) + 1;
+}
+
+//* fn(line) for the non blank lines in [first, end)
+template <typename F>
+void ForEachCsvLine_(const char* first, const char* end, const F& fn)
+{
+    while (first < end) {
+        const char* last{CsvLineEnd_(first, end)};
+        const auto line{CsvTrimLine_(first, last)};
+        if (!CsvIsBlank_(line))
+            fn(line);
+        first = last == end ? end : last + 1;
+    }
+}
+
+//* the cols fields of line into out, false if it does not hold exactly cols numbers
+template <typename T>
+bool ParseCsvLine(std::string_view line, char delimiter, T* out, std::size_t cols)
+{
+    const char* p{line.data()};
+    const char* end{line.data() + line.size()};
+    const auto skip_blanks{[&] {
+        while (p != end && (*p == ' ' || *p == '\t'))
+            ++p;
+    }};
+
+    for (std::size_t c{0}; c < cols; ++c) {
+        skip_blanks();
+        if (p != end && *p == '+') // from_chars takes no explicit plus sign
+            ++p;
+        const auto [next, error]{std::from_chars(p, end, out[c])};
+        if (error != std::errc{})
+            return false;
+        p = next;
+        skip_blanks();
+        if (c + 1 < cols) {
+            if (p == end || *p != delimiter)
+                return false;
+            ++p;
+        }
+    }
+    return p == end;
+}
+
+//* the first line with data after the header, empty when there is none
+inline std::string_view CsvFirstLine_(const char*& first, const char* end, bool has_header)
+{
+    bool header_pending{has_header};
+    while (first < end) {
+        const char* last{CsvLineEnd_(first, end)};
+        const auto line{CsvTrimLine_(first, last)};
+        if (header_pending) {
+            header_pending = false;
+        } else if (!CsvIsBlank_(line)) {
+            return line;
+        }
+        first = last == end ? end : last + 1;
+    }
+    return {};
+}
+
+} // namespace internal_impl
+
+namespace rage {
+
+template <typename T>
+Matrix<T> ParseCsv(std::string_view text, const CsvOptions& options, ThreadPool& pool)
+{
+    const char* first{text.data()};
+    const char* end{text.data() + text.size()};
+    const auto first_line{internal_impl::CsvFirstLine_(first, end, options.has_header)};
+    const auto cols{first_line.empty() ? 0 : internal_impl::CsvFieldsCount(first_line, options.delimiter)};
+
+    //* blocks start right after a '\n', so every line belongs to exactly one of them
+    const auto length{static_cast<std::size_t>(end - first)};
+    const auto blocks_count{pool.ThreadsCount() == 1 ? 1 : std::clamp<std::size_t>(length / internal_impl::CsvBlockSize, 1, pool.ThreadsCount() * 4)};
+    std::vector<const char*> starts(blocks_count + 1, end);
+    starts[0] = first;
+    for (std::size_t b{1}; b < blocks_count; ++b) {
+        const char* cut{std::max(first + b * (length / blocks_count), starts[b - 1])};
+        starts[b] = std::min(internal_impl::CsvLineEnd_(cut, end) + 1, end);
+    }
+
+    std::vector<std::size_t> first_rows(blocks_count + 1, 0);
+    pool.ParallelFor(0, blocks_count, 1, [&](std::size_t block_first, std::size_t block_last) {
+        for (std::size_t b{block_first}; b < block_last; ++b)
+            internal_impl::ForEachCsvLine_(starts[b], starts[b + 1], [&](std::string_view) { ++first_rows[b + 1]; });
+    });
+    for (std::size_t b{0}; b < blocks_count; ++b)
+        first_rows[b + 1] += first_rows[b];
+
+    Matrix<T> result(first_rows.back(), cols);
+    pool.ParallelFor(0, blocks_count, 1, [&](std::size_t block_first, std::size_t block_last) {
+        for (std::size_t b{block_first}; b < block_last; ++b) {
+            auto row{first_rows[b]};
+            internal_impl::ForEachCsvLine_(starts[b], starts[b + 1], [&](std::string_view line) {
+                if (!internal_impl::ParseCsvLine(line, options.delimiter, result.RawData() + row * result.LeadingDimension(), cols))
+                    internal_impl::CsvError_(row, "malformed line or wrong number of fields");
+                ++row;
+            });
+        }
+    });
+
+    return result;
+}
+
+template <typename T>
+inline Matrix<T> ParseCsv(std::string_view text, const CsvOptions& options = {})
+{
+    return ParseCsv<T>(text, options, ThreadPool::Default());
+}
+
+//* the whole file in memory, then ParseCsv. Throws std::system_error when it cannot be read
+template <typename T>
+Matrix<T> ReadCsv(const std::filesystem::path& path, const CsvOptions& options, ThreadPool& pool)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+        throw std::system_error{std::make_error_code(std::errc::no_such_file_or_directory), "Could not open " + path.string()};
+
+    std::string text(static_cast<std::size_t>(std::filesystem::file_size(path)), '\0');
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+    if (!file)
+        throw std::system_error{std::make_error_code(std::errc::io_error), "Could not read " + path.string()};
+    return ParseCsv<T>(text, options, pool);
+}
+
+template <typename T>
+inline Matrix<T> ReadCsv(const std::filesystem::path& path, const CsvOptions& options = {})
+{
+    return ReadCsv<T>(path, options, ThreadPool::Default());
+}
+
+//* Incremental parsing, e.g.
+//*   CsvReader<float> reader;
+//*   while (auto chunk{next_chunk()}) reader.Feed(*chunk);
+//*   Matrix<float> m{reader.Finish()};
+//* Complete lines are parsed as soon as they arrive, only an unfinished last line is kept aside.
+//* The values wait in one growing buffer, Finish() copies it into the Matrix once the row count is known.
+template <typename T>
+class CsvReader
+{
+public:
+    explicit CsvReader(const CsvOptions& options = {})
+        :   options_{options},
+            header_pending_{options.has_header}
+    {}
+
+public:
+    CsvReader& Feed(std::string_view chunk) {
+        const char* first{chunk.data()};
+        const char* end{chunk.data() + chunk.size()};
+
+        if (!pending_.empty()) {
+            const char* last{internal_impl::CsvLineEnd_(first, end)};
+            pending_.append(first, last);
+            if (last == end)
+                return *this;
+            ParseLine_(internal_impl::CsvTrimLine_(pending_.data(), pending_.data() + pending_.size()));
+            pending_.clear();
+            first = last + 1;
+        }
+
+        while (first < end) {
+            const char* last{internal_impl::CsvLineEnd_(first, end)};
+            if (last == end) {
+                pending_.assign(first, last);
+                break;
+            }
+            ParseLine_(internal_impl::CsvTrimLine_(first, last));
+            first = last + 1;
+        }
+        return *this;
+    }
+
+    //* the rows parsed so far, plus the last line even without a final '\n'. The reader is empty afterwards
+    Matrix<T> Finish() {
+        if (!pending_.empty()) {
+            ParseLine_(internal_impl::CsvTrimLine_(pending_.data(), pending_.data() + pending_.size()));
+            pending_.clear();
+        }
+
+        Matrix<T> result(rows_count_, cols_count_);
+        std::copy(values_.begin(), values_.end(), result.RawData());
+        values_.clear();
+        rows_count_ = 0;
+        cols_count_ = 0;
+        header_pending_ = options_.has_header;
+        return result;
+    }
+
+    std::size_t RowsCount() const { return rows_count_; }
+    std::size_t ColsCount() const { return cols_count_; }
+
+private:
+    void ParseLine_(std::string_view line) {
+        if (header_pending_) {
+            header_pending_ = false;
+            return;
+        }
+        if (internal_impl::CsvIsBlank_(line))
+            return;
+
+        if (rows_count_ == 0)
+            cols_count_ = internal_impl::CsvFieldsCount(line, options_.delimiter);
+        values_.resize(values_.size() + cols_count_);
+        if (!internal_impl::ParseCsvLine(line, options_.delimiter, values_.data() + rows_count_ * cols_count_, cols_count_))
+            internal_impl::CsvError_(rows_count_, "malformed line or wrong number of fields");
+        ++rows_count_;
+    }
+
+private:
+    CsvOptions options_;
+    bool header_pending_;
+    std::string pending_;
+    std::vector<T> values_;
+    std::size_t rows_count_{0};
+    std::size_t cols_count_{0};
+};
+
+} // namespace rage
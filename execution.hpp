@@ -0,0 +1,22 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <execution>
+
+//* std::execution policies for the overloads taking an execution policy first
+//*
+//*   seq, unseq        on the calling thread, like rage::seq (the kernels are already vectorized)
+//*   par, par_unseq    row blocks on the default pool, like rage::par
+//*
+//* Opt-in because <execution> comes with the parallel backend of the standard library:
+//* with libstdc++ and the TBB headers installed, including it needs linking with -ltbb.
+
+namespace internal_impl {
+
+template <> struct ExecutionPolicyTraits_<std::execution::sequenced_policy> : ExecutionPolicyTraits_<rage::SequencedPolicy> {};
+template <> struct ExecutionPolicyTraits_<std::execution::unsequenced_policy> : ExecutionPolicyTraits_<rage::SequencedPolicy> {};
+template <> struct ExecutionPolicyTraits_<std::execution::parallel_policy> : ExecutionPolicyTraits_<rage::ParallelPolicy> {};
+template <> struct ExecutionPolicyTraits_<std::execution::parallel_unsequenced_policy> : ExecutionPolicyTraits_<rage::ParallelPolicy> {};
+
+} // namespace internal_impl
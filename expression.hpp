@@ -0,0 +1,390 @@
+#pragma once
+
+#include "allocator.hpp"
+#include "layout.hpp"
+#include "matrix_iterator.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//* Lazy element-wise arithmetic
+//*
+//* a + b - c * 2 does not compute anything, it builds
+//*     BinaryExpression<minus, BinaryExpression<plus, A, B>, BinaryExpression<multiplies, C, Scalar>>
+//* which is evaluated in one fused loop, into one buffer, when it is assigned to a Matrix/MatrixView
+//* or explicitly materialized with Eval(). Big expressions are evaluated in row blocks on a ThreadPool.
+//*
+//* Operands are held by value: views (cheap, pointer + dims) and sub expressions; a temporary Matrix
+//* (the result of a * b) is moved in and shared, a temporary FixedMatrix is moved in. Like a MatrixView,
+//* an expression must not outlive the other matrices it reads from.
+
+namespace rage {
+    template <typename T, typename Alloc = AlignedAllocator<T>, typename Layout = RowMajor> class Matrix;
+    template <typename T, typename Morph, typename Layout> class MatrixView;
+    template <typename T, std::size_t Rows, std::size_t Cols> class FixedMatrix;
+} // namespace rage
+
+namespace internal_impl {
+    struct ExpressionTag {};
+
+    template <typename E>
+    concept Expression = std::derived_from<std::remove_cvref_t<E>, ExpressionTag>;
+
+    template <typename T> struct IsMatrix : std::false_type {};
+    template <typename T, typename A, typename L> struct IsMatrix<rage::Matrix<T, A, L>> : std::true_type {};
+
+    template <typename T> struct IsMatrixView : std::false_type {};
+    template <typename T, typename M, typename L> struct IsMatrixView<rage::MatrixView<T, M, L>> : std::true_type {};
+
+    template <typename T> struct IsFixedMatrix : std::false_type {};
+    template <typename T, std::size_t R, std::size_t C> struct IsFixedMatrix<rage::FixedMatrix<T, R, C>> : std::true_type {};
+
+    template <typename T>
+    concept FixedMatrixLike = IsFixedMatrix<std::remove_cvref_t<T>>::value;
+
+    //* anything that has RowsCount(), ColsCount() and At(r, c)
+    template <typename T>
+    concept MatrixLike = IsMatrix<std::remove_cvref_t<T>>::value
+                      || IsMatrixView<std::remove_cvref_t<T>>::value
+                      || FixedMatrixLike<T>
+                      || Expression<T>;
+
+    //* fixed op fixed and fixed op value have their own eager operators (fixed_matrix.hpp)
+    template <typename T, typename W>
+    concept StaticOperands = (FixedMatrixLike<T> && (FixedMatrixLike<W> || !MatrixLike<W>))
+                          || (FixedMatrixLike<W> && !MatrixLike<T>);
+
+    //* a view the element-wise kernels can read directly: no morph and already of the result type
+    template <typename R, typename T, typename Morph>
+    concept RawOperand = std::is_same_v<std::remove_const_t<T>, R> && IsDefaultMorph<Morph>;
+
+    template <typename R, typename V> struct IsRawView : std::false_type {};
+    template <typename R, typename T, typename M, typename L>
+    struct IsRawView<R, rage::MatrixView<T, M, L>> : std::bool_constant<RawOperand<R, T, M>> {};
+
+    template <typename V> struct LayoutOf_ { using type = void; };
+    template <typename T, typename M, typename L> struct LayoutOf_<rage::MatrixView<T, M, L>> { using type = L; };
+
+    //* a raw view stored in the given order
+    template <typename R, typename V, typename Layout>
+    concept RawViewIn = IsRawView<R, V>::value && std::is_same_v<typename LayoutOf_<V>::type, Layout>;
+
+    //* element type of a matrix, view (after the morph) or expression; a scalar is its own element type
+    template <typename T> struct ValueOf_ { using type = T; };
+    template <typename T, typename A, typename L> struct ValueOf_<rage::Matrix<T, A, L>> { using type = T; };
+    template <typename T, typename M, typename L> struct ValueOf_<rage::MatrixView<T, M, L>> {
+        using type = std::remove_cvref_t<typename std::conditional_t<IsDefaultMorph<M>,
+                                                                     std::type_identity<T>,
+                                                                     std::invoke_result<M, T>>::type>;
+    };
+    template <typename T, std::size_t R, std::size_t C> struct ValueOf_<rage::FixedMatrix<T, R, C>> { using type = T; };
+    template <typename E> requires Expression<E> struct ValueOf_<E> { using type = typename E::ValueType; };
+
+    template <typename T>
+    using ValueOf = typename ValueOf_<std::remove_cvref_t<T>>::type;
+
+    //* a scalar broadcast over the whole matrix
+    template <typename T>
+    struct ScalarOperand {
+        T value;
+        constexpr const T& At(std::size_t, std::size_t) const { return value; }
+    };
+
+    template <typename T> struct IsScalarOperand : std::false_type {};
+    template <typename T> struct IsScalarOperand<ScalarOperand<T>> : std::true_type {};
+
+    template <typename T, typename A, typename L>
+    constexpr auto ToOperand(const rage::Matrix<T, A, L>& m) { return m.View(); }
+
+    //* A temporary Matrix operand (a * b + c): a plain view that keeps the matrix alive, so the expression
+    //* can outlive the statement; copies of the expression share the matrix
+    template <typename T, typename A, typename L>
+    struct OwnedMatrixOperand : rage::MatrixView<const T, DefaultMorph<const T>, L> {
+        explicit OwnedMatrixOperand(std::shared_ptr<const rage::Matrix<T, A, L>> m)
+            :   rage::MatrixView<const T, DefaultMorph<const T>, L>{m->View()},
+                matrix{std::move(m)}
+        {}
+
+        std::shared_ptr<const rage::Matrix<T, A, L>> matrix;
+    };
+
+    template <typename R, typename T, typename A, typename L>
+    struct IsRawView<R, OwnedMatrixOperand<T, A, L>> : std::bool_constant<std::is_same_v<T, R>> {};
+
+    template <typename T, typename A, typename L> struct LayoutOf_<OwnedMatrixOperand<T, A, L>> { using type = L; };
+
+    template <typename T, typename A, typename L>
+    auto ToOperand(rage::Matrix<T, A, L>&& m) {
+        return OwnedMatrixOperand<T, A, L>{std::make_shared<const rage::Matrix<T, A, L>>(std::move(m))};
+    }
+
+    template <typename T, typename M, typename L>
+    constexpr auto ToOperand(const rage::MatrixView<T, M, L>& mv) { return mv; }
+
+    template <typename T, std::size_t R, std::size_t C>
+    constexpr auto ToOperand(const rage::FixedMatrix<T, R, C>& m) { return m.View(); }
+
+    //* A temporary FixedMatrix operand ((f * 2) + m): small, held by value in the expression,
+    //* it reads like a plain row-major view of its own elements
+    template <typename T, std::size_t R, std::size_t C>
+    struct OwnedFixedOperand {
+        rage::FixedMatrix<T, R, C> matrix;
+
+        constexpr std::size_t RowsCount() const { return R; }
+        constexpr std::size_t ColsCount() const { return C; }
+        constexpr std::size_t Size() const { return R * C; }
+        constexpr std::size_t LeadingDimension() const { return C; }
+        constexpr const T* RawData() const { return matrix.RawData(); }
+        constexpr const T& At(std::size_t r, std::size_t c) const { return matrix.At(r, c); }
+    };
+
+    template <typename V, typename T, std::size_t R, std::size_t C>
+    struct IsRawView<V, OwnedFixedOperand<T, R, C>> : std::bool_constant<std::is_same_v<T, V>> {};
+
+    template <typename T, std::size_t R, std::size_t C> struct LayoutOf_<OwnedFixedOperand<T, R, C>> { using type = rage::RowMajor; };
+
+    template <typename T, std::size_t R, std::size_t C>
+    constexpr auto ToOperand(rage::FixedMatrix<T, R, C>&& m) { return OwnedFixedOperand<T, R, C>{std::move(m)}; }
+
+    template <Expression E>
+    constexpr auto ToOperand(const E& expr) { return expr; }
+
+    template <typename T>
+    requires (!MatrixLike<T>)
+    constexpr auto ToOperand(const T& val) { return ScalarOperand<T>{val}; }
+
+    template <typename Op, typename L, typename R>
+    constexpr auto MakeExpression(L&& lhs, R&& rhs);
+
+    template <typename Layout = rage::RowMajor, typename T, typename E>
+    constexpr void Evaluate(const E& expr, T* out, std::size_t ld);
+
+    template <typename Layout = rage::RowMajor, typename T, typename E>
+    void Evaluate(const E& expr, T* out, std::size_t ld, rage::ThreadPool& pool);
+} // namespace internal_impl
+
+namespace rage {
+
+template <typename Op, typename Lhs, typename Rhs>
+class BinaryExpression : public internal_impl::ExpressionTag
+{
+public:
+    using Operation = Op;
+    using LhsType = Lhs;
+    using RhsType = Rhs;
+    using ValueType = std::remove_cvref_t<std::invoke_result_t<Op,
+                                                               decltype(std::declval<const Lhs&>().At(0, 0)),
+                                                               decltype(std::declval<const Rhs&>().At(0, 0))>>;
+
+    constexpr explicit BinaryExpression(Lhs lhs, Rhs rhs)
+        :   lhs_{std::move(lhs)},
+            rhs_{std::move(rhs)}
+    {
+        if constexpr (!internal_impl::IsScalarOperand<Lhs>::value && !internal_impl::IsScalarOperand<Rhs>::value)
+            assert(lhs_.RowsCount() == rhs_.RowsCount() && lhs_.ColsCount() == rhs_.ColsCount()
+                   && "Element-wise operands must have the same dimensions");
+    }
+
+public:
+    constexpr std::size_t RowsCount() const {
+        if constexpr (internal_impl::IsScalarOperand<Lhs>::value)
+            return rhs_.RowsCount();
+        else
+            return lhs_.RowsCount();
+    }
+
+    constexpr std::size_t ColsCount() const {
+        if constexpr (internal_impl::IsScalarOperand<Lhs>::value)
+            return rhs_.ColsCount();
+        else
+            return lhs_.ColsCount();
+    }
+
+    constexpr std::size_t Size() const { return RowsCount() * ColsCount(); }
+
+    constexpr ValueType At(std::size_t r, std::size_t c) const { return Op{}(lhs_.At(r, c), rhs_.At(r, c)); }
+
+    constexpr const Lhs& Left() const { return lhs_; }
+    constexpr const Rhs& Right() const { return rhs_; }
+
+    //* materialize
+    constexpr Matrix<ValueType> Eval() const { return Matrix<ValueType>{*this}; }
+    Matrix<ValueType> Eval(ThreadPool& pool) const { return Matrix<ValueType>{*this, pool}; }
+
+    template <internal_impl::ExecutionPolicy P>
+    Matrix<ValueType> Eval(const P& policy) const { return Eval(internal_impl::PoolOf(policy)); }
+
+private:
+    Lhs lhs_;
+    Rhs rhs_;
+};
+
+} // namespace rage
+
+namespace internal_impl {
+
+//* rvalue Matrix operands are moved into the expression, anything else is viewed or copied
+template <typename Op, typename L, typename R>
+constexpr auto MakeExpression(L&& lhs, R&& rhs)
+{
+    using LhsOperand = decltype(ToOperand(std::forward<L>(lhs)));
+    using RhsOperand = decltype(ToOperand(std::forward<R>(rhs)));
+    return rage::BinaryExpression<Op, LhsOperand, RhsOperand>{ToOperand(std::forward<L>(lhs)), ToOperand(std::forward<R>(rhs))};
+}
+
+template <typename E> struct IsBinaryExpression : std::false_type {};
+template <typename Op, typename L, typename R>
+struct IsBinaryExpression<rage::BinaryExpression<Op, L, R>> : std::true_type {};
+
+//* The shapes the SIMD kernels cover: view + view, view + val, view - val, view * val (and val on the left),
+//* when the views are stored in the same order as out; a plain view alone is copied line by line.
+//* Computes lines [first, last) of out (rows for RowMajor, columns for ColMajor).
+template <typename Layout, typename T, typename E>
+bool TryKernel_(const E& expr, T* out, std::size_t ld, std::size_t first, std::size_t last)
+{
+    if constexpr (IsBinaryExpression<E>::value && std::is_same_v<ValueOf<E>, T>) {
+        using Op = typename E::Operation;
+        using L = typename E::LhsType;
+        using R = typename E::RhsType;
+        constexpr bool raw_lhs{RawViewIn<T, L, Layout>};
+        constexpr bool raw_rhs{RawViewIn<T, R, Layout>};
+        const auto& lhs{expr.Left()};
+        const auto& rhs{expr.Right()};
+        const auto lines{last - first};
+        const auto length{Layout::LineLength(expr.RowsCount(), expr.ColsCount())};
+        out += first * ld;
+
+        const auto start{[first](const auto& view) { return view.RawData() + first * view.LeadingDimension(); }};
+
+        if constexpr (std::is_same_v<Op, std::plus<>> && raw_lhs && raw_rhs) {
+            simd::Add<T>(start(lhs), lhs.LeadingDimension(), start(rhs), rhs.LeadingDimension(), out, ld, lines, length);
+            return true;
+        } else if constexpr (std::is_same_v<Op, std::plus<>> && raw_lhs && IsScalarOperand<R>::value) {
+            simd::AddValue<T>(start(lhs), lhs.LeadingDimension(), static_cast<T>(rhs.value), out, ld, lines, length);
+            return true;
+        } else if constexpr (std::is_same_v<Op, std::plus<>> && IsScalarOperand<L>::value && raw_rhs) {
+            simd::AddValue<T>(start(rhs), rhs.LeadingDimension(), static_cast<T>(lhs.value), out, ld, lines, length);
+            return true;
+        } else if constexpr (std::is_same_v<Op, std::minus<>> && raw_lhs && IsScalarOperand<R>::value) {
+            simd::AddValue<T>(start(lhs), lhs.LeadingDimension(), static_cast<T>(-static_cast<T>(rhs.value)), out, ld, lines, length);
+            return true;
+        } else if constexpr (std::is_same_v<Op, std::multiplies<>> && raw_lhs && IsScalarOperand<R>::value) {
+            simd::MulValue<T>(start(lhs), lhs.LeadingDimension(), static_cast<T>(rhs.value), out, ld, lines, length);
+            return true;
+        } else if constexpr (std::is_same_v<Op, std::multiplies<>> && IsScalarOperand<L>::value && raw_rhs) {
+            simd::MulValue<T>(start(rhs), rhs.LeadingDimension(), static_cast<T>(lhs.value), out, ld, lines, length);
+            return true;
+        }
+    } else if constexpr (RawViewIn<T, E, Layout>) {
+        const auto length{Layout::LineLength(expr.RowsCount(), expr.ColsCount())};
+        if (expr.RawData() == out && expr.LeadingDimension() == ld)
+            return true;
+        for (std::size_t line{first}; line < last; ++line)
+            std::copy_n(expr.RawData() + line * expr.LeadingDimension(), length, out + line * ld);
+        return true;
+    }
+
+    return false;
+}
+
+//* the fused loop, lines [first, last), walking out in memory order
+template <typename Layout, typename T, typename E>
+constexpr void EvaluateLines_(const E& expr, T* out, std::size_t ld, std::size_t first, std::size_t last)
+{
+    const auto length{Layout::LineLength(expr.RowsCount(), expr.ColsCount())};
+    for (std::size_t line{first}; line < last; ++line) {
+        T* out_line{out + line * ld};
+        for (std::size_t i{0}; i < length; ++i) {
+            if constexpr (IsRowMajor<Layout>)
+                out_line[i] = static_cast<T>(expr.At(line, i));
+            else
+                out_line[i] = static_cast<T>(expr.At(i, line));
+        }
+    }
+}
+
+//* Whether expr reads the elements of out (lines of ld elements, in the given Layout) anywhere but at their own
+//* position: through a shifted sub-view or in the other layout (a.Transposed()). Evaluating such an expression
+//* in place would read elements it already overwrote; a = a + b is fine.
+template <typename Layout, typename T, typename E>
+bool ReadsShifted(const E& expr, const T* out, std::size_t ld)
+{
+    if constexpr (IsBinaryExpression<E>::value) {
+        return ReadsShifted<Layout>(expr.Left(), out, ld) || ReadsShifted<Layout>(expr.Right(), out, ld);
+    } else if constexpr (IsMatrixView<E>::value) {
+        using ViewLayout = typename LayoutOf_<E>::type;
+        using Element = std::remove_const_t<std::remove_pointer_t<decltype(expr.RawData())>>;
+        if (expr.Size() == 0)
+            return false;
+        if constexpr (std::is_same_v<ViewLayout, Layout> && std::is_same_v<Element, T>) {
+            if (expr.RawData() == out && expr.LeadingDimension() == ld)
+                return false;
+        }
+
+        const auto bytes{[](const void* data, std::size_t lines, std::size_t length, std::size_t stride, std::size_t size) {
+            const auto first{reinterpret_cast<std::uintptr_t>(data)};
+            return std::array{first, first + ((lines - 1) * stride + length) * size};
+        }};
+        const auto [first, last]{bytes(expr.RawData(), ViewLayout::LinesCount(expr.RowsCount(), expr.ColsCount()),
+                                        ViewLayout::LineLength(expr.RowsCount(), expr.ColsCount()), expr.LeadingDimension(), sizeof(Element))};
+        const auto [out_first, out_last]{bytes(out, Layout::LinesCount(expr.RowsCount(), expr.ColsCount()),
+                                                Layout::LineLength(expr.RowsCount(), expr.ColsCount()), ld, sizeof(T))};
+        return first < out_last && out_first < last;
+    } else {
+        return false;
+    }
+}
+
+//* out(r, c) = expr.At(r, c), in a single pass, out stored in the given Layout
+//* Element-wise expressions only read position (r, c) to write (r, c), so out may alias an operand
+//* as long as it is the very same position (a = a + b), not a shifted sub-view of it.
+template <typename Layout, typename T, typename E>
+void Evaluate(const E& expr, T* out, std::size_t ld, rage::ThreadPool& pool)
+{
+    const auto lines{Layout::LinesCount(expr.RowsCount(), expr.ColsCount())};
+    const auto length{Layout::LineLength(expr.RowsCount(), expr.ColsCount())};
+    ForEachRowBlock(pool, lines, length, [&](std::size_t first, std::size_t last) {
+        if (!TryKernel_<Layout>(expr, out, ld, first, last))
+            EvaluateLines_<Layout>(expr, out, ld, first, last);
+    });
+}
+
+template <typename Layout, typename T, typename E>
+constexpr void Evaluate(const E& expr, T* out, std::size_t ld)
+{
+    if consteval {
+        EvaluateLines_<Layout>(expr, out, ld, 0, Layout::LinesCount(expr.RowsCount(), expr.ColsCount()));
+    } else {
+        Evaluate<Layout>(expr, out, ld, rage::ThreadPool::Default());
+    }
+}
+
+//* Evaluate for an out that may be any operand of expr: when expr reads it at other positions (ReadsShifted),
+//* the result goes to a temporary first and is copied over out afterwards
+template <typename Layout, typename T, typename E>
+void EvaluateAliased(const E& expr, T* out, std::size_t ld, rage::ThreadPool& pool)
+{
+    if (!ReadsShifted<Layout>(expr, out, ld))
+        return Evaluate<Layout>(expr, out, ld, pool);
+
+    const auto lines{Layout::LinesCount(expr.RowsCount(), expr.ColsCount())};
+    const auto length{Layout::LineLength(expr.RowsCount(), expr.ColsCount())};
+    std::vector<T> result(lines * length);
+    Evaluate<Layout>(expr, result.data(), length, pool);
+    ForEachRowBlock(pool, lines, length, [&](std::size_t first, std::size_t last) {
+        for (std::size_t line{first}; line < last; ++line)
+            std::copy_n(result.data() + line * length, length, out + line * ld);
+    });
+}
+
+} // namespace internal_impl
@@ -0,0 +1,286 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <array>
+#include <cassert>
+#include <span>
+#include <utility>
+
+//* Fixed size matrix, FixedMatrix<T, Rows, Cols>
+//*
+//* Storage is an inline std::array: no heap, and sizeof(FixedMatrix<float, 4, 4>) == 16 * sizeof(float).
+//* The dimensions are part of the type, so fixed + fixed and fixed * fixed are checked at compile time,
+//* and computed right away over compile time bounds, unrolled and vectorized (no lazy expression,
+//* there is no heap buffer to save).
+//* Anything mixed with a dynamic Matrix, MatrixView or expression goes through the usual operators,
+//* a FixedMatrix is just another matrix there (View() is a regular MatrixView).
+
+namespace internal_impl {
+
+//* f(0), f(1), ..., f(N - 1) without a loop, the indices are constants once inlined
+template <std::size_t N, typename F>
+constexpr void Unroll(const F& f)
+{
+    [&]<std::size_t... I>(std::index_sequence<I...>) { (f(I), ...); }(std::make_index_sequence<N>{});
+}
+
+//* above this many iterations the loop is left to the vectorizer, unrolling it would only bloat the code
+inline constexpr std::size_t max_unrolled{64};
+
+template <std::size_t N, typename F>
+constexpr void StaticFor(const F& f)
+{
+    if constexpr (N <= max_unrolled) {
+        Unroll<N>(f);
+    } else {
+        for (std::size_t i{0}; i < N; ++i)
+            f(i);
+    }
+}
+
+template <typename R, std::size_t Rows, std::size_t Cols, typename F>
+constexpr rage::FixedMatrix<R, Rows, Cols> ElementWise_(const F& f)
+{
+    rage::FixedMatrix<R, Rows, Cols> result;
+    StaticFor<Rows * Cols>([&](std::size_t i) { result.RawData()[i] = static_cast<R>(f(i)); });
+    return result;
+}
+
+} // namespace internal_impl
+
+namespace rage {
+
+template <typename T, std::size_t Rows, std::size_t Cols>
+class FixedMatrix
+{
+    static_assert(Rows > 0 && Cols > 0, "FixedMatrix dimensions must not be 0");
+
+public:
+    using ValueType = T;
+
+    constexpr FixedMatrix() = default;
+
+    //* FixedMatrix<int, 2, 3> m{{{1, 2, 3}, {4, 5, 6}}};
+    constexpr FixedMatrix(const T (&rows)[Rows][Cols])
+    {
+        internal_impl::StaticFor<Rows * Cols>([&](std::size_t i) { data_[i] = rows[i / Cols][i % Cols]; });
+    }
+
+    //* from a dynamic Matrix, MatrixView or expression of the same dimensions
+    template <internal_impl::MatrixLike M>
+    requires (!internal_impl::FixedMatrixLike<M>) && std::convertible_to<internal_impl::ValueOf<M>, T>
+    constexpr explicit FixedMatrix(const M& m)
+    {
+        assert(m.RowsCount() == Rows && m.ColsCount() == Cols && "Dimensions must match");
+        for (std::size_t r{0}; r < Rows; ++r) {
+            for (std::size_t c{0}; c < Cols; ++c)
+                At(r, c) = static_cast<T>(m.At(r, c));
+        }
+    }
+
+    static constexpr FixedMatrix Identity() requires (Rows == Cols)
+    {
+        FixedMatrix identity;
+        internal_impl::StaticFor<Rows>([&](std::size_t i) { identity.At(i, i) = T{1}; });
+        return identity;
+    }
+
+    //* a heap allocated copy
+    constexpr Matrix<T> ToMatrix() const
+    {
+        Matrix<T> matrix(Rows, Cols);
+        for (std::size_t r{0}; r < Rows; ++r)
+            std::copy(Row(r).begin(), Row(r).end(), matrix.Row(r).begin());
+        return matrix;
+    }
+
+public:
+    template <typename W>
+    requires Addable<T, W> && std::convertible_to<W, T>
+    constexpr FixedMatrix& Add(const W& val) {
+        internal_impl::StaticFor<Rows * Cols>([&](std::size_t i) { data_[i] += val; });
+        return *this;
+    }
+
+    template <typename W>
+    requires Addable<T, W> && std::convertible_to<W, T>
+    constexpr FixedMatrix& Add(const FixedMatrix<W, Rows, Cols>& m) {
+        internal_impl::StaticFor<Rows * Cols>([&](std::size_t i) { data_[i] += m.data_[i]; });
+        return *this;
+    }
+
+    template <typename W>
+    requires Addable<T, W> && std::convertible_to<W, T>
+    constexpr FixedMatrix& Sub(const W& val) {
+        internal_impl::StaticFor<Rows * Cols>([&](std::size_t i) { data_[i] -= val; });
+        return *this;
+    }
+
+    template <typename W>
+    requires Addable<T, W> && std::convertible_to<W, T>
+    constexpr FixedMatrix& Sub(const FixedMatrix<W, Rows, Cols>& m) {
+        internal_impl::StaticFor<Rows * Cols>([&](std::size_t i) { data_[i] -= m.data_[i]; });
+        return *this;
+    }
+
+//* Views, the same MatrixView as for a dynamic Matrix
+public:
+    constexpr MatrixView<T> View() { return MatrixView<T>{data_.data(), Rows, Cols, Cols}; }
+    constexpr MatrixView<const T> View() const { return MatrixView<const T>{data_.data(), Rows, Cols, Cols}; }
+    constexpr MatrixView<const T> ConstView() const { return View(); }
+
+    constexpr MatrixView<T> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) {
+        return View().View(rows, cols);
+    }
+
+    constexpr MatrixView<const T> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) const {
+        return View().View(rows, cols);
+    }
+
+    //* a column-major view of the same array, no copy
+    constexpr auto Transposed() { return View().Transposed(); }
+    constexpr auto Transposed() const { return View().Transposed(); }
+
+    template <typename Morph>
+    requires internal_impl::MorphConcept<Morph, T>
+    constexpr MatrixView<T, std::decay_t<Morph>> View(Morph&& morph) {
+        return MatrixView<T, std::decay_t<Morph>>{data_.data(), Rows, Cols, Cols, std::forward<Morph>(morph)};
+    }
+
+    template <typename Morph>
+    requires internal_impl::MorphConcept<Morph, T>
+    constexpr MatrixView<const T, std::decay_t<Morph>> View(Morph&& morph) const {
+        return MatrixView<const T, std::decay_t<Morph>>{data_.data(), Rows, Cols, Cols, std::forward<Morph>(morph)};
+    }
+
+//* Iterators
+public:
+    constexpr MatrixIterator<T> begin() { return MatrixIterator<T>{data_.data(), Cols, Cols}; }
+    constexpr MatrixIterator<T> end() { return MatrixIterator<T>{data_.data() + Rows * Cols, Cols, Cols}; }
+
+    constexpr MatrixIterator<const T> begin() const { return MatrixIterator<const T>{data_.data(), Cols, Cols}; }
+    constexpr MatrixIterator<const T> end() const { return MatrixIterator<const T>{data_.data() + Rows * Cols, Cols, Cols}; }
+
+    constexpr MatrixIterator<const T> cbegin() const { return begin(); }
+    constexpr MatrixIterator<const T> cend() const { return end(); }
+
+//* Access methods
+public:
+    constexpr std::span<T, Rows * Cols> Data() { return data_; }
+    constexpr std::span<const T, Rows * Cols> Data() const { return data_; }
+
+    //* same as Data(), never padded
+    constexpr std::span<T, Rows * Cols> Elements() { return data_; }
+    constexpr std::span<const T, Rows * Cols> Elements() const { return data_; }
+
+    static constexpr std::size_t RowsCount() { return Rows; }
+    static constexpr std::size_t ColsCount() { return Cols; }
+    static constexpr std::size_t Size() { return Rows * Cols; }
+    static constexpr std::size_t LeadingDimension() { return Cols; }
+
+    constexpr std::span<const T, Cols> Row(std::size_t r) const { return std::span<const T, Cols>{data_.data() + r * Cols, Cols}; }
+    constexpr std::span<T, Cols> Row(std::size_t r) { return std::span<T, Cols>{data_.data() + r * Cols, Cols}; }
+
+    constexpr std::span<const T, Cols> operator[](std::size_t r) const { return Row(r); }
+    constexpr std::span<T, Cols> operator[](std::size_t r) { return Row(r); }
+
+    constexpr Column<const T> Col(std::size_t c) const { return Column<const T>{data_.data() + c, Cols, Rows}; }
+    constexpr Column<T> Col(std::size_t c) { return Column<T>{data_.data() + c, Cols, Rows}; }
+
+    constexpr const T& At(std::size_t r, std::size_t c) const { return data_[r * Cols + c]; }
+    constexpr T& At(std::size_t r, std::size_t c) { return data_[r * Cols + c]; }
+
+    constexpr T* RawData() { return data_.data(); }
+    constexpr const T* RawData() const { return data_.data(); }
+
+private:
+    std::array<T, Rows * Cols> data_{};
+
+private:
+    template <typename U, std::size_t R, std::size_t C> friend class FixedMatrix;
+};
+
+//! ***
+//! ***
+//! Operators
+//! ***
+
+//* fixed op fixed and fixed op value, eager and unrolled; the dimensions are checked by the signatures
+//* (there is no fixed + fixed for different dimensions, and the lazy operators step aside for these)
+
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires Addable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator+(const FixedMatrix<T, Rows, Cols>& lhs, const FixedMatrix<W, Rows, Cols>& rhs) {
+    return internal_impl::ElementWise_<R, Rows, Cols>([&](std::size_t i) { return lhs.RawData()[i] + rhs.RawData()[i]; });
+}
+
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires Addable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator-(const FixedMatrix<T, Rows, Cols>& lhs, const FixedMatrix<W, Rows, Cols>& rhs) {
+    return internal_impl::ElementWise_<R, Rows, Cols>([&](std::size_t i) { return lhs.RawData()[i] - rhs.RawData()[i]; });
+}
+
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires (!internal_impl::MatrixLike<W>) && Addable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator+(const FixedMatrix<T, Rows, Cols>& lhs, const W& rhs) {
+    return internal_impl::ElementWise_<R, Rows, Cols>([&](std::size_t i) { return lhs.RawData()[i] + rhs; });
+}
+
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires (!internal_impl::MatrixLike<T>) && Addable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator+(const T& lhs, const FixedMatrix<W, Rows, Cols>& rhs) {
+    return rhs + lhs;
+}
+
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires (!internal_impl::MatrixLike<W>) && Addable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator-(const FixedMatrix<T, Rows, Cols>& lhs, const W& rhs) {
+    return internal_impl::ElementWise_<R, Rows, Cols>([&](std::size_t i) { return lhs.RawData()[i] - rhs; });
+}
+
+//* 5 - matrix treats 5 as a matrix where all elements are 5
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires (!internal_impl::MatrixLike<T>) && Addable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator-(const T& lhs, const FixedMatrix<W, Rows, Cols>& rhs) {
+    return internal_impl::ElementWise_<R, Rows, Cols>([&](std::size_t i) { return lhs - rhs.RawData()[i]; });
+}
+
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires (!internal_impl::MatrixLike<W>) && Multipliable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator*(const FixedMatrix<T, Rows, Cols>& lhs, const W& rhs) {
+    return internal_impl::ElementWise_<R, Rows, Cols>([&](std::size_t i) { return lhs.RawData()[i] * rhs; });
+}
+
+template <typename T, typename W, std::size_t Rows, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires (!internal_impl::MatrixLike<T>) && Multipliable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator*(const T& lhs, const FixedMatrix<W, Rows, Cols>& rhs) {
+    return rhs * lhs;
+}
+
+//* (Rows x Inner) * (Inner x Cols)
+//* Row i of the result is the sum of the rows of rhs scaled by lhs(i, k): the innermost loop runs over
+//* a whole row of contiguous elements, kept in a local accumulator. With every trip count a constant the
+//* compiler turns it into straight vector code (a row of a 4x4 float matrix is one SSE register).
+//* Plain loops on purpose: Unroll would hand the compiler lambdas too big to inline here.
+template <typename T, typename W, std::size_t Rows, std::size_t Inner, std::size_t Cols, typename R = std::common_type_t<T, W>>
+requires Multipliable<T, W>
+constexpr FixedMatrix<R, Rows, Cols> operator*(const FixedMatrix<T, Rows, Inner>& lhs, const FixedMatrix<W, Inner, Cols>& rhs)
+{
+    FixedMatrix<R, Rows, Cols> result;
+
+    for (std::size_t i{0}; i < Rows; ++i) {
+        std::array<R, Cols> row{};
+        for (std::size_t k{0}; k < Inner; ++k) {
+            const R a_ik{static_cast<R>(lhs.At(i, k))};
+            const auto b_row{rhs.Row(k)};
+            for (std::size_t j{0}; j < Cols; ++j)
+                row[j] += a_ik * static_cast<R>(b_row[j]);
+        }
+        std::copy(row.begin(), row.end(), result.Row(i).begin());
+    }
+
+    return result;
+}
+
+} // namespace rage
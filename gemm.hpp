@@ -0,0 +1,413 @@
+#pragma once
+
+#include "allocator.hpp"
+#include "thread_pool.hpp"
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+//* Packed, cache-blocked matrix multiply (GotoBLAS/BLIS loop structure).
+//*
+//*   for jc in N step NC          <- KC x NC panel of B lives in L3
+//*     for pc in K step KC        <- pack B panel
+//*       for ic in M step MC      <- MC x KC block of A lives in L2, pack it
+//*         for jr in NC step NR   <- KC x NR sliver of B lives in L1
+//*           for ir in MC step MR <- MR x NR tile of C lives in registers
+//*             MicroKernel
+//*
+//* The engine only knows about element accessors and a raw output buffer,
+//* so it does not care whether the operands are Matrix, MatrixView or morphed views:
+//* the morph (and the conversion to the result type) is applied once, while packing.
+//*
+//* Operands that are plain memory come as a StridedAccessor: packing then knows the storage order and
+//* walks whichever axis is contiguous (A row by row, B^T of a row-major B column by column).
+//*
+//* ParallelGemm splits C into tiles and runs the blocked engine on each tile as a task.
+//*
+//* The micro kernel stores its tiles through an epilogue: PlainStore for C = A B, or a GemmEpilogue
+//* for the fused C = f(alpha A B + beta C + bias) of rage::Gemm, one pass over C instead of three.
+
+namespace internal_impl {
+
+struct CacheSizes {
+    static constexpr std::size_t L1{32 * 1024};
+    static constexpr std::size_t L2{256 * 1024};
+    static constexpr std::size_t L3{8 * 1024 * 1024};
+};
+
+//* The vector registers of the build target: the engine is compiled for it (-march), not dispatched at runtime
+struct VectorRegisters {
+#if defined(__AVX512F__)
+    static constexpr std::size_t Bytes{64};
+    static constexpr std::size_t Count{32};
+#elif defined(__AVX__)
+    static constexpr std::size_t Bytes{32};
+    static constexpr std::size_t Count{16};
+#else
+    static constexpr std::size_t Bytes{16};
+    static constexpr std::size_t Count{16};
+#endif
+};
+
+//* element types the micro kernel spells in GNU vectors of VectorRegisters::Bytes
+template <typename T>
+concept GemmVectorizable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+//* Element (r, c) is data[r * row_stride + c * col_stride]: row-major has col_stride 1, column-major row_stride 1
+template <typename T>
+struct StridedAccessor
+{
+    const T* data;
+    std::size_t row_stride;
+    std::size_t col_stride;
+
+    constexpr const T& operator()(std::size_t r, std::size_t c) const { return data[r * row_stride + c * col_stride]; }
+
+    //* the same operand starting at (row, col)
+    constexpr StridedAccessor Shifted(std::size_t row, std::size_t col) const {
+        return {data + row * row_stride + col * col_stride, row_stride, col_stride};
+    }
+};
+
+template <typename T> struct IsStridedAccessor : std::false_type {};
+template <typename T> struct IsStridedAccessor<StridedAccessor<T>> : std::true_type {};
+
+template <typename Get>
+constexpr auto ShiftAccessor_(const Get& get, std::size_t row, std::size_t col)
+{
+    if constexpr (IsStridedAccessor<Get>::value)
+        return get.Shifted(row, col);
+    else
+        return [&get, row, col](std::size_t r, std::size_t c) { return get(row + r, col + c); };
+}
+
+template <typename T>
+struct GemmBlocking
+{
+    //* register tile, MR x NR accumulators: rows of two vectors, 8 of them with 32 vector registers, 6 with 16
+    //* (the rest hold the B row and the broadcast A element)
+    static constexpr std::size_t NR{GemmVectorizable<T> ? 2 * VectorRegisters::Bytes / sizeof(T) : sizeof(T) >= 8 ? 8 : 16};
+    static constexpr std::size_t MR{!GemmVectorizable<T> ? (sizeof(T) >= 8 ? 4 : 6) : VectorRegisters::Count >= 32 ? 8 : 6};
+
+    //* half of each cache level is left for C and whatever else is going on
+    static constexpr std::size_t KC{std::clamp<std::size_t>(CacheSizes::L1 / 2 / (NR * sizeof(T)), 64, 512)};
+    static constexpr std::size_t MC{std::max<std::size_t>(CacheSizes::L2 / 2 / (KC * sizeof(T)) / MR, 1) * MR};
+    static constexpr std::size_t NC{std::max<std::size_t>(CacheSizes::L3 / 2 / (KC * sizeof(T)) / NR, 1) * NR};
+};
+
+//* Packs the mc x kc block of A starting at (row, col) into MR-row slivers,
+//* column by column, zero padding the last sliver.
+template <typename R, std::size_t MR, typename GetA>
+constexpr void PackA(const GetA& get_a, std::size_t row, std::size_t col,
+                     std::size_t mc, std::size_t kc, R* buffer)
+{
+    //* rows of A are contiguous: read each one straight through, scatter into the sliver
+    if constexpr (IsStridedAccessor<GetA>::value) {
+        if (get_a.col_stride == 1 && get_a.row_stride != 1) {
+            for (std::size_t i{0}; i < mc; i += MR, buffer += MR * kc) {
+                const auto rows{std::min(MR, mc - i)};
+                for (std::size_t ii{0}; ii < rows; ++ii) {
+                    const auto* a_row{&get_a(row + i + ii, col)};
+                    for (std::size_t p{0}; p < kc; ++p)
+                        buffer[p * MR + ii] = static_cast<R>(a_row[p]);
+                }
+                for (std::size_t ii{rows}; ii < MR; ++ii) {
+                    for (std::size_t p{0}; p < kc; ++p)
+                        buffer[p * MR + ii] = R{};
+                }
+            }
+            return;
+        }
+    }
+
+    for (std::size_t i{0}; i < mc; i += MR) {
+        const auto rows{std::min(MR, mc - i)};
+        for (std::size_t p{0}; p < kc; ++p) {
+            for (std::size_t ii{0}; ii < rows; ++ii)
+                *buffer++ = static_cast<R>(get_a(row + i + ii, col + p));
+            for (std::size_t ii{rows}; ii < MR; ++ii)
+                *buffer++ = R{};
+        }
+    }
+}
+
+//* Packs the kc x nc panel of B starting at (row, col) into NR-column slivers,
+//* row by row, zero padding the last sliver.
+template <typename R, std::size_t NR, typename GetB>
+constexpr void PackB(const GetB& get_b, std::size_t row, std::size_t col,
+                     std::size_t kc, std::size_t nc, R* buffer)
+{
+    //* columns of B are contiguous (B is a transposed row-major matrix): read them straight through
+    if constexpr (IsStridedAccessor<GetB>::value) {
+        if (get_b.row_stride == 1 && get_b.col_stride != 1) {
+            for (std::size_t j{0}; j < nc; j += NR, buffer += NR * kc) {
+                const auto cols{std::min(NR, nc - j)};
+                for (std::size_t jj{0}; jj < cols; ++jj) {
+                    const auto* b_col{&get_b(row, col + j + jj)};
+                    for (std::size_t p{0}; p < kc; ++p)
+                        buffer[p * NR + jj] = static_cast<R>(b_col[p]);
+                }
+                for (std::size_t jj{cols}; jj < NR; ++jj) {
+                    for (std::size_t p{0}; p < kc; ++p)
+                        buffer[p * NR + jj] = R{};
+                }
+            }
+            return;
+        }
+    }
+
+    for (std::size_t j{0}; j < nc; j += NR) {
+        const auto cols{std::min(NR, nc - j)};
+        for (std::size_t p{0}; p < kc; ++p) {
+            for (std::size_t jj{0}; jj < cols; ++jj)
+                *buffer++ = static_cast<R>(get_b(row + p, col + j + jj));
+            for (std::size_t jj{cols}; jj < NR; ++jj)
+                *buffer++ = R{};
+        }
+    }
+}
+
+//* How the micro kernel stores a finished tile: the plain C = A B
+struct PlainStore {
+    constexpr PlainStore Shifted(std::size_t, std::size_t) const { return *this; }
+};
+
+//* C = morph(alpha A B + beta C + bias), applied by the micro kernel as it stores each tile.
+//* K is cut in KC blocks: the first one scales C by beta, the last one adds the bias and applies the morph.
+template <typename R, typename Morph>
+struct GemmEpilogue {
+    R alpha;
+    R beta;
+    const R* row_bias; //* row_bias[r] is added to the whole row r, null for none
+    const R* col_bias; //* col_bias[c] to the whole column c
+    [[no_unique_address]] Morph morph;
+
+    //* the same epilogue for the block of C starting at (row, col)
+    constexpr GemmEpilogue Shifted(std::size_t row, std::size_t col) const {
+        return {alpha, beta, row_bias ? row_bias + row : nullptr, col_bias ? col_bias + col : nullptr, morph};
+    }
+
+    //* once the last KC block is stored: bias and morph on c[0..n), columns col.. of row `row`, while it is in L1
+    constexpr void Finish(R* c, std::size_t n, std::size_t row, std::size_t col) const {
+        const R bias{row_bias ? row_bias[row] : R{}};
+        if (col_bias) {
+            for (std::size_t j{0}; j < n; ++j)
+                c[j] = static_cast<R>(morph(c[j] + bias + col_bias[col + j]));
+        } else {
+            for (std::size_t j{0}; j < n; ++j)
+                c[j] = static_cast<R>(morph(c[j] + bias));
+        }
+    }
+};
+
+//* C[0..m)[0..n) (+)= A_sliver * B_sliver, the tile at (row, col) of the C the epilogue knows about
+//* The accumulators are vectors only ever indexed by constants, so the compiler keeps them in registers.
+//* Edge tiles are computed in full (the packed buffers are zero padded), only m x n is stored.
+template <typename R, std::size_t MR, std::size_t NR, typename Epilogue = PlainStore>
+constexpr void MicroKernel(std::size_t kc, const R* a, const R* b, R* c, std::size_t ldc,
+                           std::size_t m, std::size_t n, bool first, [[maybe_unused]] bool last = true,
+                           [[maybe_unused]] const Epilogue& epilogue = {},
+                           [[maybe_unused]] std::size_t row = 0, [[maybe_unused]] std::size_t col = 0)
+{
+    R acc[MR][NR]{};
+
+    const auto accumulate{[&] {
+        for (std::size_t p{0}; p < kc; ++p) {
+            for (std::size_t i{0}; i < MR; ++i) {
+                const R a_i{a[i]};
+                for (std::size_t j{0}; j < NR; ++j)
+                    acc[i][j] += a_i * b[j];
+            }
+            a += MR;
+            b += NR;
+        }
+    }};
+
+    //* left to the auto-vectorizer, the loops above come out scalar for some tile shapes (float 6 x 16 did):
+    //* the tile is spelled in vectors instead, one fold over the MR x NV accumulators
+    constexpr std::size_t L{VectorRegisters::Bytes / sizeof(R)};
+    if constexpr (GemmVectorizable<R> && NR % L == 0) {
+        if consteval {
+            accumulate();
+        } else {
+            typedef R Vector __attribute__((vector_size(VectorRegisters::Bytes)));
+            constexpr std::size_t NV{NR / L};
+            const auto load{[](const R* from) {
+                Vector v;
+                __builtin_memcpy(&v, from, sizeof(v));
+                return v;
+            }};
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                Vector acc_v[MR * NV]{};
+                for (std::size_t p{0}; p < kc; ++p) {
+                    //* a[i] - 0 is the broadcast of a[i]: 0 + a[i] would not fold away (-0)
+                    ((acc_v[I] += (a[I / NV] - Vector{}) * load(b + I % NV * L)), ...);
+                    a += MR;
+                    b += NR;
+                }
+                (..., [&] {
+                    const Vector v{acc_v[I]};
+                    __builtin_memcpy(&acc[I / NV][I % NV * L], &v, sizeof(v));
+                }());
+            }(std::make_index_sequence<MR * NV>{});
+        }
+    } else {
+        accumulate();
+    }
+
+    for (std::size_t i{0}; i < m; ++i) {
+        R* c_row{c + i * ldc};
+        if constexpr (!std::is_same_v<Epilogue, PlainStore>) {
+            if (!first) {
+                for (std::size_t j{0}; j < n; ++j)
+                    c_row[j] += epilogue.alpha * acc[i][j];
+            } else if (epilogue.beta != R{}) {
+                for (std::size_t j{0}; j < n; ++j)
+                    c_row[j] = epilogue.alpha * acc[i][j] + epilogue.beta * c_row[j];
+            } else { // beta == 0: C is not read, whatever it holds (NaN included) does not leak
+                for (std::size_t j{0}; j < n; ++j)
+                    c_row[j] = epilogue.alpha * acc[i][j];
+            }
+            if (last)
+                epilogue.Finish(c_row, n, row + i, col);
+        } else if (first) {
+            for (std::size_t j{0}; j < n; ++j)
+                c_row[j] = acc[i][j];
+        } else {
+            for (std::size_t j{0}; j < n; ++j)
+                c_row[j] += acc[i][j];
+        }
+    }
+}
+
+//* The loop nest of Gemm, on packing buffers large enough for an MC x KC block of A and a KC x NC panel of B
+template <typename R, typename GetA, typename GetB, typename Epilogue>
+constexpr void GemmBlocked_(std::size_t m, std::size_t n, std::size_t k,
+                            const GetA& get_a, const GetB& get_b, R* c, std::size_t ldc,
+                            const Epilogue& epilogue, R* packed_a, R* packed_b)
+{
+    using Blocking = GemmBlocking<R>;
+    constexpr auto MR{Blocking::MR};
+    constexpr auto NR{Blocking::NR};
+    constexpr auto KC{Blocking::KC};
+    constexpr auto MC{Blocking::MC};
+    constexpr auto NC{Blocking::NC};
+
+    for (std::size_t jc{0}; jc < n; jc += NC) {
+        const auto nc{std::min(NC, n - jc)};
+
+        for (std::size_t pc{0}; pc < k; pc += KC) {
+            const auto kc{std::min(KC, k - pc)};
+            PackB<R, NR>(get_b, pc, jc, kc, nc, packed_b);
+
+            for (std::size_t ic{0}; ic < m; ic += MC) {
+                const auto mc{std::min(MC, m - ic)};
+                PackA<R, MR>(get_a, ic, pc, mc, kc, packed_a);
+
+                for (std::size_t jr{0}; jr < nc; jr += NR) {
+                    const auto nr{std::min(NR, nc - jr)};
+                    const R* b_sliver{packed_b + jr * kc};
+
+                    for (std::size_t ir{0}; ir < mc; ir += MR) {
+                        const auto mr{std::min(MR, mc - ir)};
+                        MicroKernel<R, MR, NR>(kc, packed_a + ir * kc, b_sliver,
+                                               c + (ic + ir) * ldc + jc + jr, ldc,
+                                               mr, nr, pc == 0, pc + kc == k,
+                                               epilogue, ic + ir, jc + jr);
+                    }
+                }
+            }
+        }
+    }
+}
+
+//* cache line aligned, so the micro kernel's loads of the slivers never split a line
+template <typename R>
+using PackBuffer_ = std::vector<R, rage::AlignedAllocator<R>>;
+
+//* Each thread keeps its packing buffers from one product to the next (they only ever grow, up to
+//* MC x KC + KC x NC elements), so a loop of products into the same output does not allocate.
+//* Packing writes every element it reads back, padding included, nothing needs clearing.
+template <typename R>
+R* ThreadPackBuffer_(std::size_t slot, std::size_t size)
+{
+    thread_local PackBuffer_<R> buffers[2];
+    if (buffers[slot].size() < size)
+        buffers[slot].resize(size);
+    return buffers[slot].data();
+}
+
+//* C (m x n, leading dimension ldc) = A (m x k) * B (k x n)
+//* get_a(r, c) and get_b(r, c) return the elements of A and B, C does not need to be initialized
+//* (unless a GemmEpilogue reads it, beta != 0).
+template <typename R, typename GetA, typename GetB, typename Epilogue = PlainStore>
+constexpr void Gemm(std::size_t m, std::size_t n, std::size_t k,
+          const GetA& get_a, const GetB& get_b, R* c, std::size_t ldc, const Epilogue& epilogue = {})
+{
+    using Blocking = GemmBlocking<R>;
+
+    if (m == 0 || n == 0)
+        return;
+
+    if (k == 0) {
+        for (std::size_t i{0}; i < m; ++i) {
+            R* c_row{c + i * ldc};
+            if constexpr (std::is_same_v<Epilogue, PlainStore>) {
+                std::fill_n(c_row, n, R{});
+            } else {
+                for (std::size_t j{0}; j < n; ++j)
+                    c_row[j] = epilogue.beta != R{} ? epilogue.beta * c_row[j] : R{};
+                epilogue.Finish(c_row, n, i, 0);
+            }
+        }
+        return;
+    }
+
+    const auto round_up{[](std::size_t v, std::size_t to) { return (v + to - 1) / to * to; }};
+    const auto a_size{round_up(std::min(Blocking::MC, m), Blocking::MR) * std::min(Blocking::KC, k)};
+    const auto b_size{round_up(std::min(Blocking::NC, n), Blocking::NR) * std::min(Blocking::KC, k)};
+
+    if consteval {
+        PackBuffer_<R> packed_a(a_size);
+        PackBuffer_<R> packed_b(b_size);
+        GemmBlocked_<R>(m, n, k, get_a, get_b, c, ldc, epilogue, packed_a.data(), packed_b.data());
+    } else {
+        GemmBlocked_<R>(m, n, k, get_a, get_b, c, ldc, epilogue, ThreadPackBuffer_<R>(0, a_size), ThreadPackBuffer_<R>(1, b_size));
+    }
+}
+
+//* Same as Gemm, with C split in tiles that are computed on the pool.
+//* Tiles are at least MC rows tall, so the B panel each of them packs again is noise next to the math.
+template <typename R, typename GetA, typename GetB, typename Epilogue = PlainStore>
+void ParallelGemm(rage::ThreadPool& pool, std::size_t m, std::size_t n, std::size_t k,
+                  const GetA& get_a, const GetB& get_b, R* c, std::size_t ldc, const Epilogue& epilogue = {})
+{
+    using Blocking = GemmBlocking<R>;
+
+    if (pool.ThreadsCount() == 1 || m * n * k < rage::ParallelThresholds::gemm_work)
+        return Gemm<R>(m, n, k, get_a, get_b, c, ldc, epilogue);
+
+    const auto ceil_div{[](std::size_t v, std::size_t by) { return (v + by - 1) / by; }};
+    const auto tasks_wanted{pool.ThreadsCount() * 4};
+    const auto row_tiles{std::clamp<std::size_t>(m / Blocking::MC, 1, tasks_wanted)};
+    const auto col_tiles{std::clamp<std::size_t>(ceil_div(tasks_wanted, row_tiles), 1, std::max<std::size_t>(n / Blocking::NR, 1))};
+    const auto tile_rows{ceil_div(ceil_div(m, row_tiles), Blocking::MR) * Blocking::MR};
+    const auto tile_cols{ceil_div(ceil_div(n, col_tiles), Blocking::NR) * Blocking::NR};
+    const auto tiles_down{ceil_div(m, tile_rows)};
+    const auto tiles_across{ceil_div(n, tile_cols)};
+
+    pool.ParallelFor(0, tiles_down * tiles_across, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t tile{first}; tile < last; ++tile) {
+            const auto row{(tile / tiles_across) * tile_rows};
+            const auto col{(tile % tiles_across) * tile_cols};
+            Gemm<R>(std::min(tile_rows, m - row), std::min(tile_cols, n - col), k,
+                    ShiftAccessor_(get_a, row, 0), ShiftAccessor_(get_b, 0, col),
+                    c + row * ldc + col, ldc, epilogue.Shifted(row, col));
+        }
+    });
+}
+
+} // namespace internal_impl
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <cstddef>
+#include <algorithm>
+
+//* Matrix-vector product, y = A x, over plain buffers
+//*
+//* A GEMV reads every element of A once, so it runs at memory speed: the point is to stream A in
+//* storage order, never to walk it across its lines.
+//*   row-major A:    y[r] = row r . x             (Dot per row)
+//*   column-major A: y += x[c] * column c         (Axpy per column)
+//* A^T x is the same thing on the transposed view, which just swaps the two cases.
+//* Tall matrices are split in blocks of rows (of y), one per task.
+
+namespace internal_impl {
+
+//* A is rows x cols, row-major, lda between its rows
+template <typename T>
+void GemvRows(const T* a, std::size_t lda, const T* x, T* y, std::size_t rows, std::size_t cols, rage::ThreadPool& pool)
+{
+    ForEachRowBlock(pool, rows, cols, [&](std::size_t first, std::size_t last) {
+        for (std::size_t r{first}; r < last; ++r)
+            y[r] = simd::Dot(a + r * lda, x, cols);
+    });
+}
+
+//* A is rows x cols, column-major, lda between its columns
+template <typename T>
+void GemvCols(const T* a, std::size_t lda, const T* x, T* y, std::size_t rows, std::size_t cols, rage::ThreadPool& pool)
+{
+    ForEachRowBlock(pool, rows, cols, [&](std::size_t first, std::size_t last) {
+        std::fill(y + first, y + last, T{});
+        for (std::size_t c{0}; c < cols; ++c)
+            simd::Axpy(x[c], a + c * lda + first, y + first, last - first);
+    });
+}
+
+} // namespace internal_impl
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+//* Storage order of a Matrix/MatrixView
+//*
+//* The buffer is a sequence of lines: rows for RowMajor, columns for ColMajor. Elements of a line are
+//* contiguous and the leading dimension is the distance between the start of two lines.
+//* Transposing a view only swaps the dimensions and the layout, the buffer stays where it is.
+
+namespace rage {
+
+struct ColMajor;
+
+struct RowMajor {
+    using Transposed = ColMajor;
+
+    static constexpr std::size_t Offset(std::size_t r, std::size_t c, std::size_t ld) { return r * ld + c; }
+    static constexpr std::size_t LinesCount(std::size_t rows, std::size_t) { return rows; }
+    static constexpr std::size_t LineLength(std::size_t, std::size_t cols) { return cols; }
+};
+
+struct ColMajor {
+    using Transposed = RowMajor;
+
+    static constexpr std::size_t Offset(std::size_t r, std::size_t c, std::size_t ld) { return c * ld + r; }
+    static constexpr std::size_t LinesCount(std::size_t, std::size_t cols) { return cols; }
+    static constexpr std::size_t LineLength(std::size_t rows, std::size_t) { return rows; }
+};
+
+} // namespace rage
+
+namespace internal_impl {
+    template <typename L>
+    concept LayoutPolicy = std::is_same_v<L, rage::RowMajor> || std::is_same_v<L, rage::ColMajor>;
+
+    template <typename L>
+    inline constexpr bool IsRowMajor = std::is_same_v<L, rage::RowMajor>;
+} // namespace internal_impl
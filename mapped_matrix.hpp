@@ -0,0 +1,163 @@
+#pragma once
+
+#include "matrix.hpp"
+#include "matrix_file.hpp"
+
+#include <cstddef>
+#include <cerrno>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//* Matrices mapped from a file written by Matrix::Save, MapMatrix<T>(path) (POSIX only)
+//*
+//* Mapping reads the 64 bytes of the header and nothing else: the data pages are faulted in by the
+//* kernel the first time they are touched, shared with the page cache, so opening a matrix of any size is O(1).
+//* The mode follows the constness of T:
+//*   MapMatrix<const T>  read-only, the pages are shared with every other reader of the file
+//*   MapMatrix<T>        copy-on-write, writes go to private copies of the pages, never to the file
+
+namespace rage {
+
+template <typename T, typename Layout = RowMajor>
+class MappedMatrix;
+
+template <typename T, typename Layout = RowMajor>
+MappedMatrix<T, Layout> MapMatrix(const std::filesystem::path& path);
+
+template <typename T, typename Layout>
+class MappedMatrix
+{
+public:
+    using ValueType = T;
+
+    MappedMatrix(const MappedMatrix&) = delete;
+    MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+    MappedMatrix(MappedMatrix&& other) noexcept
+        :   mapping_{std::exchange(other.mapping_, nullptr)},
+            mapping_size_{std::exchange(other.mapping_size_, 0)},
+            data_{std::exchange(other.data_, nullptr)},
+            rows_count_{other.rows_count_},
+            cols_count_{other.cols_count_},
+            ld_{other.ld_}
+    {}
+
+    MappedMatrix& operator=(MappedMatrix&& other) noexcept {
+        if (this != &other) {
+            Unmap_();
+            mapping_ = std::exchange(other.mapping_, nullptr);
+            mapping_size_ = std::exchange(other.mapping_size_, 0);
+            data_ = std::exchange(other.data_, nullptr);
+            rows_count_ = other.rows_count_;
+            cols_count_ = other.cols_count_;
+            ld_ = other.ld_;
+        }
+        return *this;
+    }
+
+    ~MappedMatrix() { Unmap_(); }
+
+public:
+    //* valid as long as the MappedMatrix is
+    MatrixView<T, internal_impl::DefaultMorph<T>, Layout> View() const {
+        return MatrixView<T, internal_impl::DefaultMorph<T>, Layout>::FromBuffer(data_, rows_count_, cols_count_, ld_);
+    }
+
+    std::size_t RowsCount() const { return rows_count_; }
+    std::size_t ColsCount() const { return cols_count_; }
+    std::size_t Size() const { return rows_count_ * cols_count_; }
+    std::size_t LeadingDimension() const { return ld_; }
+
+    T* RawData() const { return data_; }
+
+    const T& At(std::size_t r, std::size_t c) const { return data_[Layout::Offset(r, c, ld_)]; }
+    T& At(std::size_t r, std::size_t c) requires (!std::is_const_v<T>) { return data_[Layout::Offset(r, c, ld_)]; }
+
+private:
+    MappedMatrix(void* mapping, std::size_t mapping_size, const internal_impl::MatrixFileHeader& header)
+        :   mapping_{mapping},
+            mapping_size_{mapping_size},
+            data_{reinterpret_cast<T*>(static_cast<std::byte*>(mapping) + header.data_offset)},
+            rows_count_{header.rows},
+            cols_count_{header.cols},
+            ld_{header.leading_dimension}
+    {}
+
+    void Unmap_() {
+        if (mapping_ != nullptr)
+            ::munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+
+private:
+    void* mapping_;
+    std::size_t mapping_size_;
+    T* data_;
+    std::size_t rows_count_;
+    std::size_t cols_count_;
+    std::size_t ld_;
+
+private:
+    template <typename U, typename L>
+    friend MappedMatrix<U, L> MapMatrix(const std::filesystem::path& path);
+};
+
+//* throws std::system_error when the file cannot be opened or mapped, std::runtime_error when it is not
+//* a matrix of T stored in Layout
+template <typename T, typename Layout>
+MappedMatrix<T, Layout> MapMatrix(const std::filesystem::path& path)
+{
+    static_assert(internal_impl::Storable<T>, "No file format for this element type");
+
+    const auto os_error{[&path](const char* what) {
+        return std::system_error{errno, std::generic_category(), std::string{what} + " " + path.string()};
+    }};
+
+    const int fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd < 0)
+        throw os_error("Could not open");
+
+    struct stat info{};
+    if (::fstat(fd, &info) != 0) {
+        const auto error{os_error("Could not stat")};
+        ::close(fd);
+        throw error;
+    }
+
+    const auto file_size{static_cast<std::size_t>(info.st_size)};
+    internal_impl::MatrixFileHeader header{};
+    if (file_size < sizeof(header) || ::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+        ::close(fd);
+        throw std::runtime_error{"Bad matrix file " + path.string() + ": too short"};
+    }
+
+    try {
+        internal_impl::CheckMatrixFileHeader<T, Layout>(header, file_size, path);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+
+    //* the whole file, the header included: the data offset stays within the first (already faulted in) page
+    constexpr bool read_only{std::is_const_v<T>};
+    void* mapping{::mmap(nullptr, file_size, read_only ? PROT_READ : PROT_READ | PROT_WRITE,
+                         read_only ? MAP_SHARED : MAP_PRIVATE, fd, 0)};
+    if (mapping == MAP_FAILED) {
+        const auto error{os_error("Could not map")};
+        ::close(fd);
+        throw error;
+    }
+    ::close(fd); // the mapping keeps its own reference to the file
+
+    return MappedMatrix<T, Layout>{mapping, file_size, header};
+}
+
+} // namespace rage
@@ -1,9 +1,21 @@
 #pragma once
 
+#include "allocator.hpp"
+#include "layout.hpp"
+#include "matrix_file.hpp"
 #include "matrix_iterator.hpp"
 #include "col.hpp"
+#include "compare.hpp"
+#include "gemm.hpp"
+#include "gemv.hpp"
+#include "simd.hpp"
+#include "strassen.hpp"
+#include "expression.hpp"
+#include "thread_pool.hpp"
+#include "transpose.hpp"
 
 #include <array>
+#include <cstdint>
 #include <vector>
 #include <cassert>
 #include <algorithm>
@@ -11,6 +23,7 @@
 #include <span>
 #include <concepts>
 #include <functional>
+#include <memory>
 
 //* concepts examples: https://itnext.io/c-20-concepts-complete-guide-42c9e009c6bf
 //* e.g std::common_type_t<const double, const int> == double
@@ -20,7 +33,7 @@ class TD; //! debug
 
 namespace rage
 {
-    template <typename T, typename Morph = internal_impl::DefaultMorph<T>>
+    template <typename T, typename Morph = internal_impl::DefaultMorph<T>, typename Layout = RowMajor>
     // requires internal_impl::MorphConcept<Morph, T> - weird, does not compile
     class MatrixView;
 
@@ -57,230 +70,396 @@ namespace rage {
 //! *** Matrix
 //! ***
 
-//template <typename T, std::size_t RowsCountSize = 0, std::size_t ColsCountSize = 0>
-template <typename T>
+//* Fixed size matrices on the stack are FixedMatrix<T, Rows, Cols>, see fixed_matrix.hpp
+//* Alloc is a standard style allocator, AlignedAllocator<T> (64 bytes) by default, see allocator.hpp
+//* Layout is RowMajor or ColMajor (layout.hpp): with ColMajor the columns are contiguous and Col() is a span
+//* Lines (rows, or columns with ColMajor) may be padded: LeadingDimension() is the distance between the start of two lines
+template <typename T, typename Alloc, typename Layout>
 class Matrix
 {
+    static_assert(internal_impl::LayoutPolicy<Layout>, "Layout must be RowMajor or ColMajor");
+
+    using AllocTraits_ = std::allocator_traits<Alloc>;
+    static_assert(std::is_same_v<typename AllocTraits_::value_type, T>, "Alloc::value_type must be T");
+
+    using ViewType_ = MatrixView<T, internal_impl::DefaultMorph<T>, Layout>;
+    using ConstViewType_ = MatrixView<const T, internal_impl::DefaultMorph<const T>, Layout>;
+
 public:
-    constexpr explicit Matrix(std::size_t rows, std::size_t cols)
+    constexpr explicit Matrix(std::size_t rows, std::size_t cols, const Alloc& alloc = Alloc{})
+        :   Matrix(rows, cols, Layout::LineLength(rows, cols), alloc)
+    {}
+
+    //* e.g Matrix<double> m(512, 512, PaddedLeadingDimension<double>(512));
+    constexpr explicit Matrix(std::size_t rows, std::size_t cols, std::size_t leading_dimension, const Alloc& alloc = Alloc{})
         :   rows_count_{rows},
             cols_count_{cols},
-            data_{new T[rows * cols]},
+            ld_{leading_dimension},
+            alloc_{alloc},
+            data_{Allocate_(StorageSize_())},
             view_{View_()}
-    {}
+    {
+        assert(leading_dimension >= Layout::LineLength(rows, cols) && "Leading dimension must be at least the length of a line");
+    }
 
     //TODO change this to take in a range<range<T>>
     constexpr  explicit Matrix(std::vector<std::vector<T>>&& data)
         :   rows_count_{data.size()},
-            cols_count_{data.size()},
-            data_{new T[rows_count_ * cols_count_]},
+            cols_count_{data.empty() ? 0 : data[0].size()},
+            ld_{Layout::LineLength(rows_count_, cols_count_)},
+            data_{Allocate_(StorageSize_())},
             view_{View_()}
     {
         for (std::size_t i{0}; i < data.size(); ++i) {
             assert(data[i].size() == data[0].size() && "Rows must all have same length"); //TODO
-            std::move(data[i].begin(), data[i].end(), data_ + i * cols_count_);
+            if constexpr (internal_impl::IsRowMajor<Layout>) {
+                std::move(data[i].begin(), data[i].end(), data_ + i * ld_);
+            } else {
+                for (std::size_t j{0}; j < data[i].size(); ++j)
+                    At(i, j) = std::move(data[i][j]);
+            }
         }
     }
 
     //TODO constructor from MatrixView
 
-    template <typename W>
-    requires std::convertible_to<W, T>
-    constexpr  Matrix(const Matrix<W>& m)
-        :   rows_count_{m.RowsCount()},
-            cols_count_{m.ColsCount()},
-            data_{new int[m.Size()]},
-            view_{View_()}
+    //* materializes a lazy expression, e.g Matrix<int> m = a + b - c * 2;
+    template <internal_impl::Expression E>
+    requires std::convertible_to<typename E::ValueType, T>
+    constexpr Matrix(const E& expr)
+        :   Matrix(expr.RowsCount(), expr.ColsCount())
     {
-        std::copy(m.data_, m.data_ + m.Size(), data_);
+        internal_impl::Evaluate<Layout>(expr, data_, ld_);
     }
 
-    template <typename W>
-    requires std::convertible_to<W, T>
-    constexpr  Matrix<T> operator=(const Matrix<W>& m)
+    template <internal_impl::Expression E>
+    requires std::convertible_to<typename E::ValueType, T>
+    constexpr Matrix(const E& expr, ThreadPool& pool)
+        :   Matrix(expr.RowsCount(), expr.ColsCount())
     {
-        rows_count_ = m.RowsCount();
-        cols_count_ = m.ColsCount();
-        delete[] data_;
-        data_ = new T[m.Size()];
-        std::copy(m.data_, m.data_ + m.Size(), data_);
+        internal_impl::Evaluate<Layout>(expr, data_, ld_, pool);
+    }
+
+    //* same dimensions: evaluated straight into the existing buffer, no allocation,
+    //* unless the expression reads this matrix at other positions (m = m + m.Transposed())
+    template <internal_impl::Expression E>
+    requires std::convertible_to<typename E::ValueType, T>
+    constexpr Matrix& operator=(const E& expr)
+    {
+        bool in_place{expr.RowsCount() == rows_count_ && expr.ColsCount() == cols_count_};
+        if !consteval {
+            in_place = in_place && !internal_impl::ReadsShifted<Layout>(expr, data_, ld_);
+        }
+        if (in_place) {
+            internal_impl::Evaluate<Layout>(expr, data_, ld_);
+            return *this;
+        }
+
+        // the expression may still be reading from this matrix
+        const auto ld{Layout::LineLength(expr.RowsCount(), expr.ColsCount())};
+        T* data{Allocate_(expr.Size())};
+        internal_impl::Evaluate<Layout>(expr, data, ld);
+        Deallocate_();
+        data_ = data;
+        rows_count_ = expr.RowsCount();
+        cols_count_ = expr.ColsCount();
+        ld_ = ld;
         view_ = View_();
+        return *this;
     }
 
-    template <typename W>
+    //* deep copy, unpadded
+    constexpr Matrix(const Matrix& m)
+        :   rows_count_{m.rows_count_},
+            cols_count_{m.cols_count_},
+            ld_{Layout::LineLength(rows_count_, cols_count_)},
+            alloc_{AllocTraits_::select_on_container_copy_construction(m.alloc_)},
+            data_{Allocate_(StorageSize_())},
+            view_{View_()}
+    {
+        CopyFrom_(m);
+    }
+
+    template <typename W, typename A, typename L>
     requires std::convertible_to<W, T>
-    constexpr  Matrix(Matrix<T>&& m)
+    constexpr  Matrix(const Matrix<W, A, L>& m)
         :   rows_count_{m.RowsCount()},
             cols_count_{m.ColsCount()},
+            ld_{Layout::LineLength(rows_count_, cols_count_)},
+            data_{Allocate_(m.Size())},
+            view_{View_()}
+    {
+        CopyFrom_(m);
+    }
+
+    //* takes the buffer, m is left empty (0 x 0)
+    constexpr Matrix(Matrix&& m) noexcept
+        :   rows_count_{m.rows_count_},
+            cols_count_{m.cols_count_},
+            ld_{m.ld_},
+            alloc_{std::move(m.alloc_)},
             data_{m.data_},
             view_{View_()}
     {
-        m.rows_count_ = 0;
-        m.cols_count_ = 0;
-        m.data_ = nullptr;
+        m.Release_();
     }
 
-    template <typename W>
+    //* same dimensions: copied into the existing buffer, no allocation
+    constexpr Matrix& operator=(const Matrix& m)
+    {
+        if (this != &m)
+            Assign_(m);
+        return *this;
+    }
+
+    template <typename W, typename A, typename L>
     requires std::convertible_to<W, T>
-    constexpr  Matrix<T> operator=(Matrix<T>&& m)
+    constexpr Matrix& operator=(const Matrix<W, A, L>& m)
+    {
+        Assign_(m);
+        return *this;
+    }
+
+    constexpr Matrix& operator=(Matrix&& m) noexcept(AllocTraits_::propagate_on_container_move_assignment::value
+                                                     || AllocTraits_::is_always_equal::value)
     {
-        rows_count_ = m.RowsCount();
-        cols_count_ = m.ColsCount();
-        delete[] data_;
+        if (this == &m)
+            return *this;
+        // the buffer can only change hands between allocators that are able to free each other's memory
+        if constexpr (!AllocTraits_::propagate_on_container_move_assignment::value && !AllocTraits_::is_always_equal::value) {
+            if (alloc_ != m.alloc_) {
+                Assign_(m);
+                return *this;
+            }
+        }
+
+        Deallocate_();
+        if constexpr (AllocTraits_::propagate_on_container_move_assignment::value)
+            alloc_ = std::move(m.alloc_);
+        rows_count_ = m.rows_count_;
+        cols_count_ = m.cols_count_;
+        ld_ = m.ld_;
         data_ = m.data_;
         view_ = View_();
-        m.rows_count_ = 0;
-        m.cols_count_ = 0;
-        m.data_ = nullptr;
+        m.Release_();
+        return *this;
     }
 
-    constexpr ~Matrix() { delete[] data_; }
+    constexpr ~Matrix() { Deallocate_(); }
 
 public:
     template <typename W>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr Matrix& Add(const W& val) { view_.Add(val); return *this; };
+    constexpr Matrix& Add(const W& val) { view_.Add(val); return *this; }
 
-    template <typename W>
+    template <typename W, typename M, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr Matrix<T>& Add(const MatrixView<W>& mv) { view_.Add(mv); return *this; }
+    constexpr Matrix& Add(const MatrixView<W, M, L>& mv) { view_.Add(mv); return *this; }
 
-    template <typename W>
+    template <typename W, typename A, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr Matrix<T>& Add(const Matrix<W>& m) { return Add(m.view_); }
+    constexpr Matrix& Add(const Matrix<W, A, L>& m) { return Add(m.view_); }
 
     template <typename W>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr Matrix& Sub(const W& val) { view_.Sub(val); return *this; };
+    constexpr Matrix& Sub(const W& val) { view_.Sub(val); return *this; }
 
-    template <typename W>
+    template <typename W, typename M, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr Matrix<T>& Sub(const MatrixView<W>& mv) { view_.Sub(mv); return *this; }
+    constexpr Matrix& Sub(const MatrixView<W, M, L>& mv) { view_.Sub(mv); return *this; }
 
-    template <typename W>
+    template <typename W, typename A, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr Matrix<T>& Sub(const Matrix<W>& m) { return Sub(m.view_); }
+    constexpr Matrix& Sub(const Matrix<W, A, L>& m) { return Sub(m.view_); }
+
+    //* on the given pool or per an execution policy, see MatrixView
+    template <typename W>
+    requires Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    Matrix& Add(const W& operand, ThreadPool& pool) { view_.Add(operand, pool); return *this; }
+
+    template <typename W>
+    requires Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    Matrix& Sub(const W& operand, ThreadPool& pool) { view_.Sub(operand, pool); return *this; }
+
+    template <internal_impl::ExecutionPolicy P, typename W>
+    requires Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    Matrix& Add(const P& policy, const W& operand) { return Add(operand, internal_impl::PoolOf(policy)); }
+
+    template <internal_impl::ExecutionPolicy P, typename W>
+    requires Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    Matrix& Sub(const P& policy, const W& operand) { return Sub(operand, internal_impl::PoolOf(policy)); }
 
     //TODO Mult by a T val; also for MatrixView
 
 //* Views
 public:
-    constexpr MatrixView<T>& View() {
+    constexpr ViewType_& View() {
         return view_;
     }
     
-    constexpr MatrixView<const T> View() const {
-        return MatrixView<const T>{&At(0, 0), rows_count_, cols_count_, cols_count_};
+    constexpr ConstViewType_ View() const {
+        return ConstViewType_{data_, rows_count_, cols_count_, ld_};
     }
 
-    constexpr MatrixView<const T> ConstView() const {
+    constexpr ConstViewType_ ConstView() const {
         return View();
     }
 
-    constexpr MatrixView<T> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) {
+    constexpr ViewType_ View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) {
         const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
-        return MatrixView<T>{&At(rows[0], cols[0]), rows_count, cols_count, cols_count_};
+        return ViewType_{&At(rows[0], cols[0]), rows_count, cols_count, ld_};
     }
     
-    constexpr MatrixView<const T> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) const {
+    constexpr ConstViewType_ View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) const {
         const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
-        return MatrixView<const T>{&At(rows[0], cols[0]), rows_count, cols_count, cols_count_};
+        return ConstViewType_{&At(rows[0], cols[0]), rows_count, cols_count, ld_};
     }
 
-    constexpr MatrixView<const T> ConstView(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) const {
+    constexpr ConstViewType_ ConstView(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) const {
         return View(rows, cols);
     }
 
+    //* zero-copy, the transposed view of a row-major matrix is column-major (and the other way around)
+    constexpr auto Transposed() { return view_.Transposed(); }
+    constexpr auto Transposed() const { return View().Transposed(); }
+
 //* Views with a morph function
 //TODO maybe "just" add a new optional parameter in the existing functions
 public:
     template <typename Morph>
     requires internal_impl::MorphConcept<Morph, T>
-    constexpr MatrixView<T, Morph> View(Morph&& morph) {
-        return MatrixView<T, Morph>{&At(0, 0), rows_count_, cols_count_, cols_count_,
-                                    std::forward<Morph>(morph)};
+    constexpr MatrixView<T, std::decay_t<Morph>, Layout> View(Morph&& morph) {
+        return MatrixView<T, std::decay_t<Morph>, Layout>{data_, rows_count_, cols_count_, ld_,
+                                                          std::forward<Morph>(morph)};
     }
 
     template <typename Morph>
     requires internal_impl::MorphConcept<Morph, T>
-    constexpr MatrixView<const T, Morph> View(Morph&& morph) const {
-        return MatrixView<const T, Morph>{&At(0, 0), rows_count_, cols_count_, cols_count_,
-                                          std::forward<Morph>(morph)};
+    constexpr MatrixView<const T, std::decay_t<Morph>, Layout> View(Morph&& morph) const {
+        return MatrixView<const T, std::decay_t<Morph>, Layout>{data_, rows_count_, cols_count_, ld_,
+                                                                std::forward<Morph>(morph)};
     }
 
     template <typename Morph>
     requires internal_impl::MorphConcept<Morph, T>
-    constexpr MatrixView<const T, Morph> ConstView(Morph&& morph) const {
-        return View();
+    constexpr MatrixView<const T, std::decay_t<Morph>, Layout> ConstView(Morph&& morph) const {
+        return View(std::forward<Morph>(morph));
     }
 
     template <typename Morph>
     requires internal_impl::MorphConcept<Morph, T>
-    constexpr MatrixView<T, Morph> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols, Morph&& morph) {
+    constexpr MatrixView<T, std::decay_t<Morph>, Layout> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols, Morph&& morph) {
         const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
-        return MatrixView<T, Morph>{&At(rows[0], cols[0]), rows_count, cols_count, cols_count_, std::forward<Morph>(morph)};
+        return MatrixView<T, std::decay_t<Morph>, Layout>{&At(rows[0], cols[0]), rows_count, cols_count, ld_, std::forward<Morph>(morph)};
     }
 
     template <typename Morph>
     requires internal_impl::MorphConcept<Morph, T>
-    constexpr MatrixView<const T, Morph> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols, Morph&& morph) {
+    constexpr MatrixView<const T, std::decay_t<Morph>, Layout> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols, Morph&& morph) const {
         const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
-        return MatrixView<const T, Morph>{&At(rows[0], cols[0]), rows_count, cols_count, cols_count_, std::forward<Morph>(morph)};
+        return MatrixView<const T, std::decay_t<Morph>, Layout>{&At(rows[0], cols[0]), rows_count, cols_count, ld_, std::forward<Morph>(morph)};
     }
 
 //* Iterators
+//* over the rows: spans for RowMajor, strided Columns for ColMajor
 public:
-    constexpr MatrixIterator<T> begin() {
-        return MatrixIterator<T>{data_, cols_count_, cols_count_};
-    }
-    constexpr MatrixIterator<T> end() {
-        return MatrixIterator<T>{data_ + Size(), cols_count_, cols_count_};
-    }
+    constexpr auto begin() { return view_.begin(); }
+    constexpr auto end() { return view_.end(); }
 
-    constexpr MatrixIterator<const T> begin() const {
-        return MatrixIterator<const T>{data_, cols_count_, cols_count_};
-    }
-    constexpr MatrixIterator<const T> end() const {
-        return MatrixIterator<const T>{data_ + Size(), cols_count_, cols_count_};
-    }
+    constexpr auto begin() const { return View().begin(); }
+    constexpr auto end() const { return View().end(); }
 
-    constexpr MatrixIterator<const T> cbegin() const {
-        return begin();
-    }
-    constexpr MatrixIterator<const T> cend() const {
-        return end();
-    }
+    constexpr auto cbegin() const { return begin(); }
+    constexpr auto cend() const { return end(); }
 
 //* Access methods
 public:
-    constexpr inline std::span<T> Data() { return std::span<T>{data_, Size()}; }
-    constexpr inline std::span<const T> Data() const { return std::span<const T>{data_, Size()}; }
+    //* the whole buffer, including the padding at the end of the lines when LeadingDimension() is bigger than a line
+    constexpr inline std::span<T> Data() { return std::span<T>{data_, StorageSize_()}; }
+    constexpr inline std::span<const T> Data() const { return std::span<const T>{data_, StorageSize_()}; }
+
+    //* every element as one contiguous range, line after line: std algorithms (and the parallel STL) get plain pointers
+    //* Unpadded matrices only, a padded one has holes between its lines
+    constexpr std::span<T> Elements() {
+        assert(ld_ == Layout::LineLength(rows_count_, cols_count_) && "Elements() needs an unpadded matrix");
+        return std::span<T>{data_, Size()};
+    }
+
+    constexpr std::span<const T> Elements() const {
+        assert(ld_ == Layout::LineLength(rows_count_, cols_count_) && "Elements() needs an unpadded matrix");
+        return std::span<const T>{data_, Size()};
+    }
     
     constexpr inline std::size_t RowsCount() const { return rows_count_; }
     constexpr inline std::size_t ColsCount() const { return cols_count_; }
 
-    constexpr std::span<const T> Row(std::size_t r) const { return std::span<const T>(&At(r, 0), cols_count_); }
-    constexpr std::span<T> Row(std::size_t r) { return std::span<T>(&At(r, 0), cols_count_); }
+    //* std::span for RowMajor, a strided Column for ColMajor
+    constexpr auto Row(std::size_t r) const { return View().Row(r); }
+    constexpr auto Row(std::size_t r) { return view_.Row(r); }
     
-    constexpr std::span<const T> operator[](std::size_t r) const { return Row(r); }
-    constexpr std::span<T> operator[](std::size_t r) { return Row(r); }
+    constexpr auto operator[](std::size_t r) const { return Row(r); }
+    constexpr auto operator[](std::size_t r) { return Row(r); }
 
-    constexpr Column<const T> Col(std::size_t c) const { return Column<const T>{&At(0, c), cols_count_, rows_count_}; }
-    constexpr Column<T> Col(std::size_t c) { return Column<T>{&At(0, c), cols_count_, rows_count_}; }
+    //* a strided Column for RowMajor, std::span for ColMajor
+    constexpr auto Col(std::size_t c) const { return View().Col(c); }
+    constexpr auto Col(std::size_t c) { return view_.Col(c); }
     
-    const T& At(std::size_t r, std::size_t c) const { return data_[r * cols_count_ + c]; }
-    T& At(std::size_t r, std::size_t c) { return data_[r * cols_count_ + c]; }
+    const T& At(std::size_t r, std::size_t c) const { return data_[Layout::Offset(r, c, ld_)]; }
+    T& At(std::size_t r, std::size_t c) { return data_[Layout::Offset(r, c, ld_)]; }
 
 //* Lower level operations
 //? public or private?
 public:
-    std::size_t Size() const { return rows_count_ * cols_count_; }
+    constexpr std::size_t Size() const { return rows_count_ * cols_count_; }
+
+    //* distance between the start of two consecutive lines (rows for RowMajor, columns for ColMajor)
+    constexpr std::size_t LeadingDimension() const { return ld_; }
+
+    constexpr T* RawData() { return data_; }
+    constexpr const T* RawData() const { return data_; }
+
+    constexpr Alloc GetAllocator() const { return alloc_; }
+
+    //* Moves the data, unlike Transposed(): afterwards the matrix is its own transpose, in the same Layout.
+    //* Square matrices keep their leading dimension. Other shapes come out unpadded (so ReinterpretDimensions
+    //* works on them), in place when they were unpadded already, through a new buffer otherwise.
+    Matrix& TransposeInPlace() { return TransposeInPlace(ThreadPool::Default()); }
+
+    Matrix& TransposeInPlace(ThreadPool& pool) {
+        const auto lines{Layout::LinesCount(rows_count_, cols_count_)};
+        const auto length{Layout::LineLength(rows_count_, cols_count_)};
+
+        if (rows_count_ == cols_count_) {
+            internal_impl::TransposeSquareInPlace(data_, ld_, rows_count_, pool);
+        } else if (ld_ == length) {
+            internal_impl::TransposeCyclesInPlace(data_, lines, length);
+        } else {
+            T* data{Allocate_(Size())};
+            internal_impl::Transpose(data_, ld_, data, lines, lines, length, pool);
+            Deallocate_();
+            data_ = data;
+        }
+
+        if (rows_count_ != cols_count_)
+            ld_ = lines;
+        std::swap(rows_count_, cols_count_);
+        view_ = View_();
+        return *this;
+    }
 
+    //* the binary format of matrix_file.hpp, the buffer as is (leading dimension and padding included),
+    //* so MapMatrix gives back the same lines without a copy. Throws std::runtime_error when the write fails
+    void Save(const std::filesystem::path& path) const requires internal_impl::Storable<T> {
+        internal_impl::WriteMatrixFile<T, Layout>(path, data_, rows_count_, cols_count_, ld_);
+    }
+
+    //* only for unpadded matrices, the padding would end up in the middle of the new lines
     bool ReinterpretDimensions(std::size_t new_row_count, std::size_t new_col_count) {
-        if (new_row_count * new_col_count != rows_count_ * cols_count_)
+        if (ld_ != Layout::LineLength(rows_count_, cols_count_) || new_row_count * new_col_count != rows_count_ * cols_count_)
             return false;
         rows_count_ = new_row_count;
         cols_count_ = new_col_count;
+        ld_ = Layout::LineLength(rows_count_, cols_count_);
         view_ = View_();
         return true;
     }
@@ -298,19 +477,77 @@ private:
         return {rows_count, cols_count};
     }
 
-    constexpr MatrixView<T> View_() {
-        return MatrixView<T>{&At(0, 0), rows_count_, cols_count_, cols_count_};
+    constexpr ViewType_ View_() {
+        return ViewType_{data_, rows_count_, cols_count_, ld_};
+    }
+
+    constexpr std::size_t StorageSize_() const { return Layout::LinesCount(rows_count_, cols_count_) * ld_; }
+
+    //* default initialized, like new T[count]
+    constexpr T* Allocate_(std::size_t count) {
+        T* data{AllocTraits_::allocate(alloc_, count)};
+        if constexpr (!std::is_trivially_default_constructible_v<T>)
+            std::uninitialized_default_construct_n(data, count);
+        return data;
+    }
+
+    constexpr void Deallocate_() {
+        if (data_ == nullptr)
+            return;
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            std::destroy_n(data_, StorageSize_());
+        AllocTraits_::deallocate(alloc_, data_, StorageSize_());
+    }
+
+    template <typename W, typename A, typename L>
+    constexpr void Assign_(const Matrix<W, A, L>& m) {
+        if (m.RowsCount() != rows_count_ || m.ColsCount() != cols_count_) {
+            T* data{Allocate_(m.Size())};
+            Deallocate_();
+            data_ = data;
+            rows_count_ = m.RowsCount();
+            cols_count_ = m.ColsCount();
+            ld_ = Layout::LineLength(rows_count_, cols_count_);
+            view_ = View_();
+        }
+        CopyFrom_(m);
+    }
+
+    //* forgets the buffer, which now belongs to another matrix
+    constexpr void Release_() {
+        rows_count_ = 0;
+        cols_count_ = 0;
+        ld_ = 0;
+        data_ = nullptr;
+        view_ = View_();
+    }
+
+    //* line by line when both are stored the same way, element by element otherwise
+    template <typename W, typename A, typename L>
+    constexpr void CopyFrom_(const Matrix<W, A, L>& m) {
+        if constexpr (std::is_same_v<L, Layout>) {
+            const auto length{Layout::LineLength(rows_count_, cols_count_)};
+            for (std::size_t line{0}; line < Layout::LinesCount(rows_count_, cols_count_); ++line)
+                std::copy(m.data_ + line * m.ld_, m.data_ + line * m.ld_ + length, data_ + line * ld_);
+        } else {
+            for (std::size_t r{0}; r < rows_count_; ++r) {
+                for (std::size_t c{0}; c < cols_count_; ++c)
+                    At(r, c) = static_cast<T>(m.At(r, c));
+            }
+        }
     }
 
 private:
     std::size_t rows_count_;
     std::size_t cols_count_;
+    std::size_t ld_;
+    [[no_unique_address]] Alloc alloc_{};
     T* data_;
-    MatrixView<T> view_;
+    ViewType_ view_;
 
 private:
-    template <typename U, typename M> friend class MatrixView;
-    template <typename U> friend class Matrix;
+    template <typename U, typename M, typename L> friend class MatrixView;
+    template <typename U, typename A, typename L> friend class Matrix;
 };
 
 //*
@@ -318,102 +555,281 @@ private:
 
 //TODO fix the requires, take account that morph may change type
 
-template <typename T, typename W, typename M1, typename M2>
+//* element by element, so views stored in different orders (and transposed views) compare by value.
+//* Plain views of the same type and layout compare their lines as memory instead (see compare.hpp)
+template <typename T, typename W, typename M1, typename M2, typename L1, typename L2>
 //requires std::equality_comparable_with<T, W>
-constexpr bool operator==(const MatrixView<T, M1>& lhs, const MatrixView<W, M2>& rhs) {
-    for (const auto& [lrow, rrow] : std::views::zip(lhs, rhs)) {
-        for (const auto& [lval, rval] : std::views::zip(lrow, rrow)) {
-            if (lval != rval) return false;
+constexpr bool operator==(const MatrixView<T, M1, L1>& lhs, const MatrixView<W, M2, L2>& rhs) {
+    if (lhs.RowsCount() != rhs.RowsCount() || lhs.ColsCount() != rhs.ColsCount())
+        return false;
+
+    if constexpr (internal_impl::IsDefaultMorph<M1> && internal_impl::IsDefaultMorph<M2> && std::is_same_v<L1, L2>
+                  && std::is_same_v<std::remove_const_t<T>, std::remove_const_t<W>>) {
+        if !consteval {
+            const auto rows{lhs.RowsCount()};
+            const auto cols{lhs.ColsCount()};
+            return internal_impl::LinesEqual<std::remove_const_t<T>>(lhs.RawData(), lhs.LeadingDimension(),
+                                                                     rhs.RawData(), rhs.LeadingDimension(),
+                                                                     L1::LinesCount(rows, cols), L1::LineLength(rows, cols));
+        }
+    }
+
+    for (std::size_t r{0}; r < lhs.RowsCount(); ++r) {
+        for (std::size_t c{0}; c < lhs.ColsCount(); ++c) {
+            if (lhs.At(r, c) != rhs.At(r, c)) return false;
         }
     }
     
     return true;
 }
 
-template <typename T, typename W>
+template <typename T, typename W, typename M, typename A, typename L1, typename L2>
 //requires std::equality_comparable_with<T, W>
-constexpr bool operator==(const MatrixView<T>& lhs, const Matrix<W>& rhs) {
+constexpr bool operator==(const MatrixView<T, M, L1>& lhs, const Matrix<W, A, L2>& rhs) {
     return lhs == rhs.View();
 }
 
-template <typename T, typename W, typename M>
+template <typename T, typename W, typename M, typename A, typename L1, typename L2>
 //requires std::equality_comparable_with<T, W>
-constexpr bool operator==(const Matrix<T>& lhs, const MatrixView<W, M>& rhs) {
+constexpr bool operator==(const Matrix<T, A, L1>& lhs, const MatrixView<W, M, L2>& rhs) {
     return lhs.View() == rhs;
 }
 
-template <typename T, typename W>
+template <typename T, typename W, typename A1, typename A2, typename L1, typename L2>
 //requires std::equality_comparable_with<T, W>
-constexpr bool operator==(const Matrix<T>& lhs, const Matrix<W>& rhs) {
+constexpr bool operator==(const Matrix<T, A1, L1>& lhs, const Matrix<W, A2, L2>& rhs) {
     return lhs.View() == rhs.View();
 }
 
+//* expression or FixedMatrix == anything, the other way around is covered by the rewritten candidate
+template <internal_impl::MatrixLike E, internal_impl::MatrixLike M>
+requires internal_impl::Expression<E> || internal_impl::FixedMatrixLike<E>
+constexpr bool operator==(const E& lhs, const M& rhs) {
+    if (lhs.RowsCount() != rhs.RowsCount() || lhs.ColsCount() != rhs.ColsCount())
+        return false;
+
+    for (std::size_t r{0}; r < lhs.RowsCount(); ++r) {
+        for (std::size_t c{0}; c < lhs.ColsCount(); ++c) {
+            if (lhs.At(r, c) != rhs.At(r, c)) return false;
+        }
+    }
+
+    return true;
+}
+
+//* Tolerance based comparison of floating point matrices, views, expressions..., the rules are in compare.hpp.
+//* The first mismatch is the first in storage order when both sides are plain memory in the same layout, row by row otherwise
+template <internal_impl::MatrixLike A, internal_impl::MatrixLike B,
+          typename R = std::common_type_t<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>>
+requires std::floating_point<R>
+ApproxResult ApproxEqual(const A& lhs, const B& rhs, std::type_identity_t<R> abs_tol = 0, std::type_identity_t<R> rel_tol = 0,
+                         std::uint64_t ulps = 4)
+{
+    if (lhs.RowsCount() != rhs.RowsCount() || lhs.ColsCount() != rhs.ColsCount())
+        return ApproxResult{.equal = false, .same_shape = false};
+
+    const internal_impl::Tolerance<R> tol{abs_tol, rel_tol, ulps};
+    const auto lhs_operand{internal_impl::ToOperand(lhs)};
+    const auto rhs_operand{internal_impl::ToOperand(rhs)};
+    using LhsOperand = std::remove_const_t<decltype(lhs_operand)>;
+    using RhsOperand = std::remove_const_t<decltype(rhs_operand)>;
+
+    if constexpr (internal_impl::IsRawView<R, LhsOperand>::value && internal_impl::IsRawView<R, RhsOperand>::value
+                  && std::is_same_v<typename internal_impl::LayoutOf_<LhsOperand>::type, typename internal_impl::LayoutOf_<RhsOperand>::type>) {
+        using Layout = typename internal_impl::LayoutOf_<LhsOperand>::type;
+        const auto lines{Layout::LinesCount(lhs.RowsCount(), lhs.ColsCount())};
+        const auto length{Layout::LineLength(lhs.RowsCount(), lhs.ColsCount())};
+        for (std::size_t line{0}; line < lines; ++line) {
+            const auto i{internal_impl::FirstApproxMismatch(lhs_operand.RawData() + line * lhs_operand.LeadingDimension(),
+                                                            rhs_operand.RawData() + line * rhs_operand.LeadingDimension(), length, tol)};
+            if (i != length) {
+                return internal_impl::IsRowMajor<Layout> ? ApproxResult{.equal = false, .row = line, .col = i}
+                                                         : ApproxResult{.equal = false, .row = i, .col = line};
+            }
+        }
+    } else {
+        for (std::size_t r{0}; r < lhs.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < lhs.ColsCount(); ++c) {
+                if (!internal_impl::Close(static_cast<R>(lhs_operand.At(r, c)), static_cast<R>(rhs_operand.At(r, c)), tol))
+                    return ApproxResult{.equal = false, .row = r, .col = c};
+            }
+        }
+    }
+
+    return ApproxResult{};
+}
+
 //! ***
 //! ***
 //! *** MatrixView
 //! ***
 
-template <typename T, typename Morph>
+//* Layout is the storage order of the viewed buffer, Transposed() swaps it along with the dimensions
+template <typename T, typename Morph, typename Layout>
 // requires internal_impl::MorphConcept<Morph, T> - weird, does not compile
 class MatrixView
 {
-    using RealValueType = std::conditional_t<std::is_same_v<Morph, internal_impl::DefaultMorph<T>>,
+    using RealValueType = std::conditional_t<internal_impl::IsDefaultMorph<Morph>,
                                              T,
                                              std::invoke_result_t<Morph, T>>;
 
+    //* the morph of a read-only view of this one, so const views of plain views are still MatrixView<const T>
+    using ConstMorph_ = std::conditional_t<internal_impl::IsDefaultMorph<Morph>, internal_impl::DefaultMorph<const T>, Morph>;
+
+    using TransposedLayout_ = typename Layout::Transposed;
+
+//* Views over memory owned by the caller (network frames, shared memory, arrays of other libraries):
+//* no copy and no ownership, the buffer must outlive the view. Every operator and kernel takes them as any other view.
+public:
+    //* data holds LinesCount(rows, cols) lines (rows for RowMajor, columns for ColMajor), leading_dimension elements apart
+    static constexpr MatrixView FromBuffer(T* data, std::size_t rows, std::size_t cols, std::size_t leading_dimension, Morph morph = {}) {
+        assert(leading_dimension >= Layout::LineLength(rows, cols) && "Leading dimension must be at least the length of a line");
+        assert((data != nullptr || rows * cols == 0) && "Null buffer");
+        return MatrixView{data, rows, cols, leading_dimension, std::move(morph)};
+    }
+
+    //* unpadded lines
+    static constexpr MatrixView FromBuffer(T* data, std::size_t rows, std::size_t cols) {
+        return FromBuffer(data, rows, cols, Layout::LineLength(rows, cols));
+    }
+
+    //* also checks that the lines fit in the buffer
+    static constexpr MatrixView FromBuffer(std::span<T> buffer, std::size_t rows, std::size_t cols, std::size_t leading_dimension) {
+        const auto lines{Layout::LinesCount(rows, cols)};
+        assert((lines == 0 || (lines - 1) * leading_dimension + Layout::LineLength(rows, cols) <= buffer.size())
+               && "Buffer too small for these dimensions");
+        return FromBuffer(buffer.data(), rows, cols, leading_dimension);
+    }
+
+    static constexpr MatrixView FromBuffer(std::span<T> buffer, std::size_t rows, std::size_t cols) {
+        return FromBuffer(buffer, rows, cols, Layout::LineLength(rows, cols));
+    }
+
 //* Operations
 public:
     template <typename W>
     requires Addable<T, W> && std::convertible_to<W, T>
     constexpr MatrixView& Add(const W& val);
 
-    template <typename W, typename M>
+    template <typename W, typename M, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr MatrixView& Add(const MatrixView<W, M>& mv);
+    constexpr MatrixView& Add(const MatrixView<W, M, L>& mv);
 
-    template <typename W>
+    template <typename W, typename A, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr MatrixView& Add(const Matrix<W>& m) { return Add(m.view_); }
+    constexpr MatrixView& Add(const Matrix<W, A, L>& m) { return Add(m.view_); }
 
     template <typename W>
     requires Addable<T, W> && std::convertible_to<W, T>
     constexpr MatrixView& Sub(const W& val) { return Add(-val); }
 
-    template <typename W, typename M>
+    template <typename W, typename M, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr MatrixView& Sub(const MatrixView<W, M>& rhs) {
+    constexpr MatrixView& Sub(const MatrixView<W, M, L>& rhs) {
         return Add(rhs.View([](const W& elem){ return -elem; }));
     }
 
-    template <typename W>
+    template <typename W, typename A, typename L>
     requires Addable<T, W> && std::convertible_to<W, T>
-    constexpr MatrixView& Sub(const Matrix<W>& m) { return Sub(m.view_); }
+    constexpr MatrixView& Sub(const Matrix<W, A, L>& m) { return Sub(m.view_); }
+
+    //* Add/Sub a value, matrix, view or expression on the given pool (or per an execution policy, first):
+    //* all of it goes in row blocks of this view, sub-views included, where the overloads above only split
+    //* the SIMD cases and run morphed operands or the other layout serially
+    //* An operand reading this view elsewhere (m.Add(m.Transposed(), pool)) goes through a temporary
+    template <typename W>
+    requires (!std::is_const_v<T>) && internal_impl::IsDefaultMorph<Morph>
+          && Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    MatrixView& Add(const W& operand, ThreadPool& pool) {
+        internal_impl::EvaluateAliased<Layout>(internal_impl::MakeExpression<std::plus<>>(*this, operand), data_start_, real_col_count_, pool);
+        return *this;
+    }
+
+    template <typename W>
+    requires (!std::is_const_v<T>) && internal_impl::IsDefaultMorph<Morph>
+          && Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    MatrixView& Sub(const W& operand, ThreadPool& pool) {
+        internal_impl::EvaluateAliased<Layout>(internal_impl::MakeExpression<std::minus<>>(*this, operand), data_start_, real_col_count_, pool);
+        return *this;
+    }
+
+    template <internal_impl::ExecutionPolicy P, typename W>
+    requires (!std::is_const_v<T>) && internal_impl::IsDefaultMorph<Morph>
+          && Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    MatrixView& Add(const P& policy, const W& operand) { return Add(operand, internal_impl::PoolOf(policy)); }
+
+    template <internal_impl::ExecutionPolicy P, typename W>
+    requires (!std::is_const_v<T>) && internal_impl::IsDefaultMorph<Morph>
+          && Addable<T, internal_impl::ValueOf<W>> && std::convertible_to<internal_impl::ValueOf<W>, T>
+    MatrixView& Sub(const P& policy, const W& operand) { return Sub(operand, internal_impl::PoolOf(policy)); }
+
+    //* materialize: a new matrix of the elements as this view shows them (morph applied), same layout
+    auto Eval(ThreadPool& pool) const {
+        using R = internal_impl::ValueOf<MatrixView>;
+        Matrix<R, AlignedAllocator<R>, Layout> result(rows_count_, cols_count_);
+        internal_impl::Evaluate<Layout>(*this, result.RawData(), result.LeadingDimension(), pool);
+        return result;
+    }
+
+    auto Eval() const { return Eval(ThreadPool::Default()); }
+
+    template <internal_impl::ExecutionPolicy P>
+    auto Eval(const P& policy) const { return Eval(internal_impl::PoolOf(policy)); }
+
+    //* Writes the result of a lazy expression into the viewed elements (unlike copy assignment,
+    //* which makes this view look at something else)
+    template <internal_impl::Expression E>
+    requires (!std::is_const_v<T>) && internal_impl::IsDefaultMorph<Morph>
+          && std::convertible_to<typename E::ValueType, T>
+    constexpr MatrixView& operator=(const E& expr) {
+        assert(expr.RowsCount() == rows_count_ && expr.ColsCount() == cols_count_ && "Dimensions must match");
+        if !consteval {
+            // reading the viewed elements elsewhere (an overlapping sub-view): through a temporary
+            if (internal_impl::ReadsShifted<Layout>(expr, data_start_, real_col_count_)) {
+                const Matrix<T, AlignedAllocator<T>, Layout> result{expr};
+                internal_impl::Evaluate<Layout>(result.View(), data_start_, real_col_count_);
+                return *this;
+            }
+        }
+        internal_impl::Evaluate<Layout>(expr, data_start_, real_col_count_);
+        return *this;
+    }
 
 //* Views
+//* A sub-view keeps the morph of this view
 public:
-    constexpr MatrixView<T> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) {
+    constexpr MatrixView<T, Morph, Layout> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) {
         const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
-        return MatrixView<T>{&RealAt(rows[0], cols[0]), rows_count, cols_count, cols_count_};
+        return MatrixView<T, Morph, Layout>{&RealAt(rows[0], cols[0]), rows_count, cols_count, real_col_count_, morph_};
+    }
+
+    constexpr MatrixView<const T, ConstMorph_, Layout> View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols) const {
+        const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
+        return MatrixView<const T, ConstMorph_, Layout>{&RealAt(rows[0], cols[0]), rows_count, cols_count, real_col_count_, ToConstMorph_()};
+    }
+
+    //* zero-copy: (r, c) of the result is (c, r) of this view, same buffer read in the other order
+    constexpr MatrixView<T, Morph, TransposedLayout_> Transposed() {
+        return MatrixView<T, Morph, TransposedLayout_>{data_start_, cols_count_, rows_count_, real_col_count_, morph_};
+    }
+
+    constexpr MatrixView<const T, ConstMorph_, TransposedLayout_> Transposed() const {
+        return MatrixView<const T, ConstMorph_, TransposedLayout_>{data_start_, cols_count_, rows_count_, real_col_count_, ToConstMorph_()};
     }
 
 
 //* View with morph
-//TODO confirm if im creating copies of the function/lambda/object create MyStruct { ctor; operator() } to check
+//* The new morph is applied after the current one, both keep their concrete type (no std::function),
+//* so a chain of views is one inlined call per element
 public:
     template <typename NewMorph>
     requires internal_impl::MorphConcept<NewMorph, RealValueType>
-    auto View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols, NewMorph&& new_morph)
+    constexpr auto View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols, NewMorph&& new_morph)
     {
         const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
-        using ret_type = typename decltype(std::function{std::declval<NewMorph>()})::result_type;
-        
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>) {
-            std::function<ret_type(T)> morph{new_morph};
-            return MatrixView<T, decltype(morph)>{&RealAt(0, 0), rows_count, cols_count, cols_count_, morph};
-        } else {
-            std::function<ret_type(T)> morph{ [this, new_morph](const T& v) { return new_morph(morph_(v)); } };
-            return MatrixView<T, decltype(morph)>{&RealAt(0, 0), rows_count, cols_count, cols_count_, morph};
-        }
+        using NextMorph = internal_impl::ComposeMorph<Morph, NewMorph>;
+        return MatrixView<T, NextMorph, Layout>{&RealAt(rows[0], cols[0]), rows_count, cols_count, real_col_count_,
+                                                internal_impl::Compose(morph_, std::forward<NewMorph>(new_morph))};
     }
 
     template <typename NewMorph>
@@ -421,15 +837,9 @@ public:
     constexpr auto View(const std::array<std::size_t, 2>& rows, const std::array<std::size_t, 2>& cols, NewMorph&& new_morph) const
     {
         const auto [rows_count, cols_count]{ViewImpl_(rows, cols)};
-        using ret_type = typename decltype(std::function{std::declval<NewMorph>()})::result_type;
-        
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>) {
-            std::function<ret_type(T)> morph{new_morph};
-            return MatrixView<const T, decltype(morph)>{&RealAt(0, 0), rows_count, cols_count, cols_count_, morph};
-        } else {
-            std::function<ret_type(T)> morph{ [this, new_morph](const T& v) { return new_morph(morph_(v)); } };
-            return MatrixView<const T, decltype(morph)>{&RealAt(0, 0), rows_count, cols_count, cols_count_, morph};
-        }
+        using NextMorph = internal_impl::ComposeMorph<Morph, NewMorph>;
+        return MatrixView<const T, NextMorph, Layout>{&RealAt(rows[0], cols[0]), rows_count, cols_count, real_col_count_,
+                                                      internal_impl::Compose(morph_, std::forward<NewMorph>(new_morph))};
     }
 
     template <typename NewMorph>
@@ -441,100 +851,85 @@ public:
     template <typename NewMorph>
     requires internal_impl::MorphConcept<NewMorph, RealValueType>
     constexpr auto View(NewMorph&& new_morph) {
-        return View({0, rows_count_ - 1}, {0, cols_count_ - 1}, new_morph);//std::forward<NewMorph>(new_morph));
+        return View({0, rows_count_ - 1}, {0, cols_count_ - 1}, std::forward<NewMorph>(new_morph));
     }
 
 
 //* Iterators
+//* over the rows: spans for RowMajor, strided Columns for ColMajor (the next row starts one element later)
 public:
-    constexpr MatrixIterator<T, Morph> begin() {
-        return MatrixIterator<T, Morph>{data_start_, cols_count_, real_col_count_, morph_};
-    }
-    constexpr MatrixIterator<T, Morph> end() {
-        return MatrixIterator<T, Morph>{data_start_ + rows_count_ * real_col_count_, 0, 0, morph_};
-    }
+    constexpr auto begin() { return RowIterator_<T>(data_start_); }
+    constexpr auto end() { return RowIterator_<T>(EndStart_()); }
 
-    constexpr MatrixIterator<const T, Morph> begin() const {
-        return cbegin();
-    }
-    constexpr MatrixIterator<const T, Morph> end() const {
-        return cend();
-    }
+    constexpr auto begin() const { return cbegin(); }
+    constexpr auto end() const { return cend(); }
 
-    constexpr MatrixIterator<const T, Morph> cbegin() const {
-        return MatrixIterator<const T, Morph>{data_start_, cols_count_, real_col_count_, morph_};
-    }
-    constexpr MatrixIterator<const T, Morph> cend() const {
-        return MatrixIterator<const T, Morph>{data_start_ + rows_count_ * real_col_count_, 0, 0, morph_};
-    }
+    constexpr auto cbegin() const { return RowIterator_<const T>(data_start_); }
+    constexpr auto cend() const { return RowIterator_<const T>(EndStart_()); }
 
 //* Access methods
 public:
     constexpr inline std::size_t RowsCount() const { return rows_count_; }
     constexpr inline std::size_t ColsCount() const { return cols_count_; }
 
-    constexpr auto Row(std::size_t r) {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-            return std::span<T>(&RealAt(r, 0), cols_count_);
-        else
-            return std::span<T>(&RealAt(r, 0), cols_count_) | std::views::transform(morph_);
-    }
-
-    constexpr auto Row(std::size_t r) const {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-            return std::span<const T>(&RealAt(r, 0), cols_count_);
-        else
-            return std::span<const T>(&RealAt(r, 0), cols_count_) | std::views::transform(morph_);
-    }
+    //* std::span for RowMajor (a transform_view of it with a morph), a strided Column for ColMajor
+    constexpr auto Row(std::size_t r) { return Line_<internal_impl::IsRowMajor<Layout>, T>(&RealAt(r, 0), real_col_count_, cols_count_); }
+    constexpr auto Row(std::size_t r) const { return Line_<internal_impl::IsRowMajor<Layout>, const T>(&RealAt(r, 0), real_col_count_, cols_count_); }
 
     constexpr auto operator[](std::size_t r) { return Row(r); }
 
     constexpr auto operator[](std::size_t r) const { return Row(r); }
 
-    constexpr Column<const T, Morph> Col(std::size_t c) const {
-        return Column<const T, Morph>{&RealAt(0, c), cols_count_, rows_count_, morph_};
-    }
-    constexpr Column<T, Morph> Col(std::size_t c) {
-        return Column<T, Morph>{&RealAt(0, c), cols_count_, rows_count_, morph_};
-    }
+    //* a strided Column for RowMajor, std::span for ColMajor
+    constexpr auto Col(std::size_t c) { return Line_<!internal_impl::IsRowMajor<Layout>, T>(&RealAt(0, c), real_col_count_, rows_count_); }
+    constexpr auto Col(std::size_t c) const { return Line_<!internal_impl::IsRowMajor<Layout>, const T>(&RealAt(0, c), real_col_count_, rows_count_); }
 
-    constexpr std::conditional_t<std::is_same_v<Morph, internal_impl::DefaultMorph<T>>, const T&, RealValueType>
+    constexpr std::conditional_t<internal_impl::IsDefaultMorph<Morph>, const T&, RealValueType>
     At(std::size_t r, std::size_t c) const {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-            return data_start_[r * real_col_count_ + c];
+        if constexpr (internal_impl::IsDefaultMorph<Morph>)
+            return RealAt(r, c);
         else
-            return morph(data_start_[r * real_col_count_ + c]);
+            return morph_(RealAt(r, c));
     }
     
-    constexpr std::conditional_t<std::is_same_v<Morph, internal_impl::DefaultMorph<T>>, T&, RealValueType>
+    constexpr std::conditional_t<internal_impl::IsDefaultMorph<Morph>, T&, RealValueType>
     At(std::size_t r, std::size_t c) {
-        if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-            return data_start_[r * real_col_count_ + c];
+        if constexpr (internal_impl::IsDefaultMorph<Morph>)
+            return RealAt(r, c);
         else
-            return morph(data_start_[r * real_col_count_ + c]);
+            return morph_(RealAt(r, c));
     }
 
 //* Lower level operations
 public:
     constexpr std::size_t Size() const { return rows_count_ * cols_count_; }
 
+    //* distance between the start of two consecutive lines (rows for RowMajor, columns for ColMajor)
+    constexpr std::size_t LeadingDimension() const { return real_col_count_; }
+
+    //* true when the lines follow each other in memory, so the view is one flat buffer
+    constexpr bool IsContiguous() const {
+        return real_col_count_ == Layout::LineLength(rows_count_, cols_count_) || Layout::LinesCount(rows_count_, cols_count_) <= 1;
+    }
+
+    constexpr T* RawData() { return data_start_; }
+    constexpr const T* RawData() const { return data_start_; }
+
+    //* every element as one contiguous range, line after line, for contiguous views without a morph
+    constexpr std::span<T> Elements() const requires internal_impl::IsDefaultMorph<Morph> {
+        assert(IsContiguous() && "Elements() needs a contiguous view");
+        return std::span<T>{data_start_, Size()};
+    }
+
 private:
     constexpr explicit MatrixView(T* data_start, std::size_t rows_count,
                                   std::size_t cols_count, std::size_t real_col_count,
-                                  Morph morph)
+                                  Morph morph = {})
         :   data_start_{data_start},
             rows_count_{rows_count},
             cols_count_{cols_count},
             real_col_count_{real_col_count},
-            morph_{morph}
-    {}
-
-    constexpr explicit MatrixView(T* data_start, std::size_t rows_count,
-                                  std::size_t cols_count, std::size_t real_col_count)
-        :   data_start_{data_start},
-            rows_count_{rows_count},
-            cols_count_{cols_count},
-            real_col_count_{real_col_count}
+            morph_{std::move(morph)}
     {}
 
 private:
@@ -551,19 +946,54 @@ private:
         return {rows_count, cols_count};
     }
 
-    constexpr const T& RealAt(std::size_t r, std::size_t c) const { return data_start_[r * real_col_count_ + c]; }
-    constexpr T& RealAt(std::size_t r, std::size_t c) { return data_start_[r * real_col_count_ + c]; }
+    constexpr ConstMorph_ ToConstMorph_() const {
+        if constexpr (internal_impl::IsDefaultMorph<Morph>)
+            return {};
+        else
+            return morph_;
+    }
+
+    //* a row or a column starting at start: contiguous when it is a line of the layout, every stride elements otherwise
+    template <bool Contiguous, typename U>
+    constexpr auto Line_(U* start, std::size_t stride, std::size_t size) const {
+        if constexpr (!Contiguous)
+            return Column<U, Morph>{start, stride, size, morph_};
+        else if constexpr (internal_impl::IsDefaultMorph<Morph>)
+            return std::span<U>(start, size);
+        else
+            return std::span<U>(start, size) | std::views::transform(morph_);
+    }
+
+    template <typename U>
+    constexpr auto RowIterator_(U* start) const {
+        if constexpr (internal_impl::IsRowMajor<Layout>)
+            return MatrixIterator<U, Morph>{start, cols_count_, real_col_count_, morph_};
+        else
+            return StridedRowIterator<U, Morph>{start, real_col_count_, cols_count_, morph_};
+    }
+
+    //* where the row after the last one would start
+    constexpr T* EndStart_() const {
+        if constexpr (internal_impl::IsRowMajor<Layout>)
+            return data_start_ + rows_count_ * real_col_count_;
+        else
+            return data_start_ + rows_count_;
+    }
+
+    constexpr const T& RealAt(std::size_t r, std::size_t c) const { return data_start_[Layout::Offset(r, c, real_col_count_)]; }
+    constexpr T& RealAt(std::size_t r, std::size_t c) { return data_start_[Layout::Offset(r, c, real_col_count_)]; }
 
 private:
     T* data_start_;
     std::size_t rows_count_;
     std::size_t cols_count_;
     std::size_t real_col_count_;
-    Morph morph_;
+    [[no_unique_address]] Morph morph_;
 
 private:
-    template <typename U> friend class Matrix;
-    template <typename U, typename M> friend class MatrixView;
+    template <typename U, typename A, typename L> friend class Matrix;
+    template <typename U, typename M, typename L> friend class MatrixView;
+    template <typename U, std::size_t R, std::size_t C> friend class FixedMatrix;
 };
 
 //! ***
@@ -571,98 +1001,253 @@ private:
 //! Operators
 //! ***
 
+//* +, - and * by a value are lazy: they return a BinaryExpression (see expression.hpp)
+//* which is computed in one pass when assigned to a Matrix/MatrixView, or on Eval().
+//* Arguments go in any order and can be a Matrix, a MatrixView, another expression or a value.
+
 //*
 //* Addition
-template <typename T, typename W, typename MorphOne, typename MorphTwo, typename R = std::common_type_t<T, W>>
-constexpr Matrix<R> operator+(const MatrixView<T, MorphOne>& lhs, const MatrixView<W, MorphTwo>& rhs);
-
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator+(const Matrix<T>& lhs, const Matrix<W>& rhs) { return lhs.View() + rhs.View(); }
+template <typename T, typename W>
+requires (internal_impl::MatrixLike<T> || internal_impl::MatrixLike<W>) && (!internal_impl::StaticOperands<T, W>)
+      && Addable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+inline constexpr auto operator+(T&& lhs, W&& rhs) {
+    return internal_impl::MakeExpression<std::plus<>>(std::forward<T>(lhs), std::forward<W>(rhs));
+}
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator+(const Matrix<T>& lhs, const MatrixView<W, Morph>& rhs) { return lhs.View() + rhs; }
+//*
+//* Subtraction
+//* 5 - matrix treats 5 as a matrix where all elements are 5
+template <typename T, typename W>
+requires (internal_impl::MatrixLike<T> || internal_impl::MatrixLike<W>) && (!internal_impl::StaticOperands<T, W>)
+      && Addable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+inline constexpr auto operator-(T&& lhs, W&& rhs) {
+    return internal_impl::MakeExpression<std::minus<>>(std::forward<T>(lhs), std::forward<W>(rhs));
+}
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator+(const MatrixView<T, Morph>& lhs, const Matrix<W>& rhs) { return rhs + lhs; }
+//*
+//* Multiplication
+//* matrix * matrix is computed right away, see gemm.hpp
+template <typename T, typename W, typename R = std::common_type_t<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>>
+requires internal_impl::MatrixLike<T> && internal_impl::MatrixLike<W> && (!internal_impl::StaticOperands<T, W>)
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+constexpr Matrix<R> operator*(const T& lhs, const W& rhs);
+
+//* matrix * matrix on a given pool instead of ThreadPool::Default()
+template <typename T, typename W, typename R = std::common_type_t<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>>
+requires internal_impl::MatrixLike<T> && internal_impl::MatrixLike<W>
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+constexpr Matrix<R> Multiply(const T& lhs, const W& rhs, ThreadPool& pool);
+
+//* matrix * matrix with Strassen-Winograd (strassen.hpp): sub-cubic, slightly less accurate.
+//* operator* takes this path by itself for floating point types above StrassenThresholds::automatic
+template <typename T, typename W, typename R = std::common_type_t<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>>
+requires internal_impl::MatrixLike<T> && internal_impl::MatrixLike<W>
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+Matrix<R> MultiplyStrassen(const T& lhs, const W& rhs, ThreadPool& pool, std::size_t cutoff = StrassenThresholds::cutoff);
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-constexpr Matrix<R> operator+(const MatrixView<T, Morph>& lhs, const W& val);
+template <typename T, typename W>
+requires internal_impl::MatrixLike<T> && internal_impl::MatrixLike<W>
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+inline auto MultiplyStrassen(const T& lhs, const W& rhs) { return MultiplyStrassen(lhs, rhs, ThreadPool::Default()); }
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator+(const W& val, const MatrixView<T, Morph>& rhs) { return rhs + val; }
+template <typename T, typename W>
+requires (internal_impl::MatrixLike<T> != internal_impl::MatrixLike<W>) && (!internal_impl::StaticOperands<T, W>)
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+inline constexpr auto operator*(T&& lhs, W&& rhs) {
+    return internal_impl::MakeExpression<std::multiplies<>>(std::forward<T>(lhs), std::forward<W>(rhs));
+}
 
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator+(const Matrix<T>& lhs, const W& val) { return lhs.View() + val; }
+//*
+//* Matrix-vector product (GEMV), y = A x or y = A^T x
+//* x is any contiguous range (std::span, std::vector, std::array...), y comes back as a std::vector
+template <internal_impl::MatrixLike A, std::ranges::contiguous_range V,
+          typename R = std::common_type_t<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>>
+requires std::ranges::sized_range<V> && Multipliable<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>
+std::vector<R> Multiply(const A& a, const V& x, ThreadPool& pool);
+
+template <internal_impl::MatrixLike A, std::ranges::contiguous_range V>
+requires std::ranges::sized_range<V> && Multipliable<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>
+inline auto Multiply(const A& a, const V& x) { return Multiply(a, x, ThreadPool::Default()); }
+
+template <internal_impl::MatrixLike A, std::ranges::contiguous_range V,
+          typename R = std::common_type_t<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>>
+requires std::ranges::sized_range<V> && Multipliable<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>
+std::vector<R> MultiplyTransposed(const A& a, const V& x, ThreadPool& pool);
+
+template <internal_impl::MatrixLike A, std::ranges::contiguous_range V>
+requires std::ranges::sized_range<V> && Multipliable<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>
+inline auto MultiplyTransposed(const A& a, const V& x) { return MultiplyTransposed(a, x, ThreadPool::Default()); }
 
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator+(const W& val, const Matrix<T>& rhs) { return rhs.View() + val; }
+//*
+//* Destination passing: the result is written into an existing matrix or plain view of the right size,
+//* nothing is allocated, so a loop over reused buffers runs allocation-free (GEMM packing buffers included).
+//* out may be an operand of Add and Scale, even transposed or as a shifted sub-view (those go through a temporary);
+//* it must not overlap the operands of Multiply.
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires (!std::is_const_v<T>) && Addable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+void Add(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const B& b, ThreadPool& pool);
+
+template <typename T, typename L, internal_impl::MatrixLike A, typename S>
+requires (!std::is_const_v<T>) && (!internal_impl::MatrixLike<S>) && Multipliable<internal_impl::ValueOf<A>, S>
+void Scale(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const S& s, ThreadPool& pool);
+
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires (!std::is_const_v<T>) && Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+void Multiply(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const B& b, ThreadPool& pool);
+
+template <typename T, typename L>
+requires (!std::is_const_v<T>)
+void Fill(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const std::type_identity_t<T>& value, ThreadPool& pool);
+
+//* out = a converted to the element type of out: a morphed view or an expression is materialized into out,
+//* plain views of the same layout are copied line by line. a must not overlap out unless it is out itself.
+template <typename T, typename L, internal_impl::MatrixLike A>
+requires (!std::is_const_v<T>) && std::convertible_to<internal_impl::ValueOf<A>, T>
+void Copy(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, ThreadPool& pool);
+
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires (!std::is_const_v<T>) && Addable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+inline void Add(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const B& b) { Add(out, a, b, ThreadPool::Default()); }
+
+template <typename T, typename L, internal_impl::MatrixLike A, typename S>
+requires (!std::is_const_v<T>) && (!internal_impl::MatrixLike<S>) && Multipliable<internal_impl::ValueOf<A>, S>
+inline void Scale(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const S& s) { Scale(out, a, s, ThreadPool::Default()); }
+
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires (!std::is_const_v<T>) && Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+inline void Multiply(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const B& b) { Multiply(out, a, b, ThreadPool::Default()); }
+
+template <typename T, typename L>
+requires (!std::is_const_v<T>)
+inline void Fill(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const std::type_identity_t<T>& value) { Fill(out, value, ThreadPool::Default()); }
+
+template <typename T, typename L, internal_impl::MatrixLike A>
+requires (!std::is_const_v<T>) && std::convertible_to<internal_impl::ValueOf<A>, T>
+inline void Copy(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a) { Copy(out, a, ThreadPool::Default()); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires Addable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+inline void Add(Matrix<T, Alloc, L>& out, const A& a, const B& b, ThreadPool& pool) { Add(out.View(), a, b, pool); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, typename S>
+requires (!internal_impl::MatrixLike<S>) && Multipliable<internal_impl::ValueOf<A>, S>
+inline void Scale(Matrix<T, Alloc, L>& out, const A& a, const S& s, ThreadPool& pool) { Scale(out.View(), a, s, pool); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+inline void Multiply(Matrix<T, Alloc, L>& out, const A& a, const B& b, ThreadPool& pool) { Multiply(out.View(), a, b, pool); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires Addable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+inline void Add(Matrix<T, Alloc, L>& out, const A& a, const B& b) { Add(out.View(), a, b, ThreadPool::Default()); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, typename S>
+requires (!internal_impl::MatrixLike<S>) && Multipliable<internal_impl::ValueOf<A>, S>
+inline void Scale(Matrix<T, Alloc, L>& out, const A& a, const S& s) { Scale(out.View(), a, s, ThreadPool::Default()); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+inline void Multiply(Matrix<T, Alloc, L>& out, const A& a, const B& b) { Multiply(out.View(), a, b, ThreadPool::Default()); }
+
+template <typename T, typename Alloc, typename L>
+inline void Fill(Matrix<T, Alloc, L>& out, const std::type_identity_t<T>& value, ThreadPool& pool) { Fill(out.View(), value, pool); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A>
+requires std::convertible_to<internal_impl::ValueOf<A>, T>
+inline void Copy(Matrix<T, Alloc, L>& out, const A& a, ThreadPool& pool) { Copy(out.View(), a, pool); }
+
+template <typename T, typename Alloc, typename L>
+inline void Fill(Matrix<T, Alloc, L>& out, const std::type_identity_t<T>& value) { Fill(out.View(), value, ThreadPool::Default()); }
+
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A>
+requires std::convertible_to<internal_impl::ValueOf<A>, T>
+inline void Copy(Matrix<T, Alloc, L>& out, const A& a) { Copy(out.View(), a, ThreadPool::Default()); }
 
 //*
-//* Subtraction
-template <typename T, typename W, typename MorphOne, typename MorphTwo, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const MatrixView<T, MorphOne>& lhs, const MatrixView<W, MorphTwo>& rhs) {
-    return lhs + rhs.View([](const T& val) { return -val; });
-    // just for fun, if instead of +, you use - the compiler will go on forever
-    // compile time recursion, very cool
-    // "for your next interview question, take a look at..."
-}
+//* With an execution policy first, like the standard algorithms: rage::seq on the calling thread, rage::par
+//* in row blocks on the default pool (see thread_pool.hpp, std::execution policies with execution.hpp)
+template <internal_impl::ExecutionPolicy P, typename Out, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+inline void Add(const P& policy, Out&& out, const A& a, const B& b) { Add(std::forward<Out>(out), a, b, internal_impl::PoolOf(policy)); }
 
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const Matrix<T>& lhs, const Matrix<W>& rhs) { return lhs.View() - rhs.View(); }
+template <internal_impl::ExecutionPolicy P, typename Out, internal_impl::MatrixLike A, typename S>
+requires (!internal_impl::MatrixLike<S>)
+inline void Scale(const P& policy, Out&& out, const A& a, const S& s) { Scale(std::forward<Out>(out), a, s, internal_impl::PoolOf(policy)); }
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const Matrix<T>& lhs, const MatrixView<W, Morph>& rhs) { return lhs.View() - rhs; }
+template <internal_impl::ExecutionPolicy P, typename Out, typename V>
+requires (!internal_impl::MatrixLike<V>)
+inline void Fill(const P& policy, Out&& out, const V& value) { Fill(std::forward<Out>(out), value, internal_impl::PoolOf(policy)); }
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const MatrixView<T, Morph>& lhs, const Matrix<W>& rhs) { return rhs - lhs; }
+template <internal_impl::ExecutionPolicy P, typename Out, internal_impl::MatrixLike A>
+inline void Copy(const P& policy, Out&& out, const A& a) { Copy(std::forward<Out>(out), a, internal_impl::PoolOf(policy)); }
+
+//*
+//* Fused GEMM, BLAS style: C = epilogue(alpha A B + beta C + bias) in one pass over C.
+//* The bias and the epilogue (any morph) are applied by the micro kernel right after it stores each tile
+//* of C, still in L1, where activation(A * B + bias) would otherwise take a product, a sum and a morph view.
+//* beta == 0 does not read C. C must not overlap A or B.
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const MatrixView<T, Morph>& lhs, const W& val) { return lhs + (-val); }
+//* added before the epilogue: row[r] to every element of row r of C, col[c] to every element of column c.
+//* Empty spans add nothing, others have one value per row (column) of C.
+template <typename T>
+struct GemmBias {
+    std::span<const T> row{};
+    std::span<const T> col{};
+};
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const W& val, const MatrixView<T, Morph>& rhs) {
-    return rhs.View([](const T& t) { return -t; }) + val;
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B,
+          typename Epilogue = internal_impl::DefaultMorph<T>>
+requires (!std::is_const_v<T>) && Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+      && internal_impl::MorphConcept<Epilogue, T>
+void Gemm(std::type_identity_t<T> alpha, const A& a, const B& b, std::type_identity_t<T> beta,
+          MatrixView<T, internal_impl::DefaultMorph<T>, L> c, GemmBias<T> bias, Epilogue epilogue, ThreadPool& pool);
+
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B,
+          typename Epilogue = internal_impl::DefaultMorph<T>>
+requires (!std::is_const_v<T>) && Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+      && internal_impl::MorphConcept<Epilogue, T>
+inline void Gemm(std::type_identity_t<T> alpha, const A& a, const B& b, std::type_identity_t<T> beta,
+                 MatrixView<T, internal_impl::DefaultMorph<T>, L> c, GemmBias<T> bias = {}, Epilogue epilogue = {}) {
+    Gemm(alpha, a, b, beta, c, bias, std::move(epilogue), ThreadPool::Default());
 }
 
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const Matrix<T>& lhs, const W& val) { return lhs.View() - val; }
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B,
+          typename Epilogue = internal_impl::DefaultMorph<T>>
+requires Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>> && internal_impl::MorphConcept<Epilogue, T>
+inline void Gemm(std::type_identity_t<T> alpha, const A& a, const B& b, std::type_identity_t<T> beta,
+                 Matrix<T, Alloc, L>& c, GemmBias<T> bias, Epilogue epilogue, ThreadPool& pool) {
+    Gemm(alpha, a, b, beta, c.View(), bias, std::move(epilogue), pool);
+}
 
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-inline constexpr Matrix<R> operator-(const W& val, const Matrix<T>& rhs) { return val - rhs.View(); }
+template <typename T, typename Alloc, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B,
+          typename Epilogue = internal_impl::DefaultMorph<T>>
+requires Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>> && internal_impl::MorphConcept<Epilogue, T>
+inline void Gemm(std::type_identity_t<T> alpha, const A& a, const B& b, std::type_identity_t<T> beta,
+                 Matrix<T, Alloc, L>& c, GemmBias<T> bias = {}, Epilogue epilogue = {}) {
+    Gemm(alpha, a, b, beta, c.View(), bias, std::move(epilogue), ThreadPool::Default());
+}
 
 //*
-//* Multiplication
-template <typename T, typename W, typename MorphOne, typename MorphTwo, typename R = std::common_type_t<T, W>>
-requires Multipliable<T, W>
-constexpr Matrix<R> operator*(const MatrixView<T, MorphOne>& lhs, const MatrixView<W, MorphTwo>& rhs);
+//* Transposition
+//* A new row-major matrix holding the transpose, unlike Transposed() which is a view of the same data
+template <typename T, typename M, typename L, typename R = internal_impl::ValueOf<MatrixView<T, M, L>>>
+Matrix<R> Transpose(const MatrixView<T, M, L>& view, ThreadPool& pool);
 
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-requires Multipliable<T, W>
-inline constexpr Matrix<R> operator*(const Matrix<T>& lhs, const Matrix<W>& rhs) { return lhs.View() * rhs.View(); }
+template <typename T, typename M, typename L>
+inline auto Transpose(const MatrixView<T, M, L>& view) { return Transpose(view, ThreadPool::Default()); }
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-requires Multipliable<T, W>
-inline constexpr Matrix<R> operator*(const Matrix<T>& lhs, const MatrixView<W, Morph>& rhs) { return lhs.View() * rhs; }
+template <typename T, typename A, typename L>
+inline Matrix<T> Transpose(const Matrix<T, A, L>& m, ThreadPool& pool) { return Transpose(m.View(), pool); }
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
-requires Multipliable<T, W>
-inline constexpr Matrix<R> operator*(const MatrixView<T, Morph>& lhs, const Matrix<W>& rhs) { return lhs * rhs.View(); }
+template <typename T, typename A, typename L>
+inline Matrix<T> Transpose(const Matrix<T, A, L>& m) { return Transpose(m.View(), ThreadPool::Default()); }
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
+template <typename T, typename W, typename MorphOne, typename MorphTwo, typename L1, typename L2, typename R = std::common_type_t<T, W>>
 requires Multipliable<T, W>
-constexpr Matrix<R> operator*(const MatrixView<T, Morph>& lhs, const W& val);
+constexpr Matrix<R> MultiplyReference(const MatrixView<T, MorphOne, L1>& lhs, const MatrixView<W, MorphTwo, L2>& rhs);
 
-template <typename T, typename W, typename Morph, typename R = std::common_type_t<T, W>>
+template <typename T, typename W, typename A1, typename A2, typename L1, typename L2, typename R = std::common_type_t<T, W>>
 requires Multipliable<T, W>
-inline constexpr Matrix<R> operator*(const W& val, const MatrixView<T, Morph>& rhs) { return rhs * val; }
-
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-requires Multipliable<T, W>
-inline constexpr Matrix<R> operator*(const Matrix<T>& lhs, const W& val) { return lhs.View() * val; }
-
-template <typename T, typename W, typename R = std::common_type_t<T, W>>
-requires Multipliable<T, W>
-inline constexpr Matrix<R> operator*(const W& val, const Matrix<T>& rhs) { return rhs.View() * val; }
+inline constexpr Matrix<R> MultiplyReference(const Matrix<T, A1, L1>& lhs, const Matrix<W, A2, L2>& rhs) { return MultiplyReference(lhs.View(), rhs.View()); }
 
 
 //! ***
@@ -670,8 +1255,11 @@ inline constexpr Matrix<R> operator*(const W& val, const Matrix<T>& rhs) { retur
 //! Utils Implementation
 //! ***
 
-template <typename T, typename W, typename M, typename R = std::common_type_t<T, W>>
-constexpr R DotProduct(const std::span<T>& v1, const Column<W, M>& v2)
+//* a row and a column of the same length, each either a span (or a transform of it) or a strided Column
+template <typename V1, typename V2,
+          typename R = std::common_type_t<std::remove_cvref_t<decltype(std::declval<const V1&>()[0])>,
+                                          std::remove_cvref_t<decltype(std::declval<const V2&>()[0])>>>
+constexpr R DotProduct(const V1& v1, const V2& v2)
 {
     const auto len{v1.size()};
     R total{};
@@ -680,12 +1268,6 @@ constexpr R DotProduct(const std::span<T>& v1, const Column<W, M>& v2)
     return total;
 }
 
-template <typename T, typename W, typename M, typename R = std::common_type_t<T, W>>
-constexpr R DotProduct(const Column<W, M>& v1, const std::span<T>& v2)
-{
-    return DotProduct(v2, v1);
-}
-
 
 //! ***
 //! ***
@@ -693,108 +1275,415 @@ constexpr R DotProduct(const Column<W, M>& v1, const std::span<T>& v2)
 //! ***
 
 
-template <typename T, typename Morph>
+template <typename T, typename Morph, typename Layout>
 template <typename W>
 requires Addable<T, W> && std::convertible_to<W, T>
-constexpr MatrixView<T, Morph>& MatrixView<T, Morph>::Add(const W& val)
+constexpr MatrixView<T, Morph, Layout>& MatrixView<T, Morph, Layout>::Add(const W& val)
 {
-    for (auto& row : *this) {
-        for (auto& elem : row)
-            elem += val;
+    const auto lines{Layout::LinesCount(rows_count_, cols_count_)};
+    const auto length{Layout::LineLength(rows_count_, cols_count_)};
+
+    // the kernel adds in T: only when that is the type elem += val adds in (not int += 0.5)
+    if constexpr (internal_impl::RawOperand<T, T, Morph> && std::is_same_v<std::common_type_t<T, W>, T>) {
+        if !consteval {
+            internal_impl::ForEachRowBlock(ThreadPool::Default(), lines, length, [&](std::size_t first, std::size_t last) {
+                T* lines_start{data_start_ + first * real_col_count_};
+                internal_impl::simd::AddValue(lines_start, real_col_count_, static_cast<T>(val),
+                                              lines_start, real_col_count_, last - first, length);
+            });
+            return *this;
+        }
+    }
+
+    for (std::size_t line{0}; line < lines; ++line) {
+        for (std::size_t i{0}; i < length; ++i) {
+            auto& elem{internal_impl::IsRowMajor<Layout> ? At(line, i) : At(i, line)};
+            elem = static_cast<T>(elem + val);
+        }
     }
     
     return *this;
 }
 
-template <typename T, typename Morph>
-template <typename W, typename M>
+//* walks this view in memory order, rhs may be stored the other way around (e.g a transposed view)
+template <typename T, typename Morph, typename Layout>
+template <typename W, typename M, typename L>
 requires Addable<T, W> && std::convertible_to<W, T>
-constexpr MatrixView<T, Morph>& MatrixView<T, Morph>::Add(const MatrixView<W, M>& rhs)
+constexpr MatrixView<T, Morph, Layout>& MatrixView<T, Morph, Layout>::Add(const MatrixView<W, M, L>& rhs)
 {
-    for (auto [idx, row] : *this | std::ranges::views::enumerate) {
-        auto rhs_row{rhs[idx]};
-        for (std::size_t i{0}; i < cols_count_; ++i)
-            row[i] += rhs_row[i];
+    assert(rhs.RowsCount() == rows_count_ && rhs.ColsCount() == cols_count_ && "Dimensions must match");
+
+    const auto lines{Layout::LinesCount(rows_count_, cols_count_)};
+    const auto length{Layout::LineLength(rows_count_, cols_count_)};
+
+    if constexpr (internal_impl::RawOperand<T, T, Morph> && internal_impl::RawOperand<T, W, M> && std::is_same_v<L, Layout>) {
+        if !consteval {
+            internal_impl::ForEachRowBlock(ThreadPool::Default(), lines, length, [&](std::size_t first, std::size_t last) {
+                T* lines_start{data_start_ + first * real_col_count_};
+                internal_impl::simd::Add<T>(lines_start, real_col_count_, rhs.data_start_ + first * rhs.real_col_count_, rhs.real_col_count_,
+                                            lines_start, real_col_count_, last - first, length);
+            });
+            return *this;
+        }
+    }
+
+    for (std::size_t line{0}; line < lines; ++line) {
+        for (std::size_t i{0}; i < length; ++i) {
+            if constexpr (internal_impl::IsRowMajor<Layout>)
+                At(line, i) += rhs.At(line, i);
+            else
+                At(i, line) += rhs.At(i, line);
+        }
     }
 
     return *this;
 }
 
+} // namespace rage
+
+namespace internal_impl {
+    //* A raw view (Matrix, FixedMatrix and plain views included) goes to the engine as a StridedAccessor,
+    //* so packing reads its contiguous axis; morphed views and expressions go element by element.
+    template <typename R, typename Operand>
+    constexpr auto GemmAccessor(const Operand& operand) {
+        if constexpr (IsRawView<R, Operand>::value) {
+            const auto ld{operand.LeadingDimension()};
+            if constexpr (IsRowMajor<typename LayoutOf_<Operand>::type>)
+                return StridedAccessor<R>{operand.RawData(), ld, 1};
+            else
+                return StridedAccessor<R>{operand.RawData(), 1, ld};
+        } else {
+            return [&operand](std::size_t r, std::size_t c) { return operand.At(r, c); };
+        }
+    }
+
+    //* C = A B with Strassen when both operands are row-major memory, false (and C untouched) otherwise
+    template <typename R, typename GetA, typename GetB>
+    bool TryStrassen(const GetA& get_a, const GetB& get_b, std::size_t m, std::size_t k, std::size_t n,
+                     R* c, std::size_t ldc, rage::ThreadPool& pool, std::size_t cutoff) {
+        if constexpr (IsStridedAccessor<GetA>::value && IsStridedAccessor<GetB>::value) {
+            if (get_a.col_stride == 1 && get_b.col_stride == 1) {
+                Strassen<R>(m, k, n, get_a.data, get_a.row_stride, get_b.data, get_b.row_stride, c, ldc, pool, cutoff);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //* a row-major copy of any operand, for the kernels that need plain memory
+    template <typename R, typename Operand>
+    rage::Matrix<R> RowMajorCopy(const Operand& operand) {
+        rage::Matrix<R> copy(operand.RowsCount(), operand.ColsCount());
+        for (std::size_t r{0}; r < copy.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < copy.ColsCount(); ++c)
+                copy.At(r, c) = static_cast<R>(operand.At(r, c));
+        }
+        return copy;
+    }
+
+    //* y = a x: raw views of the result type go through the vector kernels (gemv.hpp), anything else element by element
+    template <typename Operand, typename X, typename R>
+    void Gemv(const Operand& a, const X* x, R* y, rage::ThreadPool& pool) {
+        if constexpr (IsRawView<R, Operand>::value && std::is_same_v<X, R>) {
+            if constexpr (IsRowMajor<typename LayoutOf_<Operand>::type>)
+                GemvRows(a.RawData(), a.LeadingDimension(), x, y, a.RowsCount(), a.ColsCount(), pool);
+            else
+                GemvCols(a.RawData(), a.LeadingDimension(), x, y, a.RowsCount(), a.ColsCount(), pool);
+        } else {
+            ForEachRowBlock(pool, a.RowsCount(), a.ColsCount(), [&](std::size_t first, std::size_t last) {
+                for (std::size_t r{first}; r < last; ++r) {
+                    R total{};
+                    for (std::size_t c{0}; c < a.ColsCount(); ++c)
+                        total += static_cast<R>(a.At(r, c)) * static_cast<R>(x[c]);
+                    y[r] = total;
+                }
+            });
+        }
+    }
+
+    //* an expression read across its diagonal, views have Transposed() instead
+    template <typename Operand>
+    struct TransposedOperand {
+        Operand operand;
+
+        constexpr std::size_t RowsCount() const { return operand.ColsCount(); }
+        constexpr std::size_t ColsCount() const { return operand.RowsCount(); }
+        constexpr decltype(auto) At(std::size_t r, std::size_t c) const { return operand.At(c, r); }
+    };
+
+    template <typename Operand>
+    constexpr auto TransposedOf(const Operand& operand) {
+        if constexpr (IsMatrixView<Operand>::value)
+            return operand.Transposed();
+        else
+            return TransposedOperand<Operand>{operand};
+    }
+
+    //* C (row-major, leading dimension ldc) = lhs rhs, Strassen for floating point above StrassenThresholds::automatic
+    template <typename R, typename LhsOperand, typename RhsOperand>
+    constexpr void MultiplyInto(const LhsOperand& lhs, const RhsOperand& rhs, R* c, std::size_t ldc, rage::ThreadPool& pool) {
+        const auto m{lhs.RowsCount()};
+        const auto k{lhs.ColsCount()};
+        const auto n{rhs.ColsCount()};
+        const auto get_lhs{GemmAccessor<R>(lhs)};
+        const auto get_rhs{GemmAccessor<R>(rhs)};
+
+        if consteval {
+            Gemm<R>(m, n, k, get_lhs, get_rhs, c, ldc);
+        } else {
+            const bool strassen{std::is_floating_point_v<R> && std::min({m, n, k}) >= rage::StrassenThresholds::automatic
+                                && TryStrassen<R>(get_lhs, get_rhs, m, k, n, c, ldc, pool, rage::StrassenThresholds::cutoff)};
+            if (!strassen)
+                ParallelGemm<R>(pool, m, n, k, get_lhs, get_rhs, c, ldc);
+        }
+    }
+
+    //* whether the element ranges of a raw view and of an operand meet, false when the operand is not a raw view
+    template <typename T, typename L, typename Operand>
+    bool SharesMemory(const rage::MatrixView<T, DefaultMorph<T>, L>& out, const Operand& operand) {
+        if constexpr (IsMatrixView<Operand>::value) {
+            if (out.Size() == 0 || operand.Size() == 0)
+                return false;
+            const auto span{[](const auto& view) {
+                using Layout = typename LayoutOf_<std::remove_cvref_t<decltype(view)>>::type;
+                const auto lines{Layout::LinesCount(view.RowsCount(), view.ColsCount())};
+                const auto length{Layout::LineLength(view.RowsCount(), view.ColsCount())};
+                const auto first{reinterpret_cast<std::uintptr_t>(view.RawData())};
+                return std::array{first, first + ((lines - 1) * view.LeadingDimension() + length) * sizeof(*view.RawData())};
+            }};
+            const auto [out_first, out_last]{span(out)};
+            const auto [first, last]{span(operand)};
+            return first < out_last && out_first < last;
+        } else {
+            return false;
+        }
+    }
+} // namespace internal_impl
+
+namespace rage {
+
 //! ***
 //! ***
 //! Operators Implementation
 //! ***
 
 //*
-//* Addition
-template<typename T, typename W, typename MorphOne, typename MorphTwo, typename R>
-constexpr Matrix<R> operator+(const MatrixView<T, MorphOne>& lhs, const MatrixView<W, MorphTwo>& rhs)
+//* Multiplication
+
+template <typename T, typename W, typename R>
+requires internal_impl::MatrixLike<T> && internal_impl::MatrixLike<W> && (!internal_impl::StaticOperands<T, W>)
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+constexpr Matrix<R> operator*(const T& lhs, const W& rhs)
 {
-    const auto rows_count{lhs.RowsCount()};
-    const auto cols_count{lhs.ColsCount()};
-    
-    Matrix<R> result(rows_count, cols_count);
-    
-    for (std::size_t r{0}; r < rows_count; ++r) {
-        for (std::size_t c{0}; c < cols_count; ++c)
-            result[r][c] = lhs[r][c] + rhs[r][c];
-    }
-    
+    return Multiply(lhs, rhs, ThreadPool::Default());
+}
+
+template <typename T, typename W, typename R>
+requires internal_impl::MatrixLike<T> && internal_impl::MatrixLike<W>
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+constexpr Matrix<R> Multiply(const T& lhs, const W& rhs, ThreadPool& pool)
+{
+    assert(lhs.ColsCount() == rhs.RowsCount() && "Inner dimensions must match");
+
+    Matrix<R> result(lhs.RowsCount(), rhs.ColsCount());
+    //* expressions are evaluated while packing, no temporary is created for them
+    internal_impl::MultiplyInto<R>(internal_impl::ToOperand(lhs), internal_impl::ToOperand(rhs),
+                                   result.RawData(), result.LeadingDimension(), pool);
     return result;
 }
 
-template <typename T, typename W, typename Morph, typename R>
-constexpr Matrix<R> operator+(const MatrixView<T, Morph>& lhs, const W& val)
+template <typename T, typename W, typename R>
+requires internal_impl::MatrixLike<T> && internal_impl::MatrixLike<W>
+      && Multipliable<internal_impl::ValueOf<T>, internal_impl::ValueOf<W>>
+Matrix<R> MultiplyStrassen(const T& lhs, const W& rhs, ThreadPool& pool, std::size_t cutoff)
 {
-    const auto rows_count{lhs.RowsCount()};
-    const auto cols_count{lhs.ColsCount()};
-    
-    Matrix<R> result(rows_count, cols_count);
-    
-    for (std::size_t r{0}; r < rows_count; ++r) {
-        for (std::size_t c{0}; c < cols_count; ++c)
-            result[r][c] = lhs[r][c] + val;
+    assert(lhs.ColsCount() == rhs.RowsCount() && "Inner dimensions must match");
+
+    const auto lhs_operand{internal_impl::ToOperand(lhs)};
+    const auto rhs_operand{internal_impl::ToOperand(rhs)};
+    const auto get_lhs{internal_impl::GemmAccessor<R>(lhs_operand)};
+    const auto get_rhs{internal_impl::GemmAccessor<R>(rhs_operand)};
+
+    Matrix<R> result(lhs.RowsCount(), rhs.ColsCount());
+    if (!internal_impl::TryStrassen<R>(get_lhs, get_rhs, lhs.RowsCount(), lhs.ColsCount(), rhs.ColsCount(),
+                                       result.RawData(), result.LeadingDimension(), pool, cutoff)) {
+        // morphed, column-major or lazy operands: O(n^2) copies next to the O(n^2.81) product
+        const auto lhs_copy{internal_impl::RowMajorCopy<R>(lhs_operand)};
+        const auto rhs_copy{internal_impl::RowMajorCopy<R>(rhs_operand)};
+        internal_impl::Strassen<R>(lhs.RowsCount(), lhs.ColsCount(), rhs.ColsCount(),
+                                   lhs_copy.RawData(), lhs_copy.LeadingDimension(),
+                                   rhs_copy.RawData(), rhs_copy.LeadingDimension(),
+                                   result.RawData(), result.LeadingDimension(), pool, cutoff);
     }
-    
     return result;
 }
 
 //*
-//* Multiplication
+//* Matrix-vector product
 
-template <typename T, typename W, typename MorphOne, typename MorphTwo, typename R>
-requires Multipliable<T, W>
-constexpr Matrix<R> operator*(const MatrixView<T, MorphOne>& lhs, const MatrixView<W, MorphTwo>& rhs)
+template <internal_impl::MatrixLike A, std::ranges::contiguous_range V, typename R>
+requires std::ranges::sized_range<V> && Multipliable<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>
+std::vector<R> Multiply(const A& a, const V& x, ThreadPool& pool)
 {
-    const auto rows_count{lhs.RowsCount()};
-    const auto cols_count{rhs.ColsCount()};
-    
-    Matrix<R> result(rows_count, cols_count);
+    assert(std::ranges::size(x) == a.ColsCount() && "x must have ColsCount() elements");
 
-    for (std::size_t rhs_col_i{0}; rhs_col_i < cols_count; ++rhs_col_i) {
-        const auto rhs_col{rhs.Col(rhs_col_i)};
-        for (const auto& [lhs_row_i, lhs_row] : lhs | std::ranges::views::enumerate) {
-            result[lhs_row_i][rhs_col_i] = DotProduct(lhs_row, rhs_col);
-        }
+    std::vector<R> y(a.RowsCount());
+    internal_impl::Gemv(internal_impl::ToOperand(a), std::ranges::data(x), y.data(), pool);
+    return y;
+}
+
+template <internal_impl::MatrixLike A, std::ranges::contiguous_range V, typename R>
+requires std::ranges::sized_range<V> && Multipliable<internal_impl::ValueOf<A>, std::ranges::range_value_t<V>>
+std::vector<R> MultiplyTransposed(const A& a, const V& x, ThreadPool& pool)
+{
+    assert(std::ranges::size(x) == a.RowsCount() && "x must have RowsCount() elements");
+
+    std::vector<R> y(a.ColsCount());
+    internal_impl::Gemv(internal_impl::TransposedOf(internal_impl::ToOperand(a)), std::ranges::data(x), y.data(), pool);
+    return y;
+}
+
+//*
+//* Destination passing
+
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires (!std::is_const_v<T>) && Addable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+void Add(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const B& b, ThreadPool& pool)
+{
+    assert(a.RowsCount() == b.RowsCount() && a.ColsCount() == b.ColsCount() && "Matrices must have the same dimensions");
+    assert(out.RowsCount() == a.RowsCount() && out.ColsCount() == a.ColsCount() && "out must have the dimensions of the result");
+
+    internal_impl::EvaluateAliased<L>(internal_impl::MakeExpression<std::plus<>>(a, b), out.RawData(), out.LeadingDimension(), pool);
+}
+
+template <typename T, typename L, internal_impl::MatrixLike A, typename S>
+requires (!std::is_const_v<T>) && (!internal_impl::MatrixLike<S>) && Multipliable<internal_impl::ValueOf<A>, S>
+void Scale(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const S& s, ThreadPool& pool)
+{
+    assert(out.RowsCount() == a.RowsCount() && out.ColsCount() == a.ColsCount() && "out must have the dimensions of the result");
+
+    internal_impl::EvaluateAliased<L>(internal_impl::MakeExpression<std::multiplies<>>(a, s), out.RawData(), out.LeadingDimension(), pool);
+}
+
+template <typename T, typename L>
+requires (!std::is_const_v<T>)
+void Fill(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const std::type_identity_t<T>& value, ThreadPool& pool)
+{
+    const auto lines{L::LinesCount(out.RowsCount(), out.ColsCount())};
+    const auto length{L::LineLength(out.RowsCount(), out.ColsCount())};
+    internal_impl::ForEachRowBlock(pool, lines, length, [&](std::size_t first, std::size_t last) {
+        for (std::size_t line{first}; line < last; ++line)
+            std::fill_n(out.RawData() + line * out.LeadingDimension(), length, value);
+    });
+}
+
+template <typename T, typename L, internal_impl::MatrixLike A>
+requires (!std::is_const_v<T>) && std::convertible_to<internal_impl::ValueOf<A>, T>
+void Copy(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, ThreadPool& pool)
+{
+    assert(out.RowsCount() == a.RowsCount() && out.ColsCount() == a.ColsCount() && "out must have the dimensions of the copied matrix");
+
+    internal_impl::Evaluate<L>(internal_impl::ToOperand(a), out.RawData(), out.LeadingDimension(), pool);
+}
+
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B>
+requires (!std::is_const_v<T>) && Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+void Multiply(MatrixView<T, internal_impl::DefaultMorph<T>, L> out, const A& a, const B& b, ThreadPool& pool)
+{
+    assert(a.ColsCount() == b.RowsCount() && "Inner dimensions must match");
+    assert(out.RowsCount() == a.RowsCount() && out.ColsCount() == b.ColsCount() && "out must have the dimensions of the result");
+
+    const auto lhs_operand{internal_impl::ToOperand(a)};
+    const auto rhs_operand{internal_impl::ToOperand(b)};
+    assert(!internal_impl::SharesMemory(out, lhs_operand) && !internal_impl::SharesMemory(out, rhs_operand)
+           && "out must not overlap the operands");
+
+    //* the engine writes row-major C: a column-major out is the row-major (B^T A^T)
+    if constexpr (internal_impl::IsRowMajor<L>) {
+        internal_impl::MultiplyInto<T>(lhs_operand, rhs_operand, out.RawData(), out.LeadingDimension(), pool);
+    } else {
+        internal_impl::MultiplyInto<T>(internal_impl::TransposedOf(rhs_operand), internal_impl::TransposedOf(lhs_operand),
+                                       out.RawData(), out.LeadingDimension(), pool);
+    }
+}
+
+//*
+//* Fused GEMM
+
+template <typename T, typename L, internal_impl::MatrixLike A, internal_impl::MatrixLike B, typename Epilogue>
+requires (!std::is_const_v<T>) && Multipliable<internal_impl::ValueOf<A>, internal_impl::ValueOf<B>>
+      && internal_impl::MorphConcept<Epilogue, T>
+void Gemm(std::type_identity_t<T> alpha, const A& a, const B& b, std::type_identity_t<T> beta,
+          MatrixView<T, internal_impl::DefaultMorph<T>, L> c, GemmBias<T> bias, Epilogue epilogue, ThreadPool& pool)
+{
+    assert(a.ColsCount() == b.RowsCount() && "Inner dimensions must match");
+    assert(c.RowsCount() == a.RowsCount() && c.ColsCount() == b.ColsCount() && "C must have the dimensions of A B");
+    assert((bias.row.empty() || bias.row.size() == c.RowsCount()) && "One row bias per row of C");
+    assert((bias.col.empty() || bias.col.size() == c.ColsCount()) && "One column bias per column of C");
+
+    const auto lhs_operand{internal_impl::ToOperand(a)};
+    const auto rhs_operand{internal_impl::ToOperand(b)};
+    assert(!internal_impl::SharesMemory(c, lhs_operand) && !internal_impl::SharesMemory(c, rhs_operand)
+           && "C must not overlap A or B");
+
+    const auto data_or_null{[](std::span<const T> values) { return values.empty() ? nullptr : values.data(); }};
+    //* the engine writes row-major C: a column-major C is the row-major (B^T A^T), with the biases swapped
+    if constexpr (internal_impl::IsRowMajor<L>) {
+        const internal_impl::GemmEpilogue<T, Epilogue> fused{alpha, beta, data_or_null(bias.row), data_or_null(bias.col), std::move(epilogue)};
+        internal_impl::ParallelGemm<T>(pool, c.RowsCount(), c.ColsCount(), a.ColsCount(),
+                                       internal_impl::GemmAccessor<T>(lhs_operand), internal_impl::GemmAccessor<T>(rhs_operand),
+                                       c.RawData(), c.LeadingDimension(), fused);
+    } else {
+        const internal_impl::GemmEpilogue<T, Epilogue> fused{alpha, beta, data_or_null(bias.col), data_or_null(bias.row), std::move(epilogue)};
+        const auto lhs_transposed{internal_impl::TransposedOf(lhs_operand)};
+        const auto rhs_transposed{internal_impl::TransposedOf(rhs_operand)};
+        internal_impl::ParallelGemm<T>(pool, c.ColsCount(), c.RowsCount(), a.ColsCount(),
+                                       internal_impl::GemmAccessor<T>(rhs_transposed), internal_impl::GemmAccessor<T>(lhs_transposed),
+                                       c.RawData(), c.LeadingDimension(), fused);
+    }
+}
+
+//*
+//* Transposition
+
+template <typename T, typename M, typename L, typename R>
+Matrix<R> Transpose(const MatrixView<T, M, L>& view, ThreadPool& pool)
+{
+    Matrix<R> result(view.ColsCount(), view.RowsCount());
+
+    if constexpr (internal_impl::RawOperand<R, T, M> && internal_impl::IsRowMajor<L>) {
+        internal_impl::Transpose(view.RawData(), view.LeadingDimension(), result.RawData(), result.LeadingDimension(),
+                                 view.RowsCount(), view.ColsCount(), pool);
+    } else if constexpr (internal_impl::RawOperand<R, T, M>) {
+        // the columns of a column-major view are the rows of the result
+        for (std::size_t c{0}; c < view.ColsCount(); ++c)
+            std::ranges::copy(view.Col(c), result.Row(c).begin());
+    } else {
+        internal_impl::TransposeElements(
+            [&view](std::size_t r, std::size_t c) { return view.At(r, c); },
+            result.RawData(), result.LeadingDimension(), view.RowsCount(), view.ColsCount(), pool);
     }
 
     return result;
 }
 
-template <typename T, typename W, typename Morph,  typename R>
+//* The straightforward dot product per output cell, kept as the reference for the blocked engine
+template <typename T, typename W, typename MorphOne, typename MorphTwo, typename L1, typename L2, typename R>
 requires Multipliable<T, W>
-constexpr Matrix<R> operator*(const MatrixView<T, Morph>& lhs, const W& val)
+constexpr Matrix<R> MultiplyReference(const MatrixView<T, MorphOne, L1>& lhs, const MatrixView<W, MorphTwo, L2>& rhs)
 {
     const auto rows_count{lhs.RowsCount()};
-    const auto cols_count{lhs.ColsCount()};
+    const auto cols_count{rhs.ColsCount()};
     
     Matrix<R> result(rows_count, cols_count);
-    
-    for (std::size_t r{0}; r < rows_count; ++r) {
-        for (std::size_t c{0}; c < cols_count; ++c)
-            result[r][c] = lhs[r][c] * val;
+
+    for (std::size_t rhs_col_i{0}; rhs_col_i < cols_count; ++rhs_col_i) {
+        const auto rhs_col{rhs.Col(rhs_col_i)};
+        for (std::size_t lhs_row_i{0}; lhs_row_i < rows_count; ++lhs_row_i) {
+            result[lhs_row_i][rhs_col_i] = DotProduct(lhs.Row(lhs_row_i), rhs_col);
+        }
     }
-    
+
     return result;
 }
 
@@ -816,8 +1705,6 @@ constexpr Matrix<R> operator*(const MatrixView<T, Morph>& lhs, const W& val)
 
 //TODO annotate with noexcept
 
-//TODO make it lazy
-
 //* util functions like: B | rage::views::negative or rge::views::negative(B)
 
 //TODO look at the assembly code generated by Add(const MatrixView<W>& mv) and Add(const Matrix<W>& m)
\ No newline at end of file
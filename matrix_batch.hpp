@@ -0,0 +1,168 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cassert>
+#include <span>
+#include <vector>
+
+//* Many matrices of the same shape, MatrixBatch<T>
+//*
+//* One allocation for the whole batch: matrix i is rows x cols, dense and row-major, right after matrix i - 1.
+//* Per matrix there is no header, no padding and no embedded view, only rows * cols elements,
+//* and batch[i] is a regular MatrixView over its slice of the buffer.
+//* Element-wise operations see the batch as one flat buffer, so the SIMD kernels run across the
+//* batch dimension. Multiply runs a small, vectorized row kernel per matrix, matrices spread over the pool.
+
+namespace internal_impl {
+
+//* c (m x n) = a (m x k) * b (k x n), all dense: each row of c accumulates rows of b, the inner loop is contiguous
+template <typename T>
+constexpr void SmallGemm(const T* a, const T* b, T* c, std::size_t m, std::size_t n, std::size_t k)
+{
+    for (std::size_t r{0}; r < m; ++r) {
+        T* c_row{c + r * n};
+        std::fill(c_row, c_row + n, T{});
+        for (std::size_t p{0}; p < k; ++p) {
+            const T a_rp{a[r * k + p]};
+            const T* b_row{b + p * n};
+            for (std::size_t j{0}; j < n; ++j)
+                c_row[j] += a_rp * b_row[j];
+        }
+    }
+}
+
+} // namespace internal_impl
+
+namespace rage {
+
+template <typename T, typename Alloc = AlignedAllocator<T>>
+class MatrixBatch
+{
+public:
+    using ValueType = T;
+
+    //* count matrices of rows x cols, value initialized
+    explicit MatrixBatch(std::size_t count, std::size_t rows, std::size_t cols, const Alloc& alloc = Alloc{})
+        :   count_{count},
+            rows_count_{rows},
+            cols_count_{cols},
+            data_(count * rows * cols, alloc)
+    {}
+
+public:
+    MatrixBatch& Add(const T& val) {
+        ForEachBlock_([&](std::size_t first, std::size_t n) {
+            internal_impl::simd::AddValue(data_.data() + first, val, data_.data() + first, n);
+        });
+        return *this;
+    }
+
+    MatrixBatch& Sub(const T& val) { return Add(static_cast<T>(-val)); }
+
+    template <typename A>
+    MatrixBatch& Add(const MatrixBatch<T, A>& other) {
+        assert(SameShape_(other) && "Batches must have the same count and dimensions");
+        ForEachBlock_([&](std::size_t first, std::size_t n) {
+            internal_impl::simd::Add(data_.data() + first, other.RawData() + first, data_.data() + first, n);
+        });
+        return *this;
+    }
+
+    template <typename A>
+    MatrixBatch& Sub(const MatrixBatch<T, A>& other) {
+        assert(SameShape_(other) && "Batches must have the same count and dimensions");
+        ForEachBlock_([&](std::size_t first, std::size_t n) {
+            internal_impl::simd::Sub(data_.data() + first, other.RawData() + first, data_.data() + first, n);
+        });
+        return *this;
+    }
+
+    MatrixBatch& Scale(const T& val) {
+        ForEachBlock_([&](std::size_t first, std::size_t n) {
+            internal_impl::simd::MulValue(data_.data() + first, val, data_.data() + first, n);
+        });
+        return *this;
+    }
+
+//* Views
+public:
+    MatrixView<T> operator[](std::size_t i) { return View(i); }
+    MatrixView<const T> operator[](std::size_t i) const { return View(i); }
+
+    MatrixView<T> View(std::size_t i) {
+        assert(i < count_ && "Index out of the batch");
+        return MatrixView<T>::FromBuffer(MatrixData(i), rows_count_, cols_count_);
+    }
+
+    MatrixView<const T> View(std::size_t i) const {
+        assert(i < count_ && "Index out of the batch");
+        return MatrixView<const T>::FromBuffer(MatrixData(i), rows_count_, cols_count_);
+    }
+
+//* Access methods
+public:
+    std::size_t Count() const { return count_; }
+    std::size_t RowsCount() const { return rows_count_; }
+    std::size_t ColsCount() const { return cols_count_; }
+
+    //* elements per matrix, also the distance between the start of two matrices
+    std::size_t MatrixSize() const { return rows_count_ * cols_count_; }
+
+    //* every element of every matrix, matrix after matrix
+    std::span<T> Elements() { return data_; }
+    std::span<const T> Elements() const { return data_; }
+
+    T* RawData() { return data_.data(); }
+    const T* RawData() const { return data_.data(); }
+
+    T* MatrixData(std::size_t i) { return data_.data() + i * MatrixSize(); }
+    const T* MatrixData(std::size_t i) const { return data_.data() + i * MatrixSize(); }
+
+private:
+    //* fn(first element, elements count) over runs of whole matrices, in parallel for big batches
+    template <typename F>
+    void ForEachBlock_(const F& fn) {
+        internal_impl::ForEachRowBlock(ThreadPool::Default(), count_, MatrixSize(), [&](std::size_t first, std::size_t last) {
+            fn(first * MatrixSize(), (last - first) * MatrixSize());
+        });
+    }
+
+    template <typename A>
+    bool SameShape_(const MatrixBatch<T, A>& other) const {
+        return count_ == other.Count() && rows_count_ == other.RowsCount() && cols_count_ == other.ColsCount();
+    }
+
+private:
+    std::size_t count_;
+    std::size_t rows_count_;
+    std::size_t cols_count_;
+    std::vector<T, Alloc> data_;
+};
+
+//* out[i] = lhs[i] * rhs[i] for every i, the matrices are spread over the pool
+template <typename T, typename A1, typename A2>
+MatrixBatch<T> Multiply(const MatrixBatch<T, A1>& lhs, const MatrixBatch<T, A2>& rhs, ThreadPool& pool)
+{
+    assert(lhs.Count() == rhs.Count() && "Batches must have the same count");
+    assert(lhs.ColsCount() == rhs.RowsCount() && "Inner dimensions must match");
+
+    MatrixBatch<T> result(lhs.Count(), lhs.RowsCount(), rhs.ColsCount());
+    const auto work{lhs.RowsCount() * rhs.ColsCount() * lhs.ColsCount()};
+    internal_impl::ForEachRowBlock(pool, lhs.Count(), work, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i{first}; i < last; ++i) {
+            internal_impl::SmallGemm(lhs.MatrixData(i), rhs.MatrixData(i), result.MatrixData(i),
+                                     lhs.RowsCount(), rhs.ColsCount(), lhs.ColsCount());
+        }
+    });
+
+    return result;
+}
+
+template <typename T, typename A1, typename A2>
+inline MatrixBatch<T> Multiply(const MatrixBatch<T, A1>& lhs, const MatrixBatch<T, A2>& rhs)
+{
+    return Multiply(lhs, rhs, ThreadPool::Default());
+}
+
+} // namespace rage
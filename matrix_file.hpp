@@ -0,0 +1,135 @@
+#pragma once
+
+#include "layout.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+//* Binary matrix files, written by Matrix::Save and mapped by MapMatrix (mapped_matrix.hpp)
+//*
+//*   offset 0   MatrixFileHeader (64 bytes)
+//*   offset 64  the buffer exactly as it is in memory: LinesCount lines of leading_dimension elements
+//*
+//* The data starts at data_offset, a multiple of alignment, so a mapping of the file hands out
+//* the same aligned (and padded) lines the Matrix had. Numbers are in the byte order of the
+//* machine that wrote the file, byte_order tells a reader when that is not its own.
+
+namespace internal_impl {
+
+enum class DType : std::uint32_t {
+    Int8 = 1, Int16, Int32, Int64,
+    UInt8, UInt16, UInt32, UInt64,
+    Float32, Float64
+};
+
+template <typename T> struct DTypeOf_;
+template <> struct DTypeOf_<std::int8_t>   : std::integral_constant<DType, DType::Int8> {};
+template <> struct DTypeOf_<std::int16_t>  : std::integral_constant<DType, DType::Int16> {};
+template <> struct DTypeOf_<std::int32_t>  : std::integral_constant<DType, DType::Int32> {};
+template <> struct DTypeOf_<std::int64_t>  : std::integral_constant<DType, DType::Int64> {};
+template <> struct DTypeOf_<std::uint8_t>  : std::integral_constant<DType, DType::UInt8> {};
+template <> struct DTypeOf_<std::uint16_t> : std::integral_constant<DType, DType::UInt16> {};
+template <> struct DTypeOf_<std::uint32_t> : std::integral_constant<DType, DType::UInt32> {};
+template <> struct DTypeOf_<std::uint64_t> : std::integral_constant<DType, DType::UInt64> {};
+template <> struct DTypeOf_<float>         : std::integral_constant<DType, DType::Float32> {};
+template <> struct DTypeOf_<double>        : std::integral_constant<DType, DType::Float64> {};
+
+//* the element types a matrix file can hold
+template <typename T>
+concept Storable = requires { DTypeOf_<std::remove_cv_t<T>>::value; };
+
+template <Storable T>
+inline constexpr DType DTypeOf = DTypeOf_<std::remove_cv_t<T>>::value;
+
+struct MatrixFileHeader {
+    static constexpr char expected_magic[8]{'R', 'A', 'G', 'E', 'M', 'A', 'T', '\0'};
+    static constexpr std::uint32_t current_version{1};
+    static constexpr std::uint32_t native_byte_order{0x01020304};
+
+    char magic[8];
+    std::uint32_t version;
+    DType dtype;
+    std::uint32_t element_size;
+    std::uint32_t layout;          //* 0 RowMajor, 1 ColMajor
+    std::uint32_t byte_order;      //* native_byte_order as written by the writer
+    std::uint32_t alignment;       //* of data_offset, in bytes
+    std::uint64_t rows;
+    std::uint64_t cols;
+    std::uint64_t leading_dimension;
+    std::uint64_t data_offset;
+};
+static_assert(sizeof(MatrixFileHeader) == 64 && std::is_trivially_copyable_v<MatrixFileHeader>);
+
+template <typename Layout>
+inline constexpr std::uint32_t LayoutId = IsRowMajor<Layout> ? 0 : 1;
+
+//* throws std::runtime_error when the file cannot be written
+template <Storable T, typename Layout>
+void WriteMatrixFile(const std::filesystem::path& path, const T* data,
+                     std::size_t rows, std::size_t cols, std::size_t ld)
+{
+    MatrixFileHeader header{};
+    std::memcpy(header.magic, MatrixFileHeader::expected_magic, sizeof(header.magic));
+    header.version = MatrixFileHeader::current_version;
+    header.dtype = DTypeOf<T>;
+    header.element_size = sizeof(T);
+    header.layout = LayoutId<Layout>;
+    header.byte_order = MatrixFileHeader::native_byte_order;
+    header.alignment = sizeof(MatrixFileHeader);
+    header.rows = rows;
+    header.cols = cols;
+    header.leading_dimension = ld;
+    header.data_offset = sizeof(MatrixFileHeader);
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(data),
+               static_cast<std::streamsize>(Layout::LinesCount(rows, cols) * ld * sizeof(T)));
+    file.close();
+    if (!file)
+        throw std::runtime_error{"Could not write the matrix file " + path.string()};
+}
+
+//* throws std::runtime_error when the header does not describe a T matrix stored in Layout
+template <Storable T, typename Layout>
+void CheckMatrixFileHeader(const MatrixFileHeader& header, std::size_t file_size, const std::filesystem::path& path)
+{
+    const auto fail{[&path](const char* what) {
+        throw std::runtime_error{"Bad matrix file " + path.string() + ": " + what};
+    }};
+
+    if (std::memcmp(header.magic, MatrixFileHeader::expected_magic, sizeof(header.magic)) != 0)
+        fail("not a matrix file");
+    if (header.version != MatrixFileHeader::current_version)
+        fail("unknown version");
+    if (header.byte_order != MatrixFileHeader::native_byte_order)
+        fail("written with another byte order");
+    if (header.dtype != DTypeOf<T> || header.element_size != sizeof(T))
+        fail("element type does not match");
+    if (header.layout != LayoutId<Layout>)
+        fail("layout does not match");
+    if (header.leading_dimension < Layout::LineLength(header.rows, header.cols))
+        fail("leading dimension shorter than a line");
+    if (header.alignment < alignof(T) || (header.alignment & (header.alignment - 1)) != 0)
+        fail("alignment is not a power of two multiple of the element alignment");
+    if (header.data_offset < sizeof(MatrixFileHeader) || header.data_offset % header.alignment != 0)
+        fail("misaligned data");
+
+    //* the sizes come from the file: a product or sum wrapping around would pass for a small one
+    std::uint64_t data_size{0};
+    std::uint64_t data_end{0};
+    if (__builtin_mul_overflow(Layout::LinesCount(header.rows, header.cols), header.leading_dimension, &data_size)
+        || __builtin_mul_overflow(data_size, sizeof(T), &data_size)
+        || __builtin_add_overflow(header.data_offset, data_size, &data_end))
+        fail("size overflows");
+    if (data_end > file_size)
+        fail("truncated");
+}
+
+} // namespace internal_impl
@@ -8,89 +8,125 @@
 #include <optional>
 
 namespace internal_impl {
-    struct NoType {};
-    
+    //* The identity: a view without a morph. Empty, so [[no_unique_address]] members cost nothing,
+    //* and the code checks IsDefaultMorph to skip it altogether.
     template <typename T>
-    using DefaultMorph = std::function<NoType(T)>;
+    struct DefaultMorph {
+        template <typename U>
+        constexpr U&& operator()(U&& v) const noexcept { return std::forward<U>(v); }
+    };
+
+    template <typename Morph> struct IsDefaultMorph_ : std::false_type {};
+    template <typename T> struct IsDefaultMorph_<DefaultMorph<T>> : std::true_type {};
+
+    //* true for DefaultMorph<T> with any T (a MatrixView<int> iterated as const still has DefaultMorph<int>)
+    template <typename Morph>
+    inline constexpr bool IsDefaultMorph = IsDefaultMorph_<std::remove_cvref_t<Morph>>::value;
 
     template<typename Morph, typename T>
     concept MorphConcept = std::is_invocable_v<Morph, T>;
+
+    //* second(first(x)), keeps the concrete types of both so view.View(f).View(g) inlines into one loop
+    template <typename First, typename Second>
+    struct ComposedMorph {
+        [[no_unique_address]] First first;
+        [[no_unique_address]] Second second;
+
+        template <typename U>
+        constexpr auto operator()(U&& v) const { return second(first(std::forward<U>(v))); }
+    };
+
+    //* the morph of view.View(new_morph), given the morph of view
+    template <typename Morph, typename NewMorph>
+    using ComposeMorph = std::conditional_t<IsDefaultMorph<Morph>,
+                                            std::decay_t<NewMorph>,
+                                            ComposedMorph<Morph, std::decay_t<NewMorph>>>;
+
+    template <typename Morph, typename NewMorph>
+    constexpr ComposeMorph<Morph, NewMorph> Compose(const Morph& morph, NewMorph&& new_morph) {
+        if constexpr (IsDefaultMorph<Morph>)
+            return std::forward<NewMorph>(new_morph);
+        else
+            return {morph, std::forward<NewMorph>(new_morph)};
+    }
 }
 
 namespace rage {
 
 // this is both a Matrix and MatrixView Iterator
+//* Random access over the rows of a row-major buffer: a row is a std::span (a transform_view of it with a morph),
+//* built on dereference, so moving the iterator is only pointer arithmetic.
+//* Rows are returned by value like the elements of std::views::transform, hence the input iterator_category
+//* for the pre-C++20 algorithms; the iterator_concept is random access.
 template <typename T, typename Morph = internal_impl::DefaultMorph<T>>
 requires internal_impl::MorphConcept<Morph, T>
 class MatrixIterator {
     public:
-        using iterator_category = std::forward_iterator_tag;
+        using iterator_concept  = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
         using difference_type   = std::ptrdiff_t;
-        using value_type        = std::conditional_t< std::is_same_v<Morph, internal_impl::DefaultMorph<T>>,
+        using value_type        = std::conditional_t< internal_impl::IsDefaultMorph<Morph>,
                                                     std::span<T>,
                                                     std::ranges::transform_view<std::span<T>, Morph>>;
-        using pointer           = value_type*;
-        using reference         = value_type&;
+        using reference         = value_type;
     
     public:
-        explicit MatrixIterator(T* start, std::size_t cols_count, std::size_t real_col_count, std::optional<Morph> morph = std::nullopt)
-            :   row_{start, cols_count},
-                real_col_count_{real_col_count}
-        {
-            if constexpr(!std::is_same_v<Morph, internal_impl::DefaultMorph<T>>) {
-                morph_ = morph.value();
-                morphed_row_ = row_ | std::views::transform(morph_);
-            }
-        }
-        explicit MatrixIterator(){} //! removing this breaks std::ranges::range<Matrix<T>>, aka breaks everything
+        constexpr explicit MatrixIterator(T* start, std::size_t cols_count, std::size_t real_col_count, Morph morph = {})
+            :   start_{start},
+                cols_count_{cols_count},
+                real_col_count_{real_col_count},
+                morph_{std::move(morph)}
+        {}
+        constexpr MatrixIterator() = default; //! removing this breaks std::ranges::range<Matrix<T>>, aka breaks everything
 
-        reference operator*() const { //! needs to be const
-            if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-                return row_;
+        constexpr reference operator*() const {
+            if constexpr (internal_impl::IsDefaultMorph<Morph>)
+                return std::span<T>{start_, cols_count_};
             else
-                return morphed_row_;
+                return std::span<T>{start_, cols_count_} | std::views::transform(morph_);
         }
 
-        pointer operator->() {
-            if constexpr (std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-                return &row_;
-            else
-                return &morphed_row_;
-        }
+        constexpr reference operator[](difference_type n) const { return *(*this + n); }
 
-        MatrixIterator& operator++() {
-            row_ = std::span<T>{&row_.front() + real_col_count_, row_.size()};
-            if constexpr(!std::is_same_v<Morph, internal_impl::DefaultMorph<T>>)
-                morphed_row_ = row_ | std::views::transform(morph_);
-            return *this;
-        }
+        constexpr MatrixIterator& operator++() { start_ += real_col_count_; return *this; }
+        constexpr MatrixIterator& operator--() { start_ -= real_col_count_; return *this; }
 
         // postfix
-        MatrixIterator operator++(int) {
+        constexpr MatrixIterator operator++(int) {
             auto cpy{*this};
             ++(*this);
             return cpy;
         }
 
-    private:
-        mutable std::span<T> row_;
-        std::size_t real_col_count_;
-        Morph morph_;
-        mutable value_type morphed_row_;
+        constexpr MatrixIterator operator--(int) {
+            auto cpy{*this};
+            --(*this);
+            return cpy;
+        }
 
-    private:
-        template <typename A, typename B, typename C, typename D> friend bool operator==(const MatrixIterator<A, B>& a, const MatrixIterator<C, D>& b);
-        template <typename A, typename B, typename C, typename D> friend bool operator!=(const MatrixIterator<A, B>& a, const MatrixIterator<C, D>& b);
-};
+        constexpr MatrixIterator& operator+=(difference_type n) {
+            start_ += n * static_cast<difference_type>(real_col_count_);
+            return *this;
+        }
+        constexpr MatrixIterator& operator-=(difference_type n) { return *this += -n; }
 
-template <typename A, typename B, typename C, typename D>
-inline bool operator==(const MatrixIterator<A, B>& a, const MatrixIterator<C, D>& b) {
-    return &a.row_.front() == &b.row_.front();
-}
+        friend constexpr MatrixIterator operator+(MatrixIterator it, difference_type n) { return it += n; }
+        friend constexpr MatrixIterator operator+(difference_type n, MatrixIterator it) { return it += n; }
+        friend constexpr MatrixIterator operator-(MatrixIterator it, difference_type n) { return it -= n; }
 
-template <typename A, typename B, typename C, typename D>
-inline bool operator!=(const MatrixIterator<A, B>& a, const MatrixIterator<C, D>& b) {
-    return &a.row_.front() != &b.row_.front();
-}
+        //* rows between a and b, 0 for a matrix without columns (all its rows start at the same place)
+        friend constexpr difference_type operator-(const MatrixIterator& a, const MatrixIterator& b) {
+            return a.real_col_count_ == 0 ? 0 : (a.start_ - b.start_) / static_cast<difference_type>(a.real_col_count_);
+        }
+
+        friend constexpr bool operator==(const MatrixIterator& a, const MatrixIterator& b) { return a.start_ == b.start_; }
+        friend constexpr auto operator<=>(const MatrixIterator& a, const MatrixIterator& b) { return a.start_ <=> b.start_; }
+
+    private:
+        T* start_{nullptr};
+        std::size_t cols_count_{0};
+        std::size_t real_col_count_{0};
+        [[no_unique_address]] Morph morph_{};
+};
 
-} // namespace rage
\ No newline at end of file
+} // namespace rage
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+//* std::mdspan <-> MatrixView, both ways without a copy (C++23 libraries that ship <mdspan>)
+//*
+//*   ToMdspan(view)        layout_stride mdspan over the viewed elements, strides {ld, 1} (RowMajor) or {1, ld} (ColMajor)
+//*   FromMdspan(md)        MatrixView over a rank 2 mdspan: layout_right gives a RowMajor view, layout_left
+//*                         a ColMajor one; for layout_stride the Layout is chosen by the caller and checked
+
+#if __has_include(<mdspan>)
+#include <mdspan>
+#endif
+
+#if defined(__cpp_lib_mdspan)
+
+namespace rage {
+
+template <typename T>
+using MatrixMdspan = std::mdspan<T, std::dextents<std::size_t, 2>, std::layout_stride>;
+
+template <typename T, typename L>
+MatrixMdspan<T> ToMdspan(const MatrixView<T, internal_impl::DefaultMorph<T>, L>& view)
+{
+    using Mapping = std::layout_stride::mapping<std::dextents<std::size_t, 2>>;
+    const std::dextents<std::size_t, 2> extents{view.RowsCount(), view.ColsCount()};
+    const auto ld{view.LeadingDimension()};
+    const auto strides{internal_impl::IsRowMajor<L> ? std::array<std::size_t, 2>{ld, 1} : std::array<std::size_t, 2>{1, ld}};
+    return MatrixMdspan<T>{view.RawData(), Mapping{extents, strides}};
+}
+
+template <typename T, typename A, typename L>
+MatrixMdspan<T> ToMdspan(Matrix<T, A, L>& m) { return ToMdspan(m.View()); }
+
+template <typename T, typename A, typename L>
+MatrixMdspan<const T> ToMdspan(const Matrix<T, A, L>& m) { return ToMdspan(m.View()); }
+
+template <typename T, typename E>
+requires (E::rank() == 2)
+MatrixView<T, internal_impl::DefaultMorph<T>, RowMajor> FromMdspan(std::mdspan<T, E, std::layout_right> md)
+{
+    const auto rows{static_cast<std::size_t>(md.extent(0))};
+    const auto cols{static_cast<std::size_t>(md.extent(1))};
+    return MatrixView<T>::FromBuffer(md.data_handle(), rows, cols, cols);
+}
+
+template <typename T, typename E>
+requires (E::rank() == 2)
+MatrixView<T, internal_impl::DefaultMorph<T>, ColMajor> FromMdspan(std::mdspan<T, E, std::layout_left> md)
+{
+    const auto rows{static_cast<std::size_t>(md.extent(0))};
+    const auto cols{static_cast<std::size_t>(md.extent(1))};
+    return MatrixView<T, internal_impl::DefaultMorph<T>, ColMajor>::FromBuffer(md.data_handle(), rows, cols, rows);
+}
+
+//* the line stride must be 1 for the chosen Layout, e.g. FromMdspan<ColMajor>(ToMdspan(col_major_view))
+template <typename Layout = RowMajor, typename T, typename E>
+requires (E::rank() == 2)
+MatrixView<T, internal_impl::DefaultMorph<T>, Layout> FromMdspan(std::mdspan<T, E, std::layout_stride> md)
+{
+    constexpr std::size_t line_axis{internal_impl::IsRowMajor<Layout> ? 0 : 1};
+    const auto rows{static_cast<std::size_t>(md.extent(0))};
+    const auto cols{static_cast<std::size_t>(md.extent(1))};
+    assert((md.stride(1 - line_axis) == 1 || md.extent(1 - line_axis) <= 1) && "The elements of a line must be contiguous");
+    // with a single line its stride is free, any value would do
+    const std::size_t ld{Layout::LinesCount(rows, cols) <= 1 ? Layout::LineLength(rows, cols)
+                                                             : static_cast<std::size_t>(md.stride(line_axis))};
+    return MatrixView<T, internal_impl::DefaultMorph<T>, Layout>::FromBuffer(md.data_handle(), rows, cols, ld);
+}
+
+} // namespace rage
+
+#endif // __cpp_lib_mdspan
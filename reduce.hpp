@@ -0,0 +1,450 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//* Reductions of matrices, views (morphs included) and expressions
+//*
+//*   Sum, Mean, Max, Min, ArgMax, ArgMin     over every element
+//*   RowSums, ColSums                        one value per row / column, as a std::vector
+//*   NormL1, NormInf, NormFrobenius          max column sum, max row sum of the absolute values, sqrt of the sum of squares
+//*
+//* Plain memory is read in place: dense buffers as runs of ReduceRun elements, padded ones line by line, each run
+//* going through the SIMD kernels of simd.hpp. Anything else (morphs, expressions) is read a row at a time into a buffer.
+//* Runs are reduced in parallel on big inputs, then the partial results are combined in run order: the cut depends
+//* on the operand only, so the results do not change with the number of threads.
+//* A sum along the lines of the storage (RowSums of a RowMajor matrix) reduces each line on its own, a sum across them
+//* (ColSums of a RowMajor matrix) adds whole lines into the result, every thread owning a slice of the columns.
+//*
+//* Floating point sums take a Summation: Pairwise (the default) costs the same as Plain and its error grows with
+//* log(n) instead of n, Kahan is compensated and a few times slower. Max and Min skip NaNs (NaN when there is nothing else).
+
+namespace rage {
+
+enum class Summation {
+    Pairwise, //* halves down to blocks of PairwiseLeaf elements, added by the SIMD kernel
+    Plain,    //* one SIMD pass with several accumulators
+    Kahan,    //* compensated, per SIMD lane
+};
+
+struct MatrixIndex {
+    std::size_t row{0};
+    std::size_t col{0};
+
+    constexpr bool operator==(const MatrixIndex&) const = default;
+};
+
+} // namespace rage
+
+namespace internal_impl {
+
+inline constexpr std::size_t ReduceRun{1 << 14};   // elements of a run of dense memory
+inline constexpr std::size_t PairwiseLeaf{256};    // elements summed in one go by Summation::Pairwise
+inline constexpr std::size_t PairwiseLines{8};     // lines added in one go by a pairwise sum across lines
+
+template <typename T>
+T SumRun(const T* a, std::size_t n, rage::Summation summation)
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        if (summation == rage::Summation::Kahan)
+            return simd::KahanSum(a, n);
+        if (summation == rage::Summation::Pairwise && n > PairwiseLeaf) {
+            const auto half{n / 2 / 64 * 64}; // whole vectors on the left
+            return SumRun(a, half, summation) + SumRun(a + half, n - half, summation);
+        }
+    }
+    return simd::Sum(a, n);
+}
+
+//* The elements of an operand as contiguous memory, in lines of its storage order or in runs
+template <typename R, typename Operand>
+class ReduceReader
+{
+public:
+    static constexpr bool raw{IsRawView<R, Operand>::value};
+    using Layout = std::conditional_t<raw, typename LayoutOf_<Operand>::type, rage::RowMajor>;
+
+    explicit ReduceReader(const Operand& operand)
+        :   operand_{operand}
+    {}
+
+public:
+    std::size_t LinesCount() const { return Layout::LinesCount(operand_.RowsCount(), operand_.ColsCount()); }
+    std::size_t LineLength() const { return Layout::LineLength(operand_.RowsCount(), operand_.ColsCount()); }
+
+    //* elements [first, first + count) of a line
+    const R* Line(std::size_t line, std::size_t first, std::size_t count) {
+        if constexpr (raw) {
+            return operand_.RawData() + line * operand_.LeadingDimension() + first;
+        } else {
+            buffer_.resize(count);
+            for (std::size_t c{0}; c < count; ++c)
+                buffer_[c] = static_cast<R>(operand_.At(line, first + c));
+            return buffer_.data();
+        }
+    }
+
+    const R* Line(std::size_t line) { return Line(line, 0, LineLength()); }
+
+    //* dense memory is cut in runs of ReduceRun elements, anything else gives a run per line
+    std::size_t RunsCount() const { return Dense_() ? (Size_() + ReduceRun - 1) / ReduceRun : LinesCount(); }
+    std::size_t RunLength() const { return Dense_() ? ReduceRun : LineLength(); }
+
+    std::span<const R> Run(std::size_t run) {
+        if constexpr (raw) {
+            if (Dense_())
+                return {operand_.RawData() + run * ReduceRun, std::min(ReduceRun, Size_() - run * ReduceRun)};
+        }
+        return {Line(run), LineLength()};
+    }
+
+    //* row and column of an element of a run
+    rage::MatrixIndex Position(std::size_t run, std::size_t offset) const {
+        const auto flat{Dense_() ? run * ReduceRun + offset : run * LineLength() + offset};
+        const auto line{flat / LineLength()};
+        const auto in_line{flat % LineLength()};
+        return IsRowMajor<Layout> ? rage::MatrixIndex{line, in_line} : rage::MatrixIndex{in_line, line};
+    }
+
+private:
+    std::size_t Size_() const { return LinesCount() * LineLength(); }
+
+    bool Dense_() const {
+        if constexpr (raw)
+            return operand_.LeadingDimension() == LineLength() || LinesCount() <= 1;
+        else
+            return false;
+    }
+
+private:
+    const Operand& operand_;
+    std::vector<R> buffer_;
+};
+
+//* fn(run, elements) for every run of the operand, in parallel when it is big enough
+template <typename R, typename Operand, typename F>
+void ForEachRun(rage::ThreadPool& pool, const Operand& operand, const F& fn)
+{
+    const ReduceReader<R, Operand> counter{operand};
+    ForEachRowBlock(pool, counter.RunsCount(), counter.RunLength(), [&](std::size_t first, std::size_t last) {
+        ReduceReader<R, Operand> reader{operand};
+        for (auto run{first}; run < last; ++run)
+            fn(run, reader.Run(run));
+    });
+}
+
+template <typename R, typename Operand>
+R Sum(const Operand& operand, rage::Summation summation, rage::ThreadPool& pool)
+{
+    std::vector<R> partials(ReduceReader<R, Operand>{operand}.RunsCount());
+    ForEachRun<R>(pool, operand, [&](std::size_t run, std::span<const R> elements) {
+        partials[run] = SumRun(elements.data(), elements.size(), summation);
+    });
+    return SumRun(partials.data(), partials.size(), summation);
+}
+
+//* the largest (smallest) element and, when Locate, the first place holding it in the storage order
+template <bool Largest, bool Locate, typename R, typename Operand>
+std::pair<R, rage::MatrixIndex> Extremum(const Operand& operand, rage::ThreadPool& pool)
+{
+    assert(operand.RowsCount() != 0 && operand.ColsCount() != 0 && "No extremum in an empty matrix");
+
+    ReduceReader<R, Operand> reader{operand};
+    std::vector<R> partials(reader.RunsCount());
+    ForEachRun<R>(pool, operand, [&](std::size_t run, std::span<const R> elements) {
+        partials[run] = Largest ? simd::Max(elements.data(), elements.size()) : simd::Min(elements.data(), elements.size());
+    });
+
+    std::size_t best_run{0};
+    for (std::size_t run{1}; run < partials.size(); ++run) {
+        if (Largest ? partials[run] > partials[best_run] : partials[run] < partials[best_run])
+            best_run = run;
+    }
+    const R best{partials[best_run]};
+
+    // nothing beat the start value: the elements are all NaN, or some of them are at the start value
+    const bool at_start{!(Largest ? best > simd::ExtremumStart<Largest, R>() : best < simd::ExtremumStart<Largest, R>())};
+    if (!Locate && !at_start)
+        return {best, {}};
+
+    for (auto run{best_run}; run < (at_start ? partials.size() : best_run + 1); ++run) {
+        const auto elements{reader.Run(run)};
+        const auto found{std::ranges::find(elements, best)};
+        if (found != elements.end())
+            return {best, reader.Position(run, static_cast<std::size_t>(found - elements.begin()))};
+    }
+    return {std::numeric_limits<R>::quiet_NaN(), {}};
+}
+
+//* a pairwise sum of the lines [first_line, last_line), elements [first, first + count) of each, into into.
+//* Every level of the recursion has its count elements of workspace
+template <typename R, typename Operand>
+void SumLinesPairwise_(ReduceReader<R, Operand>& reader, std::size_t first_line, std::size_t last_line,
+                       std::size_t first, std::size_t count, R* into, R* workspace)
+{
+    if (last_line - first_line <= PairwiseLines) {
+        std::fill_n(into, count, R{});
+        for (auto line{first_line}; line < last_line; ++line)
+            simd::Add(into, reader.Line(line, first, count), into, count);
+        return;
+    }
+
+    const auto middle{first_line + (last_line - first_line) / 2};
+    SumLinesPairwise_(reader, first_line, middle, first, count, into, workspace + count);
+    SumLinesPairwise_(reader, middle, last_line, first, count, workspace, workspace + count);
+    simd::Add(into, workspace, into, count);
+}
+
+//* out[i] = the sum of line i
+template <typename R, typename Operand>
+void SumAlongLines(rage::ThreadPool& pool, const Operand& operand, R* out, rage::Summation summation, bool absolute)
+{
+    const ReduceReader<R, Operand> counter{operand};
+    const auto length{counter.LineLength()};
+    ForEachRowBlock(pool, counter.LinesCount(), length, [&](std::size_t first, std::size_t last) {
+        ReduceReader<R, Operand> reader{operand};
+        for (auto line{first}; line < last; ++line) {
+            const R* elements{reader.Line(line)};
+            out[line] = absolute ? simd::SumAbs(elements, length) : SumRun(elements, length, summation);
+        }
+    });
+}
+
+//* out[j] = the sum over the lines of their element j. A block owns a slice of out and goes down all the lines,
+//* so there are no partial vectors to merge and the order of the additions does not depend on the threads
+template <typename R, typename Operand>
+void SumAcrossLines(rage::ThreadPool& pool, const Operand& operand, R* out, rage::Summation summation, bool absolute)
+{
+    const ReduceReader<R, Operand> counter{operand};
+    const auto lines{counter.LinesCount()};
+    const auto length{counter.LineLength()};
+
+    const auto slice{[&](std::size_t first, std::size_t last) {
+        ReduceReader<R, Operand> reader{operand};
+        const auto count{last - first};
+        R* sums{out + first};
+
+        if constexpr (std::is_floating_point_v<R>) {
+            if (!absolute && summation == rage::Summation::Pairwise && lines > PairwiseLines) {
+                std::size_t depth{0};
+                for (auto n{lines}; n > PairwiseLines; n = (n + 1) / 2)
+                    ++depth;
+                std::vector<R> workspace(depth * count);
+                return SumLinesPairwise_(reader, 0, lines, first, count, sums, workspace.data());
+            }
+            if (!absolute && summation == rage::Summation::Kahan) {
+                std::fill_n(sums, count, R{});
+                std::vector<R> compensations(count);
+                for (std::size_t line{0}; line < lines; ++line) {
+                    const R* elements{reader.Line(line, first, count)};
+                    for (std::size_t j{0}; j < count; ++j)
+                        simd::CompensatedAdd(sums[j], compensations[j], elements[j]);
+                }
+                for (std::size_t j{0}; j < count; ++j)
+                    sums[j] += compensations[j];
+                return;
+            }
+        }
+
+        std::fill_n(sums, count, R{});
+        for (std::size_t line{0}; line < lines; ++line) {
+            const R* elements{reader.Line(line, first, count)};
+            if (absolute) {
+                for (std::size_t j{0}; j < count; ++j)
+                    sums[j] += simd::Abs_(elements[j]);
+            } else {
+                simd::Add(sums, elements, sums, count);
+            }
+        }
+    }};
+
+    if (lines * length < rage::ParallelThresholds::elementwise || pool.ThreadsCount() == 1)
+        return slice(0, length);
+
+    //* at least a few cache lines wide, and enough lines times columns to be worth a task
+    const auto grain{std::max<std::size_t>(rage::ParallelThresholds::elementwise / 4 / std::max<std::size_t>(lines, 1), 16)};
+    pool.ParallelFor(0, length, grain, slice);
+}
+
+//* out[i] = the sum of row i (rows) or of column i
+template <typename R, typename Operand>
+void AxisSums(rage::ThreadPool& pool, const Operand& operand, bool rows, R* out, rage::Summation summation, bool absolute)
+{
+    if (rows == IsRowMajor<typename ReduceReader<R, Operand>::Layout>)
+        SumAlongLines(pool, operand, out, summation, absolute);
+    else
+        SumAcrossLines(pool, operand, out, summation, absolute);
+}
+
+//* largest of the sums, NaN when one of them is
+template <typename R>
+R MaxSum_(const std::vector<R>& sums)
+{
+    R norm{};
+    for (const auto sum : sums) {
+        if constexpr (std::is_floating_point_v<R>) {
+            if (std::isnan(sum))
+                return sum;
+        }
+        norm = std::max(norm, sum);
+    }
+    return norm;
+}
+
+} // namespace internal_impl
+
+namespace rage {
+
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+R Sum(const A& a, Summation summation, ThreadPool& pool)
+{
+    return internal_impl::Sum<R>(internal_impl::ToOperand(a), summation, pool);
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto Sum(const A& a, Summation summation = Summation::Pairwise) { return Sum(a, summation, ThreadPool::Default()); }
+
+//* in the element type for floating point matrices, in double for integers
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+auto Mean(const A& a, Summation summation, ThreadPool& pool)
+{
+    using Result = std::conditional_t<std::is_floating_point_v<R>, R, double>;
+    assert(a.RowsCount() != 0 && a.ColsCount() != 0 && "No mean of an empty matrix");
+    return static_cast<Result>(Sum(a, summation, pool)) / static_cast<Result>(a.RowsCount() * a.ColsCount());
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto Mean(const A& a, Summation summation = Summation::Pairwise) { return Mean(a, summation, ThreadPool::Default()); }
+
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+R Max(const A& a, ThreadPool& pool)
+{
+    return internal_impl::Extremum<true, false, R>(internal_impl::ToOperand(a), pool).first;
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto Max(const A& a) { return Max(a, ThreadPool::Default()); }
+
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+R Min(const A& a, ThreadPool& pool)
+{
+    return internal_impl::Extremum<false, false, R>(internal_impl::ToOperand(a), pool).first;
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto Min(const A& a) { return Min(a, ThreadPool::Default()); }
+
+//* the first largest element in the storage order (row by row for RowMajor); {0, 0} when they are all NaN
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+MatrixIndex ArgMax(const A& a, ThreadPool& pool)
+{
+    return internal_impl::Extremum<true, true, R>(internal_impl::ToOperand(a), pool).second;
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline MatrixIndex ArgMax(const A& a) { return ArgMax(a, ThreadPool::Default()); }
+
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+MatrixIndex ArgMin(const A& a, ThreadPool& pool)
+{
+    return internal_impl::Extremum<false, true, R>(internal_impl::ToOperand(a), pool).second;
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline MatrixIndex ArgMin(const A& a) { return ArgMin(a, ThreadPool::Default()); }
+
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+std::vector<R> RowSums(const A& a, Summation summation, ThreadPool& pool)
+{
+    std::vector<R> sums(a.RowsCount());
+    internal_impl::AxisSums(pool, internal_impl::ToOperand(a), true, sums.data(), summation, false);
+    return sums;
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto RowSums(const A& a, Summation summation = Summation::Pairwise) { return RowSums(a, summation, ThreadPool::Default()); }
+
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+std::vector<R> ColSums(const A& a, Summation summation, ThreadPool& pool)
+{
+    std::vector<R> sums(a.ColsCount());
+    internal_impl::AxisSums(pool, internal_impl::ToOperand(a), false, sums.data(), summation, false);
+    return sums;
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto ColSums(const A& a, Summation summation = Summation::Pairwise) { return ColSums(a, summation, ThreadPool::Default()); }
+
+//* max over the columns of the sum of the absolute values (the norm induced by the vector 1-norm)
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+R NormL1(const A& a, ThreadPool& pool)
+{
+    std::vector<R> sums(a.ColsCount());
+    internal_impl::AxisSums(pool, internal_impl::ToOperand(a), false, sums.data(), Summation::Plain, true);
+    return internal_impl::MaxSum_(sums);
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto NormL1(const A& a) { return NormL1(a, ThreadPool::Default()); }
+
+//* max over the rows of the sum of the absolute values (the norm induced by the vector infinity-norm)
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::is_arithmetic_v<R>
+R NormInf(const A& a, ThreadPool& pool)
+{
+    std::vector<R> sums(a.RowsCount());
+    internal_impl::AxisSums(pool, internal_impl::ToOperand(a), true, sums.data(), Summation::Plain, true);
+    return internal_impl::MaxSum_(sums);
+}
+
+template <internal_impl::MatrixLike A>
+requires std::is_arithmetic_v<internal_impl::ValueOf<A>>
+inline auto NormInf(const A& a) { return NormInf(a, ThreadPool::Default()); }
+
+//* sqrt of the sum of the squares, pairwise over the runs
+template <internal_impl::MatrixLike A, typename R = internal_impl::ValueOf<A>>
+requires std::floating_point<R>
+R NormFrobenius(const A& a, ThreadPool& pool)
+{
+    const auto operand{internal_impl::ToOperand(a)};
+    using Operand = std::remove_const_t<decltype(operand)>;
+    std::vector<R> partials(internal_impl::ReduceReader<R, Operand>{operand}.RunsCount());
+    internal_impl::ForEachRun<R>(pool, operand, [&](std::size_t run, std::span<const R> elements) {
+        partials[run] = internal_impl::simd::Dot(elements.data(), elements.data(), elements.size());
+    });
+    return std::sqrt(internal_impl::SumRun(partials.data(), partials.size(), Summation::Pairwise));
+}
+
+template <internal_impl::MatrixLike A>
+requires std::floating_point<internal_impl::ValueOf<A>>
+inline auto NormFrobenius(const A& a) { return NormFrobenius(a, ThreadPool::Default()); }
+
+} // namespace rage
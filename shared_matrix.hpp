@@ -0,0 +1,100 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+//* Matrices with copy-on-write storage, SharedMatrix<T> (opt-in: Matrix copies stay deep)
+//*
+//* Copies share one reference counted Matrix, so handing a matrix to several readers is O(1).
+//* Reads never copy. The first write through a copy whose buffer is shared (non-const At, Row, Col,
+//* RawData, Mutable, or Add/Scale/Multiply/Fill/Copy into it) clones the buffer first, then writes to the clone.
+//*
+//* Non-const accessors detach even when they are only used to read: read through a const object,
+//* std::as_const or View(). References, lines and views handed out for writing point into the buffer
+//* of the moment: a copy made after that shares the buffer they still write to, do not keep them around.
+//* The count is atomic, copies can live on different threads; a single SharedMatrix is not synchronized.
+//* A moved-from SharedMatrix can only be assigned to or destroyed.
+
+namespace rage {
+
+template <typename T, typename Alloc = AlignedAllocator<T>, typename Layout = RowMajor>
+class SharedMatrix
+{
+public:
+    using ValueType = T;
+    using MatrixType = Matrix<T, Alloc, Layout>;
+
+    explicit SharedMatrix(std::size_t rows, std::size_t cols) : matrix_{std::make_shared<MatrixType>(rows, cols)} {}
+
+    //* takes the buffer of m, no copy
+    explicit SharedMatrix(MatrixType&& m) : matrix_{std::make_shared<MatrixType>(std::move(m))} {}
+
+    explicit SharedMatrix(const MatrixType& m) : matrix_{std::make_shared<MatrixType>(m)} {}
+
+public:
+    //* whether another SharedMatrix holds the same buffer (the next write copies it)
+    bool IsShared() const { return matrix_.use_count() > 1; }
+
+    const MatrixType& Get() const { return *matrix_; }
+
+    //* the matrix for writing, first copied when it is shared
+    MatrixType& Mutable() {
+        if (IsShared())
+            matrix_ = std::make_shared<MatrixType>(std::as_const(*matrix_));
+        return *matrix_;
+    }
+
+    auto View() const { return Get().View(); }
+
+    std::size_t RowsCount() const { return matrix_->RowsCount(); }
+    std::size_t ColsCount() const { return matrix_->ColsCount(); }
+    std::size_t Size() const { return matrix_->Size(); }
+    std::size_t LeadingDimension() const { return matrix_->LeadingDimension(); }
+
+    const T& At(std::size_t r, std::size_t c) const { return Get().At(r, c); }
+    T& At(std::size_t r, std::size_t c) { return Mutable().At(r, c); }
+
+    auto Row(std::size_t r) const { return Get().Row(r); }
+    auto Row(std::size_t r) { return Mutable().Row(r); }
+
+    auto Col(std::size_t c) const { return Get().Col(c); }
+    auto Col(std::size_t c) { return Mutable().Col(c); }
+
+    const T* RawData() const { return Get().RawData(); }
+    T* RawData() { return Mutable().RawData(); }
+
+    //* rows, read-only
+    auto begin() const { return Get().begin(); }
+    auto end() const { return Get().end(); }
+
+    //* copies sharing a buffer are equal without looking at it
+    friend bool operator==(const SharedMatrix& lhs, const SharedMatrix& rhs) {
+        return lhs.matrix_ == rhs.matrix_ || lhs.Get() == rhs.Get();
+    }
+
+private:
+    std::shared_ptr<MatrixType> matrix_;
+};
+
+//*
+//* Destination passing into a SharedMatrix: a shared buffer is copied first, then overwritten
+//* (operands viewing the shared buffer stay valid, the other copies keep it alive)
+template <typename T, typename Alloc, typename Layout, typename... Args>
+inline void Add(SharedMatrix<T, Alloc, Layout>& out, Args&&... args) { Add(out.Mutable(), std::forward<Args>(args)...); }
+
+template <typename T, typename Alloc, typename Layout, typename... Args>
+inline void Scale(SharedMatrix<T, Alloc, Layout>& out, Args&&... args) { Scale(out.Mutable(), std::forward<Args>(args)...); }
+
+template <typename T, typename Alloc, typename Layout, typename... Args>
+inline void Multiply(SharedMatrix<T, Alloc, Layout>& out, Args&&... args) { Multiply(out.Mutable(), std::forward<Args>(args)...); }
+
+template <typename T, typename Alloc, typename Layout, typename... Args>
+inline void Fill(SharedMatrix<T, Alloc, Layout>& out, Args&&... args) { Fill(out.Mutable(), std::forward<Args>(args)...); }
+
+template <typename T, typename Alloc, typename Layout, typename... Args>
+inline void Copy(SharedMatrix<T, Alloc, Layout>& out, Args&&... args) { Copy(out.Mutable(), std::forward<Args>(args)...); }
+
+} // namespace rage
@@ -0,0 +1,1460 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define RAGE_SIMD_X86
+    #include <immintrin.h>
+#endif
+
+//* Element-wise kernels over flat buffers: out = a + b, out = a - b, out = a + val, out = a * val
+//* and the vector kernels of the matrix-vector product: Dot (a . b) and Axpy (y += alpha * x),
+//* FirstMismatch for the comparisons (early exit on the first vector holding a difference),
+//* Sum, SumAbs, KahanSum, Max and Min for the reductions (reduce.hpp)
+//*
+//* float and double get hand written SSE2/AVX2/AVX-512 loops, the widest one the CPU supports
+//* is picked at runtime (CPUID, once). Everything else uses the scalar loop, which the compiler
+//* is free to auto-vectorize for the build target.
+//* The strided overloads take a leading dimension per buffer: dense buffers are processed
+//* as one flat run, strided ones row by row.
+//*
+//* Transpose works on small blocks (the leaves of transpose.hpp) with register tiles: 4x4 floats and
+//* 2x2 doubles with SSE2, 8x8 floats and 4x4 doubles with AVX2. A transpose is bound by memory,
+//* not shuffles, so AVX-512 CPUs use the AVX2 tiles.
+
+namespace internal_impl::simd {
+
+enum class Isa { Scalar, SSE2, AVX2, AVX512 };
+
+inline Isa DetectIsa()
+{
+#ifdef RAGE_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return Isa::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return Isa::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return Isa::SSE2;
+#endif
+    return Isa::Scalar;
+}
+
+inline Isa& ActiveIsa_()
+{
+    static Isa isa{DetectIsa()};
+    return isa;
+}
+
+inline Isa ActiveIsa() { return ActiveIsa_(); }
+
+//* For tests and benchmarks, never goes above what the CPU supports
+inline void ForceIsa(Isa isa) { ActiveIsa_() = std::min(isa, DetectIsa()); }
+
+template <typename T>
+concept HasKernels = std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+//* dst (cols x rows) = src (rows x cols)^T, element by element, for the edges of the register tiles
+template <typename T>
+void TransposeScalar(const T* src, std::size_t lds, T* dst, std::size_t ldd, std::size_t rows, std::size_t cols)
+{
+    for (std::size_t r{0}; r < rows; ++r) {
+        for (std::size_t c{0}; c < cols; ++c)
+            dst[c * ldd + r] = src[r * lds + c];
+    }
+}
+
+template <typename T>
+T Abs_(T value)
+{
+    if constexpr (std::is_unsigned_v<T>)
+        return value;
+    else
+        return value < 0 ? static_cast<T>(-value) : value;
+}
+
+//* sum + compensation += value, the rounding error of the sum goes into compensation (Kahan-Babuska)
+template <typename T>
+void CompensatedAdd(T& sum, T& compensation, T value)
+{
+    const T total{sum + value};
+    if (Abs_(sum) >= Abs_(value))
+        compensation += (sum - total) + value;
+    else
+        compensation += (value - total) + sum;
+    sum = total;
+}
+
+//* what Max and Min return when there is nothing to compare
+template <bool Largest, typename T>
+constexpr T ExtremumStart()
+{
+    if constexpr (std::numeric_limits<T>::has_infinity)
+        return Largest ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+    else
+        return Largest ? std::numeric_limits<T>::lowest() : std::numeric_limits<T>::max();
+}
+
+//* value when it beats current, false for a NaN value
+template <bool Largest, typename T>
+T Keep_(T current, T value)
+{
+    if constexpr (Largest)
+        return value > current ? value : current;
+    else
+        return value < current ? value : current;
+}
+
+#ifdef RAGE_SIMD_X86
+namespace x86 {
+
+//*
+//* SSE2
+
+[[gnu::target("sse2")]] inline void Add_SSE2(const float* a, const float* b, float* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(out + i,     _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+[[gnu::target("sse2")]] inline void Add_SSE2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(out + i,     _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+[[gnu::target("sse2")]] inline void Sub_SSE2(const float* a, const float* b, float* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(out + i,     _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        _mm_storeu_ps(out + i + 4, _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    for (; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+[[gnu::target("sse2")]] inline void Sub_SSE2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(out + i,     _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        _mm_storeu_pd(out + i + 2, _mm_sub_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    for (; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+[[gnu::target("sse2")]] inline void AddValue_SSE2(const float* a, float val, float* out, std::size_t n) {
+    const auto v{_mm_set1_ps(val)};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(out + i,     _mm_add_ps(_mm_loadu_ps(a + i),     v));
+        _mm_storeu_ps(out + i + 4, _mm_add_ps(_mm_loadu_ps(a + i + 4), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] + val;
+}
+
+[[gnu::target("sse2")]] inline void AddValue_SSE2(const double* a, double val, double* out, std::size_t n) {
+    const auto v{_mm_set1_pd(val)};
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(out + i,     _mm_add_pd(_mm_loadu_pd(a + i),     v));
+        _mm_storeu_pd(out + i + 2, _mm_add_pd(_mm_loadu_pd(a + i + 2), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] + val;
+}
+
+[[gnu::target("sse2")]] inline void MulValue_SSE2(const float* a, float val, float* out, std::size_t n) {
+    const auto v{_mm_set1_ps(val)};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(out + i,     _mm_mul_ps(_mm_loadu_ps(a + i),     v));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_loadu_ps(a + i + 4), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] * val;
+}
+
+[[gnu::target("sse2")]] inline void MulValue_SSE2(const double* a, double val, double* out, std::size_t n) {
+    const auto v{_mm_set1_pd(val)};
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(out + i,     _mm_mul_pd(_mm_loadu_pd(a + i),     v));
+        _mm_storeu_pd(out + i + 2, _mm_mul_pd(_mm_loadu_pd(a + i + 2), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] * val;
+}
+
+//*
+//* AVX2
+
+[[gnu::target("avx2")]] inline void Add_AVX2(const float* a, const float* b, float* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(out + i,     _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        _mm256_storeu_ps(out + i + 8, _mm256_add_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+[[gnu::target("avx2")]] inline void Add_AVX2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(out + i,     _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        _mm256_storeu_pd(out + i + 4, _mm256_add_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+[[gnu::target("avx2")]] inline void Sub_AVX2(const float* a, const float* b, float* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(out + i,     _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        _mm256_storeu_ps(out + i + 8, _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    for (; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+[[gnu::target("avx2")]] inline void Sub_AVX2(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(out + i,     _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        _mm256_storeu_pd(out + i + 4, _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+    }
+    for (; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+[[gnu::target("avx2")]] inline void AddValue_AVX2(const float* a, float val, float* out, std::size_t n) {
+    const auto v{_mm256_set1_ps(val)};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(out + i,     _mm256_add_ps(_mm256_loadu_ps(a + i),     v));
+        _mm256_storeu_ps(out + i + 8, _mm256_add_ps(_mm256_loadu_ps(a + i + 8), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] + val;
+}
+
+[[gnu::target("avx2")]] inline void AddValue_AVX2(const double* a, double val, double* out, std::size_t n) {
+    const auto v{_mm256_set1_pd(val)};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(out + i,     _mm256_add_pd(_mm256_loadu_pd(a + i),     v));
+        _mm256_storeu_pd(out + i + 4, _mm256_add_pd(_mm256_loadu_pd(a + i + 4), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] + val;
+}
+
+[[gnu::target("avx2")]] inline void MulValue_AVX2(const float* a, float val, float* out, std::size_t n) {
+    const auto v{_mm256_set1_ps(val)};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(out + i,     _mm256_mul_ps(_mm256_loadu_ps(a + i),     v));
+        _mm256_storeu_ps(out + i + 8, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] * val;
+}
+
+[[gnu::target("avx2")]] inline void MulValue_AVX2(const double* a, double val, double* out, std::size_t n) {
+    const auto v{_mm256_set1_pd(val)};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(out + i,     _mm256_mul_pd(_mm256_loadu_pd(a + i),     v));
+        _mm256_storeu_pd(out + i + 4, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] * val;
+}
+
+//*
+//* AVX-512
+
+[[gnu::target("avx512f")]] inline void Add_AVX512(const float* a, const float* b, float* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        _mm512_storeu_ps(out + i,      _mm512_add_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        _mm512_storeu_ps(out + i + 16, _mm512_add_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16)));
+    }
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+[[gnu::target("avx512f")]] inline void Add_AVX512(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(out + i,     _mm512_add_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+        _mm512_storeu_pd(out + i + 8, _mm512_add_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8)));
+    }
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+[[gnu::target("avx512f")]] inline void Sub_AVX512(const float* a, const float* b, float* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        _mm512_storeu_ps(out + i,      _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        _mm512_storeu_ps(out + i + 16, _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16)));
+    }
+    for (; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+[[gnu::target("avx512f")]] inline void Sub_AVX512(const double* a, const double* b, double* out, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(out + i,     _mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+        _mm512_storeu_pd(out + i + 8, _mm512_sub_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8)));
+    }
+    for (; i < n; ++i) out[i] = a[i] - b[i];
+}
+
+[[gnu::target("avx512f")]] inline void AddValue_AVX512(const float* a, float val, float* out, std::size_t n) {
+    const auto v{_mm512_set1_ps(val)};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        _mm512_storeu_ps(out + i,      _mm512_add_ps(_mm512_loadu_ps(a + i),      v));
+        _mm512_storeu_ps(out + i + 16, _mm512_add_ps(_mm512_loadu_ps(a + i + 16), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] + val;
+}
+
+[[gnu::target("avx512f")]] inline void AddValue_AVX512(const double* a, double val, double* out, std::size_t n) {
+    const auto v{_mm512_set1_pd(val)};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(out + i,     _mm512_add_pd(_mm512_loadu_pd(a + i),     v));
+        _mm512_storeu_pd(out + i + 8, _mm512_add_pd(_mm512_loadu_pd(a + i + 8), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] + val;
+}
+
+[[gnu::target("avx512f")]] inline void MulValue_AVX512(const float* a, float val, float* out, std::size_t n) {
+    const auto v{_mm512_set1_ps(val)};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        _mm512_storeu_ps(out + i,      _mm512_mul_ps(_mm512_loadu_ps(a + i),      v));
+        _mm512_storeu_ps(out + i + 16, _mm512_mul_ps(_mm512_loadu_ps(a + i + 16), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] * val;
+}
+
+[[gnu::target("avx512f")]] inline void MulValue_AVX512(const double* a, double val, double* out, std::size_t n) {
+    const auto v{_mm512_set1_pd(val)};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(out + i,     _mm512_mul_pd(_mm512_loadu_pd(a + i),     v));
+        _mm512_storeu_pd(out + i + 8, _mm512_mul_pd(_mm512_loadu_pd(a + i + 8), v));
+    }
+    for (; i < n; ++i) out[i] = a[i] * val;
+}
+
+//*
+//* Dot and Axpy, Dot keeps four accumulators so the adds do not wait on each other
+
+[[gnu::target("sse2")]] inline float HorizontalSum_SSE2(__m128 v) {
+    const auto pairs{_mm_add_ps(v, _mm_movehl_ps(v, v))};
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+}
+
+[[gnu::target("sse2")]] inline double HorizontalSum_SSE2(__m128d v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+[[gnu::target("avx2")]] inline float HorizontalSum_AVX2(__m256 v) {
+    return HorizontalSum_SSE2(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+[[gnu::target("avx2")]] inline double HorizontalSum_AVX2(__m256d v) {
+    return HorizontalSum_SSE2(_mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1)));
+}
+
+//* through memory, the _mm512_reduce_add_* of some GCC versions trip -Wuninitialized
+[[gnu::target("avx512f")]] inline float HorizontalSum_AVX512(__m512 v) {
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, v);
+    return HorizontalSum_AVX2(_mm256_add_ps(_mm256_load_ps(lanes), _mm256_load_ps(lanes + 8)));
+}
+
+[[gnu::target("avx512f")]] inline double HorizontalSum_AVX512(__m512d v) {
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, v);
+    return HorizontalSum_AVX2(_mm256_add_pd(_mm256_load_pd(lanes), _mm256_load_pd(lanes + 4)));
+}
+
+[[gnu::target("sse2")]] inline float Dot_SSE2(const float* a, const float* b, std::size_t n) {
+    auto acc0{_mm_setzero_ps()}, acc1{_mm_setzero_ps()}, acc2{_mm_setzero_ps()}, acc3{_mm_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a + i + 8), _mm_loadu_ps(b + i + 8)));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a + i + 12), _mm_loadu_ps(b + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4)
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    float total{HorizontalSum_SSE2(_mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)))};
+    for (; i < n; ++i) total += a[i] * b[i];
+    return total;
+}
+
+[[gnu::target("sse2")]] inline void Axpy_SSE2(float alpha, const float* x, float* y, std::size_t n) {
+    const auto v{_mm_set1_ps(alpha)};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(v, _mm_loadu_ps(x + i))));
+        _mm_storeu_ps(y + i + 4, _mm_add_ps(_mm_loadu_ps(y + i + 4), _mm_mul_ps(v, _mm_loadu_ps(x + i + 4))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+[[gnu::target("sse2")]] inline double Dot_SSE2(const double* a, const double* b, std::size_t n) {
+    auto acc0{_mm_setzero_pd()}, acc1{_mm_setzero_pd()}, acc2{_mm_setzero_pd()}, acc3{_mm_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        acc2 = _mm_add_pd(acc2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+        acc3 = _mm_add_pd(acc3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+    }
+    for (; i + 2 <= n; i += 2)
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    double total{HorizontalSum_SSE2(_mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3)))};
+    for (; i < n; ++i) total += a[i] * b[i];
+    return total;
+}
+
+[[gnu::target("sse2")]] inline void Axpy_SSE2(double alpha, const double* x, double* y, std::size_t n) {
+    const auto v{_mm_set1_pd(alpha)};
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(v, _mm_loadu_pd(x + i))));
+        _mm_storeu_pd(y + i + 2, _mm_add_pd(_mm_loadu_pd(y + i + 2), _mm_mul_pd(v, _mm_loadu_pd(x + i + 2))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+[[gnu::target("avx2")]] inline float Dot_AVX2(const float* a, const float* b, std::size_t n) {
+    auto acc0{_mm256_setzero_ps()}, acc1{_mm256_setzero_ps()}, acc2{_mm256_setzero_ps()}, acc3{_mm256_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+        acc2 = _mm256_add_ps(acc2, _mm256_mul_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16)));
+        acc3 = _mm256_add_ps(acc3, _mm256_mul_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24)));
+    }
+    for (; i + 8 <= n; i += 8)
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    float total{HorizontalSum_AVX2(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)))};
+    for (; i < n; ++i) total += a[i] * b[i];
+    return total;
+}
+
+[[gnu::target("avx2")]] inline void Axpy_AVX2(float alpha, const float* x, float* y, std::size_t n) {
+    const auto v{_mm256_set1_ps(alpha)};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(v, _mm256_loadu_ps(x + i))));
+        _mm256_storeu_ps(y + i + 8, _mm256_add_ps(_mm256_loadu_ps(y + i + 8), _mm256_mul_ps(v, _mm256_loadu_ps(x + i + 8))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+[[gnu::target("avx2")]] inline double Dot_AVX2(const double* a, const double* b, std::size_t n) {
+    auto acc0{_mm256_setzero_pd()}, acc1{_mm256_setzero_pd()}, acc2{_mm256_setzero_pd()}, acc3{_mm256_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+        acc2 = _mm256_add_pd(acc2, _mm256_mul_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8)));
+        acc3 = _mm256_add_pd(acc3, _mm256_mul_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12)));
+    }
+    for (; i + 4 <= n; i += 4)
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    double total{HorizontalSum_AVX2(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)))};
+    for (; i < n; ++i) total += a[i] * b[i];
+    return total;
+}
+
+[[gnu::target("avx2")]] inline void Axpy_AVX2(double alpha, const double* x, double* y, std::size_t n) {
+    const auto v{_mm256_set1_pd(alpha)};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(v, _mm256_loadu_pd(x + i))));
+        _mm256_storeu_pd(y + i + 4, _mm256_add_pd(_mm256_loadu_pd(y + i + 4), _mm256_mul_pd(v, _mm256_loadu_pd(x + i + 4))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+[[gnu::target("avx512f")]] inline float Dot_AVX512(const float* a, const float* b, std::size_t n) {
+    auto acc0{_mm512_setzero_ps()}, acc1{_mm512_setzero_ps()}, acc2{_mm512_setzero_ps()}, acc3{_mm512_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 64 <= n; i += 64) {
+        acc0 = _mm512_add_ps(acc0, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        acc1 = _mm512_add_ps(acc1, _mm512_mul_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16)));
+        acc2 = _mm512_add_ps(acc2, _mm512_mul_ps(_mm512_loadu_ps(a + i + 32), _mm512_loadu_ps(b + i + 32)));
+        acc3 = _mm512_add_ps(acc3, _mm512_mul_ps(_mm512_loadu_ps(a + i + 48), _mm512_loadu_ps(b + i + 48)));
+    }
+    for (; i + 16 <= n; i += 16)
+        acc0 = _mm512_add_ps(acc0, _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    float total{HorizontalSum_AVX512(_mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)))};
+    for (; i < n; ++i) total += a[i] * b[i];
+    return total;
+}
+
+[[gnu::target("avx512f")]] inline void Axpy_AVX512(float alpha, const float* x, float* y, std::size_t n) {
+    const auto v{_mm512_set1_ps(alpha)};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        _mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(v, _mm512_loadu_ps(x + i))));
+        _mm512_storeu_ps(y + i + 16, _mm512_add_ps(_mm512_loadu_ps(y + i + 16), _mm512_mul_ps(v, _mm512_loadu_ps(x + i + 16))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+[[gnu::target("avx512f")]] inline double Dot_AVX512(const double* a, const double* b, std::size_t n) {
+    auto acc0{_mm512_setzero_pd()}, acc1{_mm512_setzero_pd()}, acc2{_mm512_setzero_pd()}, acc3{_mm512_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+        acc1 = _mm512_add_pd(acc1, _mm512_mul_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8)));
+        acc2 = _mm512_add_pd(acc2, _mm512_mul_pd(_mm512_loadu_pd(a + i + 16), _mm512_loadu_pd(b + i + 16)));
+        acc3 = _mm512_add_pd(acc3, _mm512_mul_pd(_mm512_loadu_pd(a + i + 24), _mm512_loadu_pd(b + i + 24)));
+    }
+    for (; i + 8 <= n; i += 8)
+        acc0 = _mm512_add_pd(acc0, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+    double total{HorizontalSum_AVX512(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)))};
+    for (; i < n; ++i) total += a[i] * b[i];
+    return total;
+}
+
+[[gnu::target("avx512f")]] inline void Axpy_AVX512(double alpha, const double* x, double* y, std::size_t n) {
+    const auto v{_mm512_set1_pd(alpha)};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_pd(y + i, _mm512_add_pd(_mm512_loadu_pd(y + i), _mm512_mul_pd(v, _mm512_loadu_pd(x + i))));
+        _mm512_storeu_pd(y + i + 8, _mm512_add_pd(_mm512_loadu_pd(y + i + 8), _mm512_mul_pd(v, _mm512_loadu_pd(x + i + 8))));
+    }
+    for (; i < n; ++i) y[i] += alpha * x[i];
+}
+
+//*
+//* First mismatch: the index of the first lanes that do not compare equal (ordered compare, so NaN != NaN)
+
+[[gnu::target("sse2")]] inline std::size_t FirstMismatch_SSE2(const float* a, const float* b, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        const auto equal{static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i))))};
+        if (equal != 0xFu) return i + static_cast<std::size_t>(__builtin_ctz(~equal));
+    }
+    for (; i < n; ++i) if (!(a[i] == b[i])) return i;
+    return n;
+}
+
+[[gnu::target("sse2")]] inline std::size_t FirstMismatch_SSE2(const double* a, const double* b, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 2 <= n; i += 2) {
+        const auto equal{static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))))};
+        if (equal != 0x3u) return i + static_cast<std::size_t>(__builtin_ctz(~equal));
+    }
+    for (; i < n; ++i) if (!(a[i] == b[i])) return i;
+    return n;
+}
+
+[[gnu::target("avx2")]] inline std::size_t FirstMismatch_AVX2(const float* a, const float* b, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        const auto equal{static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_EQ_OQ)))};
+        if (equal != 0xFFu) return i + static_cast<std::size_t>(__builtin_ctz(~equal));
+    }
+    for (; i < n; ++i) if (!(a[i] == b[i])) return i;
+    return n;
+}
+
+[[gnu::target("avx2")]] inline std::size_t FirstMismatch_AVX2(const double* a, const double* b, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        const auto equal{static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_EQ_OQ)))};
+        if (equal != 0xFu) return i + static_cast<std::size_t>(__builtin_ctz(~equal));
+    }
+    for (; i < n; ++i) if (!(a[i] == b[i])) return i;
+    return n;
+}
+
+[[gnu::target("avx512f")]] inline std::size_t FirstMismatch_AVX512(const float* a, const float* b, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        const auto equal{static_cast<unsigned>(_mm512_cmp_ps_mask(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), _CMP_EQ_OQ))};
+        if (equal != 0xFFFFu) return i + static_cast<std::size_t>(__builtin_ctz(~equal));
+    }
+    for (; i < n; ++i) if (!(a[i] == b[i])) return i;
+    return n;
+}
+
+[[gnu::target("avx512f")]] inline std::size_t FirstMismatch_AVX512(const double* a, const double* b, std::size_t n) {
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        const auto equal{static_cast<unsigned>(_mm512_cmp_pd_mask(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), _CMP_EQ_OQ))};
+        if (equal != 0xFFu) return i + static_cast<std::size_t>(__builtin_ctz(~equal));
+    }
+    for (; i < n; ++i) if (!(a[i] == b[i])) return i;
+    return n;
+}
+
+//*
+//* Reductions: Sum and SumAbs keep four accumulators like Dot, KahanSum two compensated pairs,
+//* Max and Min put the loaded vector first: maxps/minps return the second operand when one is NaN, so NaNs are skipped
+
+template <bool Abs> [[gnu::target("sse2")]] inline __m128 Load_SSE2(const float* p) {
+    if constexpr (Abs) return _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_loadu_ps(p));
+    else return _mm_loadu_ps(p);
+}
+
+template <bool Largest> [[gnu::target("sse2")]] inline __m128 Keep_SSE2(__m128 x, __m128 acc) {
+    if constexpr (Largest) return _mm_max_ps(x, acc);
+    else return _mm_min_ps(x, acc);
+}
+
+template <bool Abs> [[gnu::target("sse2")]] inline float Sum_SSE2(const float* a, std::size_t n) {
+    auto acc0{_mm_setzero_ps()}, acc1{_mm_setzero_ps()}, acc2{_mm_setzero_ps()}, acc3{_mm_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm_add_ps(acc0, Load_SSE2<Abs>(a + i));
+        acc1 = _mm_add_ps(acc1, Load_SSE2<Abs>(a + i + 4));
+        acc2 = _mm_add_ps(acc2, Load_SSE2<Abs>(a + i + 8));
+        acc3 = _mm_add_ps(acc3, Load_SSE2<Abs>(a + i + 12));
+    }
+    for (; i + 4 <= n; i += 4)
+        acc0 = _mm_add_ps(acc0, Load_SSE2<Abs>(a + i));
+    float total{HorizontalSum_SSE2(_mm_add_ps(_mm_add_ps(acc0, acc1), _mm_add_ps(acc2, acc3)))};
+    for (; i < n; ++i) total += Abs ? Abs_(a[i]) : a[i];
+    return total;
+}
+
+[[gnu::target("sse2")]] inline float KahanSum_SSE2(const float* a, std::size_t n) {
+    auto sum0{_mm_setzero_ps()}, sum1{_mm_setzero_ps()}, comp0{_mm_setzero_ps()}, comp1{_mm_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        const auto y0{_mm_sub_ps(_mm_loadu_ps(a + i), comp0)};
+        const auto y1{_mm_sub_ps(_mm_loadu_ps(a + i + 4), comp1)};
+        const auto t0{_mm_add_ps(sum0, y0)};
+        const auto t1{_mm_add_ps(sum1, y1)};
+        comp0 = _mm_sub_ps(_mm_sub_ps(t0, sum0), y0);
+        comp1 = _mm_sub_ps(_mm_sub_ps(t1, sum1), y1);
+        sum0 = t0;
+        sum1 = t1;
+    }
+    alignas(64) float sums[8];
+    alignas(64) float comps[8];
+    _mm_store_ps(sums, sum0);
+    _mm_store_ps(sums + 4, sum1);
+    _mm_store_ps(comps, comp0);
+    _mm_store_ps(comps + 4, comp1);
+    float total{0}, compensation{0};
+    for (std::size_t lane{0}; lane < 8; ++lane) {
+        CompensatedAdd(total, compensation, sums[lane]);
+        CompensatedAdd(total, compensation, -comps[lane]);
+    }
+    for (; i < n; ++i) CompensatedAdd(total, compensation, a[i]);
+    return total + compensation;
+}
+
+template <bool Largest> [[gnu::target("sse2")]] inline float Extremum_SSE2(const float* a, std::size_t n) {
+    const auto start{_mm_set1_ps(ExtremumStart<Largest, float>())};
+    auto acc0{start}, acc1{start}, acc2{start}, acc3{start};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        acc0 = Keep_SSE2<Largest>(_mm_loadu_ps(a + i), acc0);
+        acc1 = Keep_SSE2<Largest>(_mm_loadu_ps(a + i + 4), acc1);
+        acc2 = Keep_SSE2<Largest>(_mm_loadu_ps(a + i + 8), acc2);
+        acc3 = Keep_SSE2<Largest>(_mm_loadu_ps(a + i + 12), acc3);
+    }
+    for (; i + 4 <= n; i += 4)
+        acc0 = Keep_SSE2<Largest>(_mm_loadu_ps(a + i), acc0);
+    alignas(64) float lanes[4];
+    _mm_store_ps(lanes, Keep_SSE2<Largest>(Keep_SSE2<Largest>(acc0, acc1), Keep_SSE2<Largest>(acc2, acc3)));
+    float best{lanes[0]};
+    for (std::size_t lane{1}; lane < 4; ++lane) best = Keep_<Largest>(best, lanes[lane]);
+    for (; i < n; ++i) best = Keep_<Largest>(best, a[i]);
+    return best;
+}
+
+template <bool Abs> [[gnu::target("sse2")]] inline __m128d Load_SSE2(const double* p) {
+    if constexpr (Abs) return _mm_andnot_pd(_mm_set1_pd(-0.0), _mm_loadu_pd(p));
+    else return _mm_loadu_pd(p);
+}
+
+template <bool Largest> [[gnu::target("sse2")]] inline __m128d Keep_SSE2(__m128d x, __m128d acc) {
+    if constexpr (Largest) return _mm_max_pd(x, acc);
+    else return _mm_min_pd(x, acc);
+}
+
+template <bool Abs> [[gnu::target("sse2")]] inline double Sum_SSE2(const double* a, std::size_t n) {
+    auto acc0{_mm_setzero_pd()}, acc1{_mm_setzero_pd()}, acc2{_mm_setzero_pd()}, acc3{_mm_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_pd(acc0, Load_SSE2<Abs>(a + i));
+        acc1 = _mm_add_pd(acc1, Load_SSE2<Abs>(a + i + 2));
+        acc2 = _mm_add_pd(acc2, Load_SSE2<Abs>(a + i + 4));
+        acc3 = _mm_add_pd(acc3, Load_SSE2<Abs>(a + i + 6));
+    }
+    for (; i + 2 <= n; i += 2)
+        acc0 = _mm_add_pd(acc0, Load_SSE2<Abs>(a + i));
+    double total{HorizontalSum_SSE2(_mm_add_pd(_mm_add_pd(acc0, acc1), _mm_add_pd(acc2, acc3)))};
+    for (; i < n; ++i) total += Abs ? Abs_(a[i]) : a[i];
+    return total;
+}
+
+[[gnu::target("sse2")]] inline double KahanSum_SSE2(const double* a, std::size_t n) {
+    auto sum0{_mm_setzero_pd()}, sum1{_mm_setzero_pd()}, comp0{_mm_setzero_pd()}, comp1{_mm_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        const auto y0{_mm_sub_pd(_mm_loadu_pd(a + i), comp0)};
+        const auto y1{_mm_sub_pd(_mm_loadu_pd(a + i + 2), comp1)};
+        const auto t0{_mm_add_pd(sum0, y0)};
+        const auto t1{_mm_add_pd(sum1, y1)};
+        comp0 = _mm_sub_pd(_mm_sub_pd(t0, sum0), y0);
+        comp1 = _mm_sub_pd(_mm_sub_pd(t1, sum1), y1);
+        sum0 = t0;
+        sum1 = t1;
+    }
+    alignas(64) double sums[4];
+    alignas(64) double comps[4];
+    _mm_store_pd(sums, sum0);
+    _mm_store_pd(sums + 2, sum1);
+    _mm_store_pd(comps, comp0);
+    _mm_store_pd(comps + 2, comp1);
+    double total{0}, compensation{0};
+    for (std::size_t lane{0}; lane < 4; ++lane) {
+        CompensatedAdd(total, compensation, sums[lane]);
+        CompensatedAdd(total, compensation, -comps[lane]);
+    }
+    for (; i < n; ++i) CompensatedAdd(total, compensation, a[i]);
+    return total + compensation;
+}
+
+template <bool Largest> [[gnu::target("sse2")]] inline double Extremum_SSE2(const double* a, std::size_t n) {
+    const auto start{_mm_set1_pd(ExtremumStart<Largest, double>())};
+    auto acc0{start}, acc1{start}, acc2{start}, acc3{start};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        acc0 = Keep_SSE2<Largest>(_mm_loadu_pd(a + i), acc0);
+        acc1 = Keep_SSE2<Largest>(_mm_loadu_pd(a + i + 2), acc1);
+        acc2 = Keep_SSE2<Largest>(_mm_loadu_pd(a + i + 4), acc2);
+        acc3 = Keep_SSE2<Largest>(_mm_loadu_pd(a + i + 6), acc3);
+    }
+    for (; i + 2 <= n; i += 2)
+        acc0 = Keep_SSE2<Largest>(_mm_loadu_pd(a + i), acc0);
+    alignas(64) double lanes[2];
+    _mm_store_pd(lanes, Keep_SSE2<Largest>(Keep_SSE2<Largest>(acc0, acc1), Keep_SSE2<Largest>(acc2, acc3)));
+    double best{lanes[0]};
+    for (std::size_t lane{1}; lane < 2; ++lane) best = Keep_<Largest>(best, lanes[lane]);
+    for (; i < n; ++i) best = Keep_<Largest>(best, a[i]);
+    return best;
+}
+
+template <bool Abs> [[gnu::target("avx2")]] inline __m256 Load_AVX2(const float* p) {
+    if constexpr (Abs) return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_loadu_ps(p));
+    else return _mm256_loadu_ps(p);
+}
+
+template <bool Largest> [[gnu::target("avx2")]] inline __m256 Keep_AVX2(__m256 x, __m256 acc) {
+    if constexpr (Largest) return _mm256_max_ps(x, acc);
+    else return _mm256_min_ps(x, acc);
+}
+
+template <bool Abs> [[gnu::target("avx2")]] inline float Sum_AVX2(const float* a, std::size_t n) {
+    auto acc0{_mm256_setzero_ps()}, acc1{_mm256_setzero_ps()}, acc2{_mm256_setzero_ps()}, acc3{_mm256_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_add_ps(acc0, Load_AVX2<Abs>(a + i));
+        acc1 = _mm256_add_ps(acc1, Load_AVX2<Abs>(a + i + 8));
+        acc2 = _mm256_add_ps(acc2, Load_AVX2<Abs>(a + i + 16));
+        acc3 = _mm256_add_ps(acc3, Load_AVX2<Abs>(a + i + 24));
+    }
+    for (; i + 8 <= n; i += 8)
+        acc0 = _mm256_add_ps(acc0, Load_AVX2<Abs>(a + i));
+    float total{HorizontalSum_AVX2(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)))};
+    for (; i < n; ++i) total += Abs ? Abs_(a[i]) : a[i];
+    return total;
+}
+
+[[gnu::target("avx2")]] inline float KahanSum_AVX2(const float* a, std::size_t n) {
+    auto sum0{_mm256_setzero_ps()}, sum1{_mm256_setzero_ps()}, comp0{_mm256_setzero_ps()}, comp1{_mm256_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        const auto y0{_mm256_sub_ps(_mm256_loadu_ps(a + i), comp0)};
+        const auto y1{_mm256_sub_ps(_mm256_loadu_ps(a + i + 8), comp1)};
+        const auto t0{_mm256_add_ps(sum0, y0)};
+        const auto t1{_mm256_add_ps(sum1, y1)};
+        comp0 = _mm256_sub_ps(_mm256_sub_ps(t0, sum0), y0);
+        comp1 = _mm256_sub_ps(_mm256_sub_ps(t1, sum1), y1);
+        sum0 = t0;
+        sum1 = t1;
+    }
+    alignas(64) float sums[16];
+    alignas(64) float comps[16];
+    _mm256_store_ps(sums, sum0);
+    _mm256_store_ps(sums + 8, sum1);
+    _mm256_store_ps(comps, comp0);
+    _mm256_store_ps(comps + 8, comp1);
+    float total{0}, compensation{0};
+    for (std::size_t lane{0}; lane < 16; ++lane) {
+        CompensatedAdd(total, compensation, sums[lane]);
+        CompensatedAdd(total, compensation, -comps[lane]);
+    }
+    for (; i < n; ++i) CompensatedAdd(total, compensation, a[i]);
+    return total + compensation;
+}
+
+template <bool Largest> [[gnu::target("avx2")]] inline float Extremum_AVX2(const float* a, std::size_t n) {
+    const auto start{_mm256_set1_ps(ExtremumStart<Largest, float>())};
+    auto acc0{start}, acc1{start}, acc2{start}, acc3{start};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        acc0 = Keep_AVX2<Largest>(_mm256_loadu_ps(a + i), acc0);
+        acc1 = Keep_AVX2<Largest>(_mm256_loadu_ps(a + i + 8), acc1);
+        acc2 = Keep_AVX2<Largest>(_mm256_loadu_ps(a + i + 16), acc2);
+        acc3 = Keep_AVX2<Largest>(_mm256_loadu_ps(a + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8)
+        acc0 = Keep_AVX2<Largest>(_mm256_loadu_ps(a + i), acc0);
+    alignas(64) float lanes[8];
+    _mm256_store_ps(lanes, Keep_AVX2<Largest>(Keep_AVX2<Largest>(acc0, acc1), Keep_AVX2<Largest>(acc2, acc3)));
+    float best{lanes[0]};
+    for (std::size_t lane{1}; lane < 8; ++lane) best = Keep_<Largest>(best, lanes[lane]);
+    for (; i < n; ++i) best = Keep_<Largest>(best, a[i]);
+    return best;
+}
+
+template <bool Abs> [[gnu::target("avx2")]] inline __m256d Load_AVX2(const double* p) {
+    if constexpr (Abs) return _mm256_andnot_pd(_mm256_set1_pd(-0.0), _mm256_loadu_pd(p));
+    else return _mm256_loadu_pd(p);
+}
+
+template <bool Largest> [[gnu::target("avx2")]] inline __m256d Keep_AVX2(__m256d x, __m256d acc) {
+    if constexpr (Largest) return _mm256_max_pd(x, acc);
+    else return _mm256_min_pd(x, acc);
+}
+
+template <bool Abs> [[gnu::target("avx2")]] inline double Sum_AVX2(const double* a, std::size_t n) {
+    auto acc0{_mm256_setzero_pd()}, acc1{_mm256_setzero_pd()}, acc2{_mm256_setzero_pd()}, acc3{_mm256_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_pd(acc0, Load_AVX2<Abs>(a + i));
+        acc1 = _mm256_add_pd(acc1, Load_AVX2<Abs>(a + i + 4));
+        acc2 = _mm256_add_pd(acc2, Load_AVX2<Abs>(a + i + 8));
+        acc3 = _mm256_add_pd(acc3, Load_AVX2<Abs>(a + i + 12));
+    }
+    for (; i + 4 <= n; i += 4)
+        acc0 = _mm256_add_pd(acc0, Load_AVX2<Abs>(a + i));
+    double total{HorizontalSum_AVX2(_mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3)))};
+    for (; i < n; ++i) total += Abs ? Abs_(a[i]) : a[i];
+    return total;
+}
+
+[[gnu::target("avx2")]] inline double KahanSum_AVX2(const double* a, std::size_t n) {
+    auto sum0{_mm256_setzero_pd()}, sum1{_mm256_setzero_pd()}, comp0{_mm256_setzero_pd()}, comp1{_mm256_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 8 <= n; i += 8) {
+        const auto y0{_mm256_sub_pd(_mm256_loadu_pd(a + i), comp0)};
+        const auto y1{_mm256_sub_pd(_mm256_loadu_pd(a + i + 4), comp1)};
+        const auto t0{_mm256_add_pd(sum0, y0)};
+        const auto t1{_mm256_add_pd(sum1, y1)};
+        comp0 = _mm256_sub_pd(_mm256_sub_pd(t0, sum0), y0);
+        comp1 = _mm256_sub_pd(_mm256_sub_pd(t1, sum1), y1);
+        sum0 = t0;
+        sum1 = t1;
+    }
+    alignas(64) double sums[8];
+    alignas(64) double comps[8];
+    _mm256_store_pd(sums, sum0);
+    _mm256_store_pd(sums + 4, sum1);
+    _mm256_store_pd(comps, comp0);
+    _mm256_store_pd(comps + 4, comp1);
+    double total{0}, compensation{0};
+    for (std::size_t lane{0}; lane < 8; ++lane) {
+        CompensatedAdd(total, compensation, sums[lane]);
+        CompensatedAdd(total, compensation, -comps[lane]);
+    }
+    for (; i < n; ++i) CompensatedAdd(total, compensation, a[i]);
+    return total + compensation;
+}
+
+template <bool Largest> [[gnu::target("avx2")]] inline double Extremum_AVX2(const double* a, std::size_t n) {
+    const auto start{_mm256_set1_pd(ExtremumStart<Largest, double>())};
+    auto acc0{start}, acc1{start}, acc2{start}, acc3{start};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        acc0 = Keep_AVX2<Largest>(_mm256_loadu_pd(a + i), acc0);
+        acc1 = Keep_AVX2<Largest>(_mm256_loadu_pd(a + i + 4), acc1);
+        acc2 = Keep_AVX2<Largest>(_mm256_loadu_pd(a + i + 8), acc2);
+        acc3 = Keep_AVX2<Largest>(_mm256_loadu_pd(a + i + 12), acc3);
+    }
+    for (; i + 4 <= n; i += 4)
+        acc0 = Keep_AVX2<Largest>(_mm256_loadu_pd(a + i), acc0);
+    alignas(64) double lanes[4];
+    _mm256_store_pd(lanes, Keep_AVX2<Largest>(Keep_AVX2<Largest>(acc0, acc1), Keep_AVX2<Largest>(acc2, acc3)));
+    double best{lanes[0]};
+    for (std::size_t lane{1}; lane < 4; ++lane) best = Keep_<Largest>(best, lanes[lane]);
+    for (; i < n; ++i) best = Keep_<Largest>(best, a[i]);
+    return best;
+}
+
+template <bool Abs> [[gnu::target("avx512f")]] inline __m512 Load_AVX512(const float* p) {
+    if constexpr (Abs) return _mm512_abs_ps(_mm512_loadu_ps(p));
+    else return _mm512_loadu_ps(p);
+}
+
+//* the masked forms, the plain _mm512_max/min_* of some GCC versions trip -Wuninitialized
+template <bool Largest> [[gnu::target("avx512f")]] inline __m512 Keep_AVX512(__m512 x, __m512 acc) {
+    if constexpr (Largest) return _mm512_mask_max_ps(acc, 0xFFFF, x, acc);
+    else return _mm512_mask_min_ps(acc, 0xFFFF, x, acc);
+}
+
+template <bool Abs> [[gnu::target("avx512f")]] inline float Sum_AVX512(const float* a, std::size_t n) {
+    auto acc0{_mm512_setzero_ps()}, acc1{_mm512_setzero_ps()}, acc2{_mm512_setzero_ps()}, acc3{_mm512_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 64 <= n; i += 64) {
+        acc0 = _mm512_add_ps(acc0, Load_AVX512<Abs>(a + i));
+        acc1 = _mm512_add_ps(acc1, Load_AVX512<Abs>(a + i + 16));
+        acc2 = _mm512_add_ps(acc2, Load_AVX512<Abs>(a + i + 32));
+        acc3 = _mm512_add_ps(acc3, Load_AVX512<Abs>(a + i + 48));
+    }
+    for (; i + 16 <= n; i += 16)
+        acc0 = _mm512_add_ps(acc0, Load_AVX512<Abs>(a + i));
+    float total{HorizontalSum_AVX512(_mm512_add_ps(_mm512_add_ps(acc0, acc1), _mm512_add_ps(acc2, acc3)))};
+    for (; i < n; ++i) total += Abs ? Abs_(a[i]) : a[i];
+    return total;
+}
+
+[[gnu::target("avx512f")]] inline float KahanSum_AVX512(const float* a, std::size_t n) {
+    auto sum0{_mm512_setzero_ps()}, sum1{_mm512_setzero_ps()}, comp0{_mm512_setzero_ps()}, comp1{_mm512_setzero_ps()};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        const auto y0{_mm512_sub_ps(_mm512_loadu_ps(a + i), comp0)};
+        const auto y1{_mm512_sub_ps(_mm512_loadu_ps(a + i + 16), comp1)};
+        const auto t0{_mm512_add_ps(sum0, y0)};
+        const auto t1{_mm512_add_ps(sum1, y1)};
+        comp0 = _mm512_sub_ps(_mm512_sub_ps(t0, sum0), y0);
+        comp1 = _mm512_sub_ps(_mm512_sub_ps(t1, sum1), y1);
+        sum0 = t0;
+        sum1 = t1;
+    }
+    alignas(64) float sums[32];
+    alignas(64) float comps[32];
+    _mm512_store_ps(sums, sum0);
+    _mm512_store_ps(sums + 16, sum1);
+    _mm512_store_ps(comps, comp0);
+    _mm512_store_ps(comps + 16, comp1);
+    float total{0}, compensation{0};
+    for (std::size_t lane{0}; lane < 32; ++lane) {
+        CompensatedAdd(total, compensation, sums[lane]);
+        CompensatedAdd(total, compensation, -comps[lane]);
+    }
+    for (; i < n; ++i) CompensatedAdd(total, compensation, a[i]);
+    return total + compensation;
+}
+
+template <bool Largest> [[gnu::target("avx512f")]] inline float Extremum_AVX512(const float* a, std::size_t n) {
+    const auto start{_mm512_set1_ps(ExtremumStart<Largest, float>())};
+    auto acc0{start}, acc1{start}, acc2{start}, acc3{start};
+    std::size_t i{0};
+    for (; i + 64 <= n; i += 64) {
+        acc0 = Keep_AVX512<Largest>(_mm512_loadu_ps(a + i), acc0);
+        acc1 = Keep_AVX512<Largest>(_mm512_loadu_ps(a + i + 16), acc1);
+        acc2 = Keep_AVX512<Largest>(_mm512_loadu_ps(a + i + 32), acc2);
+        acc3 = Keep_AVX512<Largest>(_mm512_loadu_ps(a + i + 48), acc3);
+    }
+    for (; i + 16 <= n; i += 16)
+        acc0 = Keep_AVX512<Largest>(_mm512_loadu_ps(a + i), acc0);
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, Keep_AVX512<Largest>(Keep_AVX512<Largest>(acc0, acc1), Keep_AVX512<Largest>(acc2, acc3)));
+    float best{lanes[0]};
+    for (std::size_t lane{1}; lane < 16; ++lane) best = Keep_<Largest>(best, lanes[lane]);
+    for (; i < n; ++i) best = Keep_<Largest>(best, a[i]);
+    return best;
+}
+
+template <bool Abs> [[gnu::target("avx512f")]] inline __m512d Load_AVX512(const double* p) {
+    if constexpr (Abs) return _mm512_abs_pd(_mm512_loadu_pd(p));
+    else return _mm512_loadu_pd(p);
+}
+
+//* the masked forms, the plain _mm512_max/min_* of some GCC versions trip -Wuninitialized
+template <bool Largest> [[gnu::target("avx512f")]] inline __m512d Keep_AVX512(__m512d x, __m512d acc) {
+    if constexpr (Largest) return _mm512_mask_max_pd(acc, 0xFF, x, acc);
+    else return _mm512_mask_min_pd(acc, 0xFF, x, acc);
+}
+
+template <bool Abs> [[gnu::target("avx512f")]] inline double Sum_AVX512(const double* a, std::size_t n) {
+    auto acc0{_mm512_setzero_pd()}, acc1{_mm512_setzero_pd()}, acc2{_mm512_setzero_pd()}, acc3{_mm512_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_add_pd(acc0, Load_AVX512<Abs>(a + i));
+        acc1 = _mm512_add_pd(acc1, Load_AVX512<Abs>(a + i + 8));
+        acc2 = _mm512_add_pd(acc2, Load_AVX512<Abs>(a + i + 16));
+        acc3 = _mm512_add_pd(acc3, Load_AVX512<Abs>(a + i + 24));
+    }
+    for (; i + 8 <= n; i += 8)
+        acc0 = _mm512_add_pd(acc0, Load_AVX512<Abs>(a + i));
+    double total{HorizontalSum_AVX512(_mm512_add_pd(_mm512_add_pd(acc0, acc1), _mm512_add_pd(acc2, acc3)))};
+    for (; i < n; ++i) total += Abs ? Abs_(a[i]) : a[i];
+    return total;
+}
+
+[[gnu::target("avx512f")]] inline double KahanSum_AVX512(const double* a, std::size_t n) {
+    auto sum0{_mm512_setzero_pd()}, sum1{_mm512_setzero_pd()}, comp0{_mm512_setzero_pd()}, comp1{_mm512_setzero_pd()};
+    std::size_t i{0};
+    for (; i + 16 <= n; i += 16) {
+        const auto y0{_mm512_sub_pd(_mm512_loadu_pd(a + i), comp0)};
+        const auto y1{_mm512_sub_pd(_mm512_loadu_pd(a + i + 8), comp1)};
+        const auto t0{_mm512_add_pd(sum0, y0)};
+        const auto t1{_mm512_add_pd(sum1, y1)};
+        comp0 = _mm512_sub_pd(_mm512_sub_pd(t0, sum0), y0);
+        comp1 = _mm512_sub_pd(_mm512_sub_pd(t1, sum1), y1);
+        sum0 = t0;
+        sum1 = t1;
+    }
+    alignas(64) double sums[16];
+    alignas(64) double comps[16];
+    _mm512_store_pd(sums, sum0);
+    _mm512_store_pd(sums + 8, sum1);
+    _mm512_store_pd(comps, comp0);
+    _mm512_store_pd(comps + 8, comp1);
+    double total{0}, compensation{0};
+    for (std::size_t lane{0}; lane < 16; ++lane) {
+        CompensatedAdd(total, compensation, sums[lane]);
+        CompensatedAdd(total, compensation, -comps[lane]);
+    }
+    for (; i < n; ++i) CompensatedAdd(total, compensation, a[i]);
+    return total + compensation;
+}
+
+template <bool Largest> [[gnu::target("avx512f")]] inline double Extremum_AVX512(const double* a, std::size_t n) {
+    const auto start{_mm512_set1_pd(ExtremumStart<Largest, double>())};
+    auto acc0{start}, acc1{start}, acc2{start}, acc3{start};
+    std::size_t i{0};
+    for (; i + 32 <= n; i += 32) {
+        acc0 = Keep_AVX512<Largest>(_mm512_loadu_pd(a + i), acc0);
+        acc1 = Keep_AVX512<Largest>(_mm512_loadu_pd(a + i + 8), acc1);
+        acc2 = Keep_AVX512<Largest>(_mm512_loadu_pd(a + i + 16), acc2);
+        acc3 = Keep_AVX512<Largest>(_mm512_loadu_pd(a + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8)
+        acc0 = Keep_AVX512<Largest>(_mm512_loadu_pd(a + i), acc0);
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, Keep_AVX512<Largest>(Keep_AVX512<Largest>(acc0, acc1), Keep_AVX512<Largest>(acc2, acc3)));
+    double best{lanes[0]};
+    for (std::size_t lane{1}; lane < 8; ++lane) best = Keep_<Largest>(best, lanes[lane]);
+    for (; i < n; ++i) best = Keep_<Largest>(best, a[i]);
+    return best;
+}
+
+//*
+//* Transpose, register tiles and the blocks made of them
+
+[[gnu::target("sse2")]] inline void Transpose4x4_SSE2(const float* src, std::size_t lds, float* dst, std::size_t ldd) {
+    auto r0{_mm_loadu_ps(src)};
+    auto r1{_mm_loadu_ps(src + lds)};
+    auto r2{_mm_loadu_ps(src + 2 * lds)};
+    auto r3{_mm_loadu_ps(src + 3 * lds)};
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dst, r0);
+    _mm_storeu_ps(dst + ldd, r1);
+    _mm_storeu_ps(dst + 2 * ldd, r2);
+    _mm_storeu_ps(dst + 3 * ldd, r3);
+}
+
+[[gnu::target("sse2")]] inline void Transpose2x2_SSE2(const double* src, std::size_t lds, double* dst, std::size_t ldd) {
+    const auto r0{_mm_loadu_pd(src)};
+    const auto r1{_mm_loadu_pd(src + lds)};
+    _mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+    _mm_storeu_pd(dst + ldd, _mm_unpackhi_pd(r0, r1));
+}
+
+[[gnu::target("avx2")]] inline void Transpose8x8_AVX2(const float* src, std::size_t lds, float* dst, std::size_t ldd) {
+    __m256 r[8];
+    for (std::size_t i{0}; i < 8; ++i)
+        r[i] = _mm256_loadu_ps(src + i * lds);
+
+    __m256 t[8];
+    for (std::size_t i{0}; i < 8; i += 2) {
+        t[i]     = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (std::size_t i{0}; i < 8; i += 4) {
+        r[i]     = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 1] = _mm256_shuffle_ps(t[i],     t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (std::size_t i{0}; i < 4; ++i) {
+        _mm256_storeu_ps(dst + i * ldd,       _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+        _mm256_storeu_ps(dst + (i + 4) * ldd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+    }
+}
+
+[[gnu::target("avx2")]] inline void Transpose4x4_AVX2(const double* src, std::size_t lds, double* dst, std::size_t ldd) {
+    const auto r0{_mm256_loadu_pd(src)};
+    const auto r1{_mm256_loadu_pd(src + lds)};
+    const auto r2{_mm256_loadu_pd(src + 2 * lds)};
+    const auto r3{_mm256_loadu_pd(src + 3 * lds)};
+    const auto t0{_mm256_unpacklo_pd(r0, r1)};
+    const auto t1{_mm256_unpackhi_pd(r0, r1)};
+    const auto t2{_mm256_unpacklo_pd(r2, r3)};
+    const auto t3{_mm256_unpackhi_pd(r2, r3)};
+    _mm256_storeu_pd(dst,           _mm256_permute2f128_pd(t0, t2, 0x20));
+    _mm256_storeu_pd(dst + ldd,     _mm256_permute2f128_pd(t1, t3, 0x20));
+    _mm256_storeu_pd(dst + 2 * ldd, _mm256_permute2f128_pd(t0, t2, 0x31));
+    _mm256_storeu_pd(dst + 3 * ldd, _mm256_permute2f128_pd(t1, t3, 0x31));
+}
+
+//* full Tile x Tile squares with the register kernel, the right and bottom edges element by element
+//* Inlined into the TransposeBlock_ functions below, so the kernel is inlined with their target too
+template <std::size_t Tile, typename T, auto Kernel>
+[[gnu::always_inline]] inline void TransposeTiles_(const T* src, std::size_t lds, T* dst, std::size_t ldd,
+                                                   std::size_t rows, std::size_t cols) {
+    std::size_t r{0};
+    for (; r + Tile <= rows; r += Tile) {
+        std::size_t c{0};
+        for (; c + Tile <= cols; c += Tile)
+            Kernel(src + r * lds + c, lds, dst + c * ldd + r, ldd);
+        TransposeScalar(src + r * lds + c, lds, dst + c * ldd + r, ldd, Tile, cols - c);
+    }
+    TransposeScalar(src + r * lds, lds, dst + r, ldd, rows - r, cols);
+}
+
+[[gnu::target("sse2")]] inline void TransposeBlock_SSE2(const float* src, std::size_t lds, float* dst, std::size_t ldd, std::size_t rows, std::size_t cols) {
+    TransposeTiles_<4, float, Transpose4x4_SSE2>(src, lds, dst, ldd, rows, cols);
+}
+
+[[gnu::target("sse2")]] inline void TransposeBlock_SSE2(const double* src, std::size_t lds, double* dst, std::size_t ldd, std::size_t rows, std::size_t cols) {
+    TransposeTiles_<2, double, Transpose2x2_SSE2>(src, lds, dst, ldd, rows, cols);
+}
+
+[[gnu::target("avx2")]] inline void TransposeBlock_AVX2(const float* src, std::size_t lds, float* dst, std::size_t ldd, std::size_t rows, std::size_t cols) {
+    TransposeTiles_<8, float, Transpose8x8_AVX2>(src, lds, dst, ldd, rows, cols);
+}
+
+[[gnu::target("avx2")]] inline void TransposeBlock_AVX2(const double* src, std::size_t lds, double* dst, std::size_t ldd, std::size_t rows, std::size_t cols) {
+    TransposeTiles_<4, double, Transpose4x4_AVX2>(src, lds, dst, ldd, rows, cols);
+}
+
+} // namespace x86
+#endif
+
+//*
+//* Flat buffers
+
+template <typename T>
+void Add(const T* a, const T* b, T* out, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Add_AVX512(a, b, out, n);
+            case Isa::AVX2:   return x86::Add_AVX2(a, b, out, n);
+            case Isa::SSE2:   return x86::Add_SSE2(a, b, out, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    for (std::size_t i{0}; i < n; ++i)
+        out[i] = a[i] + b[i];
+}
+
+template <typename T>
+void Sub(const T* a, const T* b, T* out, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Sub_AVX512(a, b, out, n);
+            case Isa::AVX2:   return x86::Sub_AVX2(a, b, out, n);
+            case Isa::SSE2:   return x86::Sub_SSE2(a, b, out, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    for (std::size_t i{0}; i < n; ++i)
+        out[i] = a[i] - b[i];
+}
+
+template <typename T>
+void AddValue(const T* a, T val, T* out, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::AddValue_AVX512(a, val, out, n);
+            case Isa::AVX2:   return x86::AddValue_AVX2(a, val, out, n);
+            case Isa::SSE2:   return x86::AddValue_SSE2(a, val, out, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    for (std::size_t i{0}; i < n; ++i)
+        out[i] = a[i] + val;
+}
+
+template <typename T>
+void MulValue(const T* a, T val, T* out, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::MulValue_AVX512(a, val, out, n);
+            case Isa::AVX2:   return x86::MulValue_AVX2(a, val, out, n);
+            case Isa::SSE2:   return x86::MulValue_SSE2(a, val, out, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    for (std::size_t i{0}; i < n; ++i)
+        out[i] = a[i] * val;
+}
+
+//*
+//* Strided buffers: rows x cols, ld* is the distance between the start of two rows
+
+template <typename T>
+void Add(const T* a, std::size_t lda, const T* b, std::size_t ldb, T* out, std::size_t ldo,
+         std::size_t rows, std::size_t cols)
+{
+    if (lda == cols && ldb == cols && ldo == cols)
+        return Add(a, b, out, rows * cols);
+
+    for (std::size_t r{0}; r < rows; ++r)
+        Add(a + r * lda, b + r * ldb, out + r * ldo, cols);
+}
+
+template <typename T>
+void AddValue(const T* a, std::size_t lda, T val, T* out, std::size_t ldo,
+              std::size_t rows, std::size_t cols)
+{
+    if (lda == cols && ldo == cols)
+        return AddValue(a, val, out, rows * cols);
+
+    for (std::size_t r{0}; r < rows; ++r)
+        AddValue(a + r * lda, val, out + r * ldo, cols);
+}
+
+template <typename T>
+void MulValue(const T* a, std::size_t lda, T val, T* out, std::size_t ldo,
+              std::size_t rows, std::size_t cols)
+{
+    if (lda == cols && ldo == cols)
+        return MulValue(a, val, out, rows * cols);
+
+    for (std::size_t r{0}; r < rows; ++r)
+        MulValue(a + r * lda, val, out + r * ldo, cols);
+}
+
+//*
+//* Vectors
+
+template <typename T>
+T Dot(const T* a, const T* b, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Dot_AVX512(a, b, n);
+            case Isa::AVX2:   return x86::Dot_AVX2(a, b, n);
+            case Isa::SSE2:   return x86::Dot_SSE2(a, b, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    T total{};
+    for (std::size_t i{0}; i < n; ++i)
+        total += a[i] * b[i];
+    return total;
+}
+
+//* y += alpha * x
+template <typename T>
+void Axpy(T alpha, const T* x, T* y, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Axpy_AVX512(alpha, x, y, n);
+            case Isa::AVX2:   return x86::Axpy_AVX2(alpha, x, y, n);
+            case Isa::SSE2:   return x86::Axpy_SSE2(alpha, x, y, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    for (std::size_t i{0}; i < n; ++i)
+        y[i] += alpha * x[i];
+}
+
+//*
+//* Reductions
+
+//* a[0] + ... + a[n - 1], with several accumulators: the additions do not happen in the order of a
+template <typename T>
+T Sum(const T* a, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Sum_AVX512<false>(a, n);
+            case Isa::AVX2:   return x86::Sum_AVX2<false>(a, n);
+            case Isa::SSE2:   return x86::Sum_SSE2<false>(a, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    T acc[4]{};
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        acc[0] += a[i];
+        acc[1] += a[i + 1];
+        acc[2] += a[i + 2];
+        acc[3] += a[i + 3];
+    }
+    for (; i < n; ++i)
+        acc[0] += a[i];
+    return static_cast<T>((acc[0] + acc[1]) + (acc[2] + acc[3]));
+}
+
+//* |a[0]| + ... + |a[n - 1]|
+template <typename T>
+T SumAbs(const T* a, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Sum_AVX512<true>(a, n);
+            case Isa::AVX2:   return x86::Sum_AVX2<true>(a, n);
+            case Isa::SSE2:   return x86::Sum_SSE2<true>(a, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    T acc[4]{};
+    std::size_t i{0};
+    for (; i + 4 <= n; i += 4) {
+        acc[0] += Abs_(a[i]);
+        acc[1] += Abs_(a[i + 1]);
+        acc[2] += Abs_(a[i + 2]);
+        acc[3] += Abs_(a[i + 3]);
+    }
+    for (; i < n; ++i)
+        acc[0] += Abs_(a[i]);
+    return static_cast<T>((acc[0] + acc[1]) + (acc[2] + acc[3]));
+}
+
+//* compensated sum, its error does not grow with n (a plain Sum for integers)
+template <typename T>
+T KahanSum(const T* a, std::size_t n)
+{
+    if constexpr (!std::is_floating_point_v<T>) {
+        return Sum(a, n);
+    } else {
+#ifdef RAGE_SIMD_X86
+        if constexpr (HasKernels<T>) {
+            switch (ActiveIsa()) {
+                case Isa::AVX512: return x86::KahanSum_AVX512(a, n);
+                case Isa::AVX2:   return x86::KahanSum_AVX2(a, n);
+                case Isa::SSE2:   return x86::KahanSum_SSE2(a, n);
+                case Isa::Scalar: break;
+            }
+        }
+#endif
+        T total{0};
+        T compensation{0};
+        for (std::size_t i{0}; i < n; ++i)
+            CompensatedAdd(total, compensation, a[i]);
+        return total + compensation;
+    }
+}
+
+//* the largest element, NaNs are skipped; ExtremumStart (-infinity, lowest() for integers) when there is none
+template <typename T>
+T Max(const T* a, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Extremum_AVX512<true>(a, n);
+            case Isa::AVX2:   return x86::Extremum_AVX2<true>(a, n);
+            case Isa::SSE2:   return x86::Extremum_SSE2<true>(a, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    T best{ExtremumStart<true, T>()};
+    for (std::size_t i{0}; i < n; ++i)
+        best = Keep_<true>(best, a[i]);
+    return best;
+}
+
+//* the smallest element, NaNs are skipped; ExtremumStart (+infinity, max() for integers) when there is none
+template <typename T>
+T Min(const T* a, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::Extremum_AVX512<false>(a, n);
+            case Isa::AVX2:   return x86::Extremum_AVX2<false>(a, n);
+            case Isa::SSE2:   return x86::Extremum_SSE2<false>(a, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    T best{ExtremumStart<false, T>()};
+    for (std::size_t i{0}; i < n; ++i)
+        best = Keep_<false>(best, a[i]);
+    return best;
+}
+
+//*
+//* Comparison
+
+//* index of the first i where !(a[i] == b[i]), n when there is none
+template <typename T>
+std::size_t FirstMismatch(const T* a, const T* b, std::size_t n)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512: return x86::FirstMismatch_AVX512(a, b, n);
+            case Isa::AVX2:   return x86::FirstMismatch_AVX2(a, b, n);
+            case Isa::SSE2:   return x86::FirstMismatch_SSE2(a, b, n);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    for (std::size_t i{0}; i < n; ++i) {
+        if (!(a[i] == b[i]))
+            return i;
+    }
+    return n;
+}
+
+//*
+//* Transpose
+
+//* dst (cols x rows, ldd between its rows) = src (rows x cols, lds between its rows)^T
+//* Meant for blocks that fit in L1, the cache blocking is done by the caller (transpose.hpp)
+template <typename T>
+void Transpose(const T* src, std::size_t lds, T* dst, std::size_t ldd, std::size_t rows, std::size_t cols)
+{
+#ifdef RAGE_SIMD_X86
+    if constexpr (HasKernels<T>) {
+        switch (ActiveIsa()) {
+            case Isa::AVX512:
+            case Isa::AVX2:   return x86::TransposeBlock_AVX2(src, lds, dst, ldd, rows, cols);
+            case Isa::SSE2:   return x86::TransposeBlock_SSE2(src, lds, dst, ldd, rows, cols);
+            case Isa::Scalar: break;
+        }
+    }
+#endif
+    TransposeScalar(src, lds, dst, ldd, rows, cols);
+}
+
+} // namespace internal_impl::simd
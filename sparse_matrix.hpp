@@ -0,0 +1,435 @@
+#pragma once
+
+#include "matrix.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <algorithm>
+#include <numeric>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//* Sparse matrices, SparseMatrix<T, Layout>: only the non-zero elements are stored
+//*
+//* The Layout picks the compressed axis, like the dense one picks the contiguous axis:
+//*   SparseMatrix<T, RowMajor>  CSR (CsrMatrix<T>), line i is row i
+//*   SparseMatrix<T, ColMajor>  CSC (CscMatrix<T>), line i is column i
+//* Offsets() has LinesCount + 1 entries, the non-zeros of line i are Indices()/Values() in [Offsets()[i], Offsets()[i + 1]),
+//* sorted by index (the column for CSR, the row for CSC), without duplicates.
+//*
+//* Products against dense operands (any MatrixLike, any contiguous vector) cost O(non-zeros) per dense column.
+//* They split the rows of the result in blocks of about the same number of non-zeros, one block per task.
+
+namespace rage {
+
+template <typename T, typename Layout = RowMajor>
+class SparseMatrix;
+
+template <typename T>
+using CsrMatrix = SparseMatrix<T, RowMajor>;
+
+template <typename T>
+using CscMatrix = SparseMatrix<T, ColMajor>;
+
+} // namespace rage
+
+namespace internal_impl {
+
+//* fn(first_line, last_line) over blocks of lines holding about the same number of non-zeros
+//* (work_per_non_zero is the cost of one of them, it decides whether going parallel pays off)
+template <typename F>
+void ForEachNonZeroBlock(rage::ThreadPool& pool, std::span<const std::size_t> offsets, std::size_t work_per_non_zero, const F& fn)
+{
+    const auto lines{offsets.size() - 1};
+    const auto non_zeros{offsets.back()};
+    if (non_zeros * std::max<std::size_t>(work_per_non_zero, 1) < rage::ParallelThresholds::elementwise
+        || pool.ThreadsCount() == 1 || lines < 2) {
+        fn(std::size_t{0}, lines);
+        return;
+    }
+
+    const auto blocks{std::min(lines, pool.ThreadsCount() * 4)};
+    //* first line of block b: the first one whose non-zeros start at or after b / blocks of the total
+    const auto boundary{[&](std::size_t b) {
+        if (b == blocks)
+            return lines;
+        const auto target{non_zeros / blocks * b + non_zeros % blocks * b / blocks};
+        return static_cast<std::size_t>(std::lower_bound(offsets.begin(), offsets.end() - 1, target) - offsets.begin());
+    }};
+    pool.ParallelFor(0, blocks, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t b{first}; b < last; ++b) {
+            const auto block_first{boundary(b)};
+            const auto block_last{boundary(b + 1)};
+            if (block_first < block_last)
+                fn(block_first, block_last);
+        }
+    });
+}
+
+//* c_row[0, n) += value * row r of get (n columns), through the vector kernel when the row is contiguous
+template <typename R, typename Get>
+void AxpyRow_(const R& value, const Get& get, std::size_t r, R* c_row, std::size_t n)
+{
+    if constexpr (IsStridedAccessor<Get>::value) {
+        if (get.col_stride == 1) {
+            simd::Axpy(value, get.data + r * get.row_stride, c_row, n);
+            return;
+        }
+    }
+    for (std::size_t j{0}; j < n; ++j)
+        c_row[j] += value * static_cast<R>(get(r, j));
+}
+
+} // namespace internal_impl
+
+namespace rage {
+
+template <typename T, typename Layout>
+class SparseMatrix
+{
+    static_assert(internal_impl::LayoutPolicy<Layout>, "Layout must be RowMajor or ColMajor");
+
+public:
+    using ValueType = T;
+
+    //* rows x cols of zeros
+    explicit SparseMatrix(std::size_t rows = 0, std::size_t cols = 0)
+        :   rows_count_{rows},
+            cols_count_{cols},
+            offsets_(Layout::LinesCount(rows, cols) + 1, 0)
+    {}
+
+    //* the non-zeros of any dense matrix, view or expression
+    template <internal_impl::MatrixLike M>
+    requires std::convertible_to<internal_impl::ValueOf<M>, T>
+    explicit SparseMatrix(const M& dense)
+        :   SparseMatrix(dense.RowsCount(), dense.ColsCount())
+    {
+        const auto operand{internal_impl::ToOperand(dense)};
+        for (std::size_t line{0}; line < LinesCount_(); ++line) {
+            for (std::size_t i{0}; i < LineLength_(); ++i) {
+                const auto [r, c]{Position_(line, i)};
+                const T value{static_cast<T>(operand.At(r, c))};
+                if (value != T{}) {
+                    indices_.push_back(i);
+                    values_.push_back(value);
+                }
+            }
+            offsets_[line + 1] = values_.size();
+        }
+    }
+
+    //* CSR from CSC and the other way around, O(non-zeros + lines)
+    template <typename L>
+    requires (!std::is_same_v<L, Layout>)
+    explicit SparseMatrix(const SparseMatrix<T, L>& other)
+        :   SparseMatrix(other.RowsCount(), other.ColsCount())
+    {
+        indices_.resize(other.NonZerosCount());
+        values_.resize(other.NonZerosCount());
+
+        //* the lines of other are the indices here: count them, then place every non-zero at its line's cursor
+        for (const auto index : other.Indices())
+            ++offsets_[index + 1];
+        std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+        std::vector<std::size_t> cursors(offsets_.begin(), offsets_.end() - 1);
+        for (std::size_t other_line{0}; other_line + 1 < other.Offsets().size(); ++other_line) {
+            for (auto k{other.Offsets()[other_line]}; k < other.Offsets()[other_line + 1]; ++k) {
+                const auto slot{cursors[other.Indices()[k]]++};
+                indices_[slot] = other_line; // other lines come in order, so every line here ends up sorted
+                values_[slot] = other.Values()[k];
+            }
+        }
+    }
+
+    //* takes the three arrays as they are; they must follow the format described at the top of this file
+    SparseMatrix(std::size_t rows, std::size_t cols, std::vector<std::size_t> offsets,
+                 std::vector<std::size_t> indices, std::vector<T> values)
+        :   rows_count_{rows},
+            cols_count_{cols},
+            offsets_{std::move(offsets)},
+            indices_{std::move(indices)},
+            values_{std::move(values)}
+    {
+        assert(offsets_.size() == Layout::LinesCount(rows, cols) + 1 && offsets_.front() == 0 && "One offset per line, plus one");
+        assert(offsets_.back() == indices_.size() && indices_.size() == values_.size() && "One index per value");
+    }
+
+public:
+    //* dense copy, zeros included
+    template <typename DenseLayout = RowMajor>
+    Matrix<T, AlignedAllocator<T>, DenseLayout> ToDense() const {
+        Matrix<T, AlignedAllocator<T>, DenseLayout> result(rows_count_, cols_count_);
+        std::fill(result.Data().begin(), result.Data().end(), T{});
+        for (std::size_t line{0}; line < LinesCount_(); ++line) {
+            for (auto k{offsets_[line]}; k < offsets_[line + 1]; ++k) {
+                const auto [r, c]{Position_(line, indices_[k])};
+                result.At(r, c) = values_[k];
+            }
+        }
+        return result;
+    }
+
+    //* zero when the element is not stored, a binary search in its line
+    T At(std::size_t r, std::size_t c) const {
+        assert(r < rows_count_ && c < cols_count_ && "Index out of the matrix");
+        const auto line{internal_impl::IsRowMajor<Layout> ? r : c};
+        const auto index{internal_impl::IsRowMajor<Layout> ? c : r};
+        const auto first{indices_.begin() + static_cast<std::ptrdiff_t>(offsets_[line])};
+        const auto last{indices_.begin() + static_cast<std::ptrdiff_t>(offsets_[line + 1])};
+        const auto found{std::lower_bound(first, last, index)};
+        return found != last && *found == index ? values_[static_cast<std::size_t>(found - indices_.begin())] : T{};
+    }
+
+//* Access methods
+public:
+    std::size_t RowsCount() const { return rows_count_; }
+    std::size_t ColsCount() const { return cols_count_; }
+    std::size_t NonZerosCount() const { return values_.size(); }
+
+    std::span<const std::size_t> Offsets() const { return offsets_; }
+    std::span<const std::size_t> Indices() const { return indices_; }
+    std::span<const T> Values() const { return values_; }
+    //* the pattern stays, the values can change
+    std::span<T> Values() { return values_; }
+
+private:
+    std::size_t LinesCount_() const { return Layout::LinesCount(rows_count_, cols_count_); }
+    std::size_t LineLength_() const { return Layout::LineLength(rows_count_, cols_count_); }
+
+    //* (row, col) of the element at index in line
+    static std::pair<std::size_t, std::size_t> Position_(std::size_t line, std::size_t index) {
+        if constexpr (internal_impl::IsRowMajor<Layout>)
+            return {line, index};
+        else
+            return {index, line};
+    }
+
+private:
+    std::size_t rows_count_;
+    std::size_t cols_count_;
+    std::vector<std::size_t> offsets_;
+    std::vector<std::size_t> indices_;
+    std::vector<T> values_;
+};
+
+//* COO triplets in any order, duplicates summed, e.g.
+//*   SparseBuilder<double> builder(rows, cols);
+//*   builder.Add(r, c, value); ...
+//*   CsrMatrix<double> a{builder.Build()};
+//* Build is a counting sort on the lines plus a sort inside every line, O(non-zeros + lines) for sorted input
+template <typename T>
+class SparseBuilder
+{
+public:
+    explicit SparseBuilder(std::size_t rows, std::size_t cols)
+        :   rows_count_{rows},
+            cols_count_{cols}
+    {}
+
+public:
+    void Reserve(std::size_t non_zeros) { triplets_.reserve(non_zeros); }
+
+    SparseBuilder& Add(std::size_t r, std::size_t c, const T& value) {
+        assert(r < rows_count_ && c < cols_count_ && "Index out of the matrix");
+        triplets_.push_back({r, c, value});
+        return *this;
+    }
+
+    std::size_t TripletsCount() const { return triplets_.size(); }
+
+    template <typename Layout = RowMajor>
+    SparseMatrix<T, Layout> Build() const {
+        const auto lines{Layout::LinesCount(rows_count_, cols_count_)};
+        const auto line_of{[](const Triplet_& t) { return internal_impl::IsRowMajor<Layout> ? t.row : t.col; }};
+        const auto index_of{[](const Triplet_& t) { return internal_impl::IsRowMajor<Layout> ? t.col : t.row; }};
+
+        std::vector<std::size_t> offsets(lines + 1, 0);
+        for (const auto& triplet : triplets_)
+            ++offsets[line_of(triplet) + 1];
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+        std::vector<std::pair<std::size_t, T>> entries(triplets_.size());
+        std::vector<std::size_t> cursors(offsets.begin(), offsets.end() - 1);
+        for (const auto& triplet : triplets_)
+            entries[cursors[line_of(triplet)]++] = {index_of(triplet), triplet.value};
+
+        //* sort every line by index and merge the duplicates, compacting as we go
+        std::vector<std::size_t> indices;
+        std::vector<T> values;
+        indices.reserve(entries.size());
+        values.reserve(entries.size());
+        std::vector<std::size_t> compacted(lines + 1, 0);
+        for (std::size_t line{0}; line < lines; ++line) {
+            const auto first{entries.begin() + static_cast<std::ptrdiff_t>(offsets[line])};
+            const auto last{entries.begin() + static_cast<std::ptrdiff_t>(offsets[line + 1])};
+            if (!std::is_sorted(first, last, [](const auto& a, const auto& b) { return a.first < b.first; }))
+                std::stable_sort(first, last, [](const auto& a, const auto& b) { return a.first < b.first; });
+            for (auto it{first}; it != last; ++it) {
+                if (indices.size() > compacted[line] && indices.back() == it->first) {
+                    values.back() += it->second;
+                } else {
+                    indices.push_back(it->first);
+                    values.push_back(it->second);
+                }
+            }
+            compacted[line + 1] = indices.size();
+        }
+
+        return SparseMatrix<T, Layout>{rows_count_, cols_count_, std::move(compacted), std::move(indices), std::move(values)};
+    }
+
+private:
+    struct Triplet_ {
+        std::size_t row;
+        std::size_t col;
+        T value;
+    };
+
+    std::size_t rows_count_;
+    std::size_t cols_count_;
+    std::vector<Triplet_> triplets_;
+};
+
+} // namespace rage
+
+namespace internal_impl {
+
+template <typename R, typename T, typename M>
+rage::Matrix<R> MultiplyCsr(const rage::CsrMatrix<T>& lhs, const M& rhs, rage::ThreadPool& pool)
+{
+    const auto rhs_operand{ToOperand(rhs)};
+    const auto get_rhs{GemmAccessor<R>(rhs_operand)};
+    const auto offsets{lhs.Offsets()};
+    const auto indices{lhs.Indices()};
+    const auto values{lhs.Values()};
+    const auto n{rhs.ColsCount()};
+
+    rage::Matrix<R> result(lhs.RowsCount(), n);
+    ForEachNonZeroBlock(pool, offsets, n, [&](std::size_t first, std::size_t last) {
+        for (std::size_t r{first}; r < last; ++r) {
+            R* c_row{result.RawData() + r * result.LeadingDimension()};
+            std::fill(c_row, c_row + n, R{});
+            for (auto k{offsets[r]}; k < offsets[r + 1]; ++k)
+                AxpyRow_(static_cast<R>(values[k]), get_rhs, indices[k], c_row, n);
+        }
+    });
+    return result;
+}
+
+} // namespace internal_impl
+
+namespace rage {
+
+//*
+//* Sparse x dense vector: y = A x, rows in parallel for CSR; CSC scatters column after column,
+//* or becomes CSR first (O(non-zeros)) when the product is big enough to go parallel
+template <typename T, typename L, std::ranges::contiguous_range V,
+          typename R = std::common_type_t<T, std::ranges::range_value_t<V>>>
+requires std::ranges::sized_range<V>
+std::vector<R> Multiply(const SparseMatrix<T, L>& a, const V& x, ThreadPool& pool)
+{
+    assert(std::ranges::size(x) == a.ColsCount() && "The vector must have ColsCount elements");
+    if constexpr (!internal_impl::IsRowMajor<L>) {
+        //* the scatter does not split (two columns may hit the same row of y), the rows of the CSR do.
+        //* They sum in the same (column) order, the result does not depend on the path
+        if (pool.ThreadsCount() > 1 && a.NonZerosCount() >= ParallelThresholds::elementwise)
+            return Multiply(CsrMatrix<T>{a}, x, pool);
+    }
+
+    const auto* x_data{std::ranges::data(x)};
+    const auto offsets{a.Offsets()};
+    const auto indices{a.Indices()};
+    const auto values{a.Values()};
+
+    std::vector<R> y(a.RowsCount(), R{});
+    if constexpr (internal_impl::IsRowMajor<L>) {
+        internal_impl::ForEachNonZeroBlock(pool, offsets, 1, [&](std::size_t first, std::size_t last) {
+            for (std::size_t r{first}; r < last; ++r) {
+                R sum{};
+                for (auto k{offsets[r]}; k < offsets[r + 1]; ++k)
+                    sum += static_cast<R>(values[k]) * static_cast<R>(x_data[indices[k]]);
+                y[r] = sum;
+            }
+        });
+    } else {
+        for (std::size_t c{0}; c < a.ColsCount(); ++c) {
+            const auto x_c{static_cast<R>(x_data[c])};
+            for (auto k{offsets[c]}; k < offsets[c + 1]; ++k)
+                y[indices[k]] += static_cast<R>(values[k]) * x_c;
+        }
+    }
+    return y;
+}
+
+template <typename T, typename L, std::ranges::contiguous_range V>
+requires std::ranges::sized_range<V>
+inline auto Multiply(const SparseMatrix<T, L>& a, const V& x) { return Multiply(a, x, ThreadPool::Default()); }
+
+//*
+//* Sparse x dense matrix: row r of the result accumulates value * (row index of rhs) over the non-zeros of row r.
+//* The rows of rhs go through the vector Axpy when they are contiguous. CSC operands become CSR first (O(non-zeros))
+template <typename T, typename L, internal_impl::MatrixLike M,
+          typename R = std::common_type_t<T, internal_impl::ValueOf<M>>>
+Matrix<R> Multiply(const SparseMatrix<T, L>& lhs, const M& rhs, ThreadPool& pool)
+{
+    assert(lhs.ColsCount() == rhs.RowsCount() && "Inner dimensions must match");
+    if constexpr (internal_impl::IsRowMajor<L>)
+        return internal_impl::MultiplyCsr<R>(lhs, rhs, pool);
+    else
+        return internal_impl::MultiplyCsr<R>(CsrMatrix<T>{lhs}, rhs, pool);
+}
+
+template <typename T, typename L, internal_impl::MatrixLike M>
+inline auto Multiply(const SparseMatrix<T, L>& lhs, const M& rhs) { return Multiply(lhs, rhs, ThreadPool::Default()); }
+
+//*
+//* Dense matrix x sparse, rows of the result in parallel:
+//*   CSR rhs: row r of the result accumulates lhs(r, k) * (sparse row k)
+//*   CSC rhs: (r, j) of the result is row r of lhs . sparse column j
+template <internal_impl::MatrixLike M, typename T, typename L,
+          typename R = std::common_type_t<internal_impl::ValueOf<M>, T>>
+Matrix<R> Multiply(const M& lhs, const SparseMatrix<T, L>& rhs, ThreadPool& pool)
+{
+    assert(lhs.ColsCount() == rhs.RowsCount() && "Inner dimensions must match");
+    const auto lhs_operand{internal_impl::ToOperand(lhs)};
+    const auto get_lhs{internal_impl::GemmAccessor<R>(lhs_operand)};
+    const auto offsets{rhs.Offsets()};
+    const auto indices{rhs.Indices()};
+    const auto values{rhs.Values()};
+    const auto n{rhs.ColsCount()};
+
+    Matrix<R> result(lhs.RowsCount(), n);
+    const auto work{std::max<std::size_t>(rhs.NonZerosCount(), 1)};
+    internal_impl::ForEachRowBlock(pool, lhs.RowsCount(), work, [&](std::size_t first, std::size_t last) {
+        for (std::size_t r{first}; r < last; ++r) {
+            R* c_row{result.RawData() + r * result.LeadingDimension()};
+            if constexpr (internal_impl::IsRowMajor<L>) {
+                std::fill(c_row, c_row + n, R{});
+                for (std::size_t k{0}; k < lhs.ColsCount(); ++k) {
+                    const auto a_rk{static_cast<R>(get_lhs(r, k))};
+                    if (a_rk == R{})
+                        continue;
+                    for (auto p{offsets[k]}; p < offsets[k + 1]; ++p)
+                        c_row[indices[p]] += a_rk * static_cast<R>(values[p]);
+                }
+            } else {
+                for (std::size_t j{0}; j < n; ++j) {
+                    R sum{};
+                    for (auto p{offsets[j]}; p < offsets[j + 1]; ++p)
+                        sum += static_cast<R>(get_lhs(r, indices[p])) * static_cast<R>(values[p]);
+                    c_row[j] = sum;
+                }
+            }
+        }
+    });
+    return result;
+}
+
+template <internal_impl::MatrixLike M, typename T, typename L>
+inline auto Multiply(const M& lhs, const SparseMatrix<T, L>& rhs) { return Multiply(lhs, rhs, ThreadPool::Default()); }
+
+} // namespace rage
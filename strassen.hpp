@@ -0,0 +1,164 @@
+#pragma once
+
+#include "allocator.hpp"
+#include "gemm.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+//* Strassen-Winograd multiplication, C = A B in O(n^2.81) for big operands
+//*
+//* Every level splits A, B and C in quadrants and replaces 8 products of half the size by 7, plus 15 additions.
+//* The schedule is the one of Boyer, Dumas, Pernet and Zhou (2009): the quadrants of C hold intermediate
+//* products, so a level needs only two temporaries, X (m/2 x max(k/2, n/2)) and Y (k/2 x n/2).
+//* They come from one workspace allocated up front: a level takes its X and Y and hands the rest to the
+//* next level, whose calls run one after the other, so the whole recursion costs about 4/3 of the first level.
+//*
+//* Odd dimensions are peeled: the even part recurses, the last row, column or inner index are added with
+//* thin products afterwards. Blocks with a side under the cutoff go to the blocked GEMM (on the pool).
+//* Strassen trades some accuracy for speed (errors grow with the depth), so it is opt-in: MultiplyStrassen,
+//* or StrassenThresholds::automatic for every product of floating point matrices above a size.
+
+namespace rage {
+
+struct StrassenThresholds {
+    static inline std::size_t cutoff{512};                                          // smallest side that still recurses
+    static inline std::size_t automatic{std::numeric_limits<std::size_t>::max()};  // operator* switches over above this side
+};
+
+} // namespace rage
+
+namespace internal_impl {
+
+//* out = x + y or x - y, rows x cols
+template <typename T>
+void Combine_(const T* x, std::size_t ldx, const T* y, std::size_t ldy, T* out, std::size_t ldo,
+              std::size_t rows, std::size_t cols, bool subtract)
+{
+    if (!subtract)
+        return simd::Add(x, ldx, y, ldy, out, ldo, rows, cols);
+
+    for (std::size_t r{0}; r < rows; ++r) {
+        const T* x_row{x + r * ldx};
+        const T* y_row{y + r * ldy};
+        T* out_row{out + r * ldo};
+        for (std::size_t c{0}; c < cols; ++c)
+            out_row[c] = x_row[c] - y_row[c];
+    }
+}
+
+inline bool StrassenRecurses_(std::size_t m, std::size_t k, std::size_t n, std::size_t cutoff)
+{
+    return std::min({m, k, n}) >= std::max<std::size_t>(cutoff, 2);
+}
+
+//* elements of workspace needed by StrassenRecursive_ for these dimensions
+inline std::size_t StrassenWorkspace(std::size_t m, std::size_t k, std::size_t n, std::size_t cutoff)
+{
+    std::size_t total{0};
+    while (StrassenRecurses_(m, k, n, cutoff)) {
+        m /= 2;
+        k /= 2;
+        n /= 2;
+        total += m * std::max(k, n) + k * n;
+    }
+    return total;
+}
+
+//* C (m x n, ldc) = A (m x k, lda) B (k x n, ldb), all row-major
+template <typename T>
+void StrassenRecursive_(std::size_t m, std::size_t k, std::size_t n,
+                        const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc,
+                        T* workspace, std::size_t cutoff, rage::ThreadPool& pool)
+{
+    if (!StrassenRecurses_(m, k, n, cutoff))
+        return ParallelGemm<T>(pool, m, n, k, StridedAccessor<T>{a, lda, 1}, StridedAccessor<T>{b, ldb, 1}, c, ldc);
+
+    const auto m2{m / 2};
+    const auto k2{k / 2};
+    const auto n2{n / 2};
+
+    const T* a11{a};
+    const T* a12{a + k2};
+    const T* a21{a + m2 * lda};
+    const T* a22{a + m2 * lda + k2};
+    const T* b11{b};
+    const T* b12{b + n2};
+    const T* b21{b + k2 * ldb};
+    const T* b22{b + k2 * ldb + n2};
+    T* c11{c};
+    T* c12{c + n2};
+    T* c21{c + m2 * ldc};
+    T* c22{c + m2 * ldc + n2};
+
+    const auto ldx{std::max(k2, n2)};
+    T* x{workspace};
+    T* y{workspace + m2 * ldx};
+    T* rest{y + k2 * n2};
+
+    const auto multiply{[&](const T* lhs, std::size_t ldl, const T* rhs, std::size_t ldr, T* out, std::size_t ldo) {
+        StrassenRecursive_(m2, k2, n2, lhs, ldl, rhs, ldr, out, ldo, rest, cutoff, pool);
+    }};
+    const auto combine_a{[&](const T* lhs, std::size_t ldl, const T* rhs, std::size_t ldr, bool subtract) {
+        Combine_(lhs, ldl, rhs, ldr, x, ldx, m2, k2, subtract);
+    }};
+    const auto combine_b{[&](const T* lhs, std::size_t ldl, const T* rhs, std::size_t ldr, bool subtract) {
+        Combine_(lhs, ldl, rhs, ldr, y, n2, k2, n2, subtract);
+    }};
+    const auto combine_c{[&](const T* lhs, std::size_t ldl, const T* rhs, std::size_t ldr, T* out, std::size_t ldo, bool subtract) {
+        Combine_(lhs, ldl, rhs, ldr, out, ldo, m2, n2, subtract);
+    }};
+
+    combine_a(a11, lda, a21, lda, true);                // S3 = A11 - A21
+    combine_b(b22, ldb, b12, ldb, true);                // T3 = B22 - B12
+    multiply(x, ldx, y, n2, c21, ldc);                  // P7 = S3 T3
+    combine_a(a21, lda, a22, lda, false);               // S1 = A21 + A22
+    combine_b(b12, ldb, b11, ldb, true);                // T1 = B12 - B11
+    multiply(x, ldx, y, n2, c22, ldc);                  // P5 = S1 T1
+    combine_a(x, ldx, a11, lda, true);                  // S2 = S1 - A11
+    combine_b(b22, ldb, y, n2, true);                   // T2 = B22 - T1
+    multiply(x, ldx, y, n2, c12, ldc);                  // P6 = S2 T2
+    combine_a(a12, lda, x, ldx, true);                  // S4 = A12 - S2
+    multiply(x, ldx, b22, ldb, c11, ldc);               // P3 = S4 B22
+    multiply(a11, lda, b11, ldb, x, ldx);               // P1 = A11 B11
+    combine_c(x, ldx, c12, ldc, c12, ldc, false);       // U2 = P1 + P6
+    combine_c(c12, ldc, c21, ldc, c21, ldc, false);     // U3 = U2 + P7
+    combine_c(c12, ldc, c22, ldc, c12, ldc, false);     // U4 = U2 + P5
+    combine_c(c21, ldc, c22, ldc, c22, ldc, false);     // U7 = U3 + P5 = C22
+    combine_c(c12, ldc, c11, ldc, c12, ldc, false);     // U5 = U4 + P3 = C12
+    combine_b(y, n2, b21, ldb, true);                   // T4 = T2 - B21
+    multiply(a22, lda, y, n2, c11, ldc);                // P4 = A22 T4
+    combine_c(c21, ldc, c11, ldc, c21, ldc, true);      // U6 = U3 - P4 = C21
+    multiply(a12, lda, b21, ldb, c11, ldc);             // P2 = A12 B21
+    combine_c(x, ldx, c11, ldc, c11, ldc, false);       // U1 = P1 + P2 = C11
+
+    //* dynamic peeling of the odd row, column and inner index
+    const auto me{2 * m2};
+    const auto ke{2 * k2};
+    const auto ne{2 * n2};
+    if (ke != k) {
+        // C[0, me)[0, ne) += A[0, me)(ke) B(ke)[0, ne)
+        for (std::size_t r{0}; r < me; ++r)
+            simd::Axpy(a[r * lda + ke], b + ke * ldb, c + r * ldc, ne);
+    }
+    if (ne != n)
+        Gemm<T>(me, 1, k, StridedAccessor<T>{a, lda, 1}, StridedAccessor<T>{b + ne, ldb, 1}, c + ne, ldc);
+    if (me != m)
+        Gemm<T>(1, n, k, StridedAccessor<T>{a + me * lda, lda, 1}, StridedAccessor<T>{b, ldb, 1}, c + me * ldc, ldc);
+}
+
+//* C (m x n, ldc) = A (m x k, lda) B (k x n, ldb), all row-major, C does not need to be initialized
+template <typename T>
+void Strassen(std::size_t m, std::size_t k, std::size_t n,
+              const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc,
+              rage::ThreadPool& pool, std::size_t cutoff = rage::StrassenThresholds::cutoff)
+{
+    std::vector<T, rage::AlignedAllocator<T>> workspace(StrassenWorkspace(m, k, n, cutoff));
+    StrassenRecursive_(m, k, n, a, lda, b, ldb, c, ldc, workspace.data(), cutoff, pool);
+}
+
+} // namespace internal_impl
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "async.hpp"
+#include "matrix.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+//* A graph of matrix operations run on the pool, TaskGraph<T>
+//*
+//* Operations are recorded first and run later: Input() wraps an existing matrix (by reference, no copy),
+//* Multiply/Add/Subtract/Scale return the node of their result. Run() starts every node whose operands
+//* are done as its own pool task, so independent products overlap across cores (each one still
+//* parallel inside), and returns when all of them are done.
+//*
+//*   rage::TaskGraph<double> graph;
+//*   const auto ab{graph.Multiply(graph.Input(a), graph.Input(b))};
+//*   const auto cd{graph.Multiply(graph.Input(c), graph.Input(d))}; // independent of ab
+//*   const auto sum{graph.Add(ab, cd)};
+//*   graph.Run();
+//*   graph.Result(sum);
+//*
+//* Intermediate results go back to a free list as soon as their last consumer is done, and the next node
+//* of the same dimensions writes into them (through the destination passing Multiply/Add/Scale).
+//* Nodes nobody reads, and the ones passed to Keep(), hold their result until the next Run(), which
+//* reuses every buffer of the previous one: running the same graph again allocates nothing.
+//* Nodes can only read nodes recorded before them, so the graph has no cycle by construction.
+
+namespace rage {
+
+template <typename T>
+class TaskGraph
+{
+public:
+    //* a node of this graph
+    struct Node {
+        std::size_t index;
+    };
+
+public:
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+public:
+    template <typename A, typename L>
+    Node Input(const Matrix<T, A, L>& m) { return Input(m.View()); }
+
+    template <typename U, typename L>
+    requires std::is_same_v<std::remove_const_t<U>, T>
+    Node Input(const MatrixView<U, internal_impl::DefaultMorph<U>, L>& view) {
+        auto node{Node_{Op_::Input, view.RowsCount(), view.ColsCount()}};
+        node.input = view.RawData();
+        node.input_ld = view.LeadingDimension();
+        node.input_col_major = !internal_impl::IsRowMajor<L>;
+        return Add_(std::move(node));
+    }
+
+    Node Multiply(Node lhs, Node rhs) {
+        assert(ColsCount_(lhs) == RowsCount_(rhs) && "Inner dimensions must match");
+        return Add_(Node_{Op_::Multiply, RowsCount_(lhs), ColsCount_(rhs), lhs.index, rhs.index});
+    }
+
+    Node Add(Node lhs, Node rhs) {
+        assert(RowsCount_(lhs) == RowsCount_(rhs) && ColsCount_(lhs) == ColsCount_(rhs) && "Matrices must have the same dimensions");
+        return Add_(Node_{Op_::Add, RowsCount_(lhs), ColsCount_(lhs), lhs.index, rhs.index});
+    }
+
+    Node Subtract(Node lhs, Node rhs) {
+        assert(RowsCount_(lhs) == RowsCount_(rhs) && ColsCount_(lhs) == ColsCount_(rhs) && "Matrices must have the same dimensions");
+        return Add_(Node_{Op_::Subtract, RowsCount_(lhs), ColsCount_(lhs), lhs.index, rhs.index});
+    }
+
+    Node Scale(Node operand, const T& scalar) {
+        auto node{Node_{Op_::Scale, RowsCount_(operand), ColsCount_(operand), operand.index, operand.index}};
+        node.scalar = scalar;
+        return Add_(std::move(node));
+    }
+
+    //* the result of node survives Run even though other nodes read it
+    void Keep(Node node) { nodes_[node.index].keep = true; }
+
+    //* Runs every node, the first exception thrown by an operation is rethrown here
+    //* (the nodes depending on the failed one, directly or not, are skipped; the others still run)
+    void Run(ThreadPool& pool);
+    void Run() { Run(ThreadPool::Default()); }
+
+    //* Run as a task of the pool, the graph must not change before the future is done
+    Future<void> RunAsync(ThreadPool& pool) { return Async([this, &pool] { Run(pool); }, pool); }
+    Future<void> RunAsync() { return RunAsync(ThreadPool::Default()); }
+
+    //* a node nobody reads, a kept one or an input; valid until the next Run
+    MatrixView<const T, internal_impl::DefaultMorph<const T>, RowMajor> Result(Node node) const {
+        const auto& n{nodes_[node.index]};
+        assert(n.op != Op_::Input && n.buffer && "No result: an input, a node consumed by others (see Keep) or Run not called");
+        return std::as_const(*n.buffer).View();
+    }
+
+    std::size_t NodesCount() const { return nodes_.size(); }
+
+    //* buffers allocated since the graph was built, reused ones not counted
+    std::size_t BuffersAllocated() const { return buffers_allocated_; }
+
+private:
+    enum class Op_ { Input, Multiply, Add, Subtract, Scale };
+
+    struct Node_ {
+        Op_ op;
+        std::size_t rows;
+        std::size_t cols;
+        std::size_t lhs{0};
+        std::size_t rhs{0};
+        T scalar{};
+        bool keep{false};
+        const T* input{nullptr}; //* the matrix of an input node
+        std::size_t input_ld{0};
+        bool input_col_major{false};
+        std::vector<std::size_t> consumers{}; //* the nodes reading this one, once per operand
+        std::optional<Matrix<T>> buffer{};
+    };
+
+    //* per Run
+    struct State_ {
+        ThreadPool& pool;
+        bool in_order; //* the caller runs the nodes one after the other, nothing is submitted
+        std::vector<std::atomic<std::size_t>> waiting_for; //* operands not done yet
+        std::vector<std::atomic<std::size_t>> readers_left;
+        std::vector<std::atomic<bool>> skipped; //* an operand failed or was skipped
+        std::atomic<std::size_t> nodes_left;
+        std::exception_ptr error{};
+        std::mutex error_mutex{};
+    };
+
+    std::size_t RowsCount_(Node node) const { return nodes_[node.index].rows; }
+    std::size_t ColsCount_(Node node) const { return nodes_[node.index].cols; }
+
+    Node Add_(Node_&& node) {
+        const Node added{nodes_.size()};
+        if (node.op != Op_::Input) {
+            nodes_[node.lhs].consumers.push_back(added.index);
+            if (node.op != Op_::Scale)
+                nodes_[node.rhs].consumers.push_back(added.index);
+        }
+        nodes_.push_back(std::move(node));
+        return added;
+    }
+
+    std::size_t OperandsCount_(const Node_& node) const {
+        return node.op == Op_::Input ? 0 : node.op == Op_::Scale ? 1 : 2;
+    }
+
+    template <typename F>
+    void WithOperand_(std::size_t index, const F& fn) const {
+        const auto& node{nodes_[index]};
+        if (node.op != Op_::Input)
+            fn(std::as_const(*node.buffer).View());
+        else if (node.input_col_major)
+            fn(MatrixView<const T, internal_impl::DefaultMorph<const T>, ColMajor>::FromBuffer(node.input, node.rows, node.cols, node.input_ld));
+        else
+            fn(MatrixView<const T, internal_impl::DefaultMorph<const T>, RowMajor>::FromBuffer(node.input, node.rows, node.cols, node.input_ld));
+    }
+
+    void Execute_(Node_& node, ThreadPool& pool) {
+        if (node.op == Op_::Input)
+            return;
+        node.buffer = AcquireBuffer_(node.rows, node.cols);
+        auto& out{*node.buffer};
+        switch (node.op) {
+        case Op_::Input:
+            break;
+        case Op_::Multiply:
+            WithOperand_(node.lhs, [&](const auto& lhs) {
+                WithOperand_(node.rhs, [&](const auto& rhs) { rage::Multiply(out, lhs, rhs, pool); });
+            });
+            break;
+        case Op_::Add:
+            WithOperand_(node.lhs, [&](const auto& lhs) {
+                WithOperand_(node.rhs, [&](const auto& rhs) { rage::Add(out, lhs, rhs, pool); });
+            });
+            break;
+        case Op_::Subtract:
+            WithOperand_(node.lhs, [&](const auto& lhs) {
+                WithOperand_(node.rhs, [&](const auto& rhs) { rage::Add(out, lhs, rhs.View(std::negate<>{}), pool); });
+            });
+            break;
+        case Op_::Scale:
+            WithOperand_(node.lhs, [&](const auto& operand) { rage::Scale(out, operand, node.scalar, pool); });
+            break;
+        }
+    }
+
+    //* runs node index (unless one of its operands failed), then frees what it read and starts what it unblocked
+    void Finish_(State_& state, std::size_t index) {
+        auto& node{nodes_[index]};
+        bool skip_consumers{state.skipped[index].load(std::memory_order_relaxed)};
+        if (!skip_consumers) {
+            try {
+                Execute_(node, state.pool);
+            } catch (...) {
+                std::lock_guard lock{state.error_mutex};
+                if (!state.error)
+                    state.error = std::current_exception();
+                skip_consumers = true;
+            }
+        }
+
+        const auto release{[&](std::size_t operand) {
+            auto& read{nodes_[operand]};
+            if (read.op != Op_::Input && !read.keep
+                && state.readers_left[operand].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                ReleaseBuffer_(read);
+        }};
+        if (OperandsCount_(node) > 0)
+            release(node.lhs);
+        if (OperandsCount_(node) > 1)
+            release(node.rhs);
+
+        for (const auto consumer : node.consumers) {
+            // set before the release below, the consumer starts after it
+            if (skip_consumers)
+                state.skipped[consumer].store(true, std::memory_order_relaxed);
+            if (state.waiting_for[consumer].fetch_sub(1, std::memory_order_acq_rel) == 1 && !state.in_order)
+                state.pool.Submit([this, &state, consumer] { Finish_(state, consumer); });
+        }
+        state.nodes_left.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    Matrix<T> AcquireBuffer_(std::size_t rows, std::size_t cols) {
+        {
+            std::lock_guard lock{free_mutex_};
+            for (auto it{free_.begin()}; it != free_.end(); ++it) {
+                if (it->RowsCount() == rows && it->ColsCount() == cols) {
+                    auto buffer{std::move(*it)};
+                    free_.erase(it);
+                    return buffer;
+                }
+            }
+            ++buffers_allocated_;
+        }
+        return Matrix<T>(rows, cols);
+    }
+
+    void ReleaseBuffer_(Node_& node) {
+        if (!node.buffer)
+            return;
+        std::lock_guard lock{free_mutex_};
+        free_.push_back(std::move(*node.buffer));
+        node.buffer.reset();
+    }
+
+private:
+    std::vector<Node_> nodes_;
+    std::mutex free_mutex_;
+    std::vector<Matrix<T>> free_;
+    std::size_t buffers_allocated_{0};
+};
+
+template <typename T>
+void TaskGraph<T>::Run(ThreadPool& pool)
+{
+    // the results of the previous run are the buffers of this one
+    for (auto& node : nodes_)
+        ReleaseBuffer_(node);
+
+    State_ state{pool, pool.ThreadsCount() == 1, std::vector<std::atomic<std::size_t>>(nodes_.size()),
+                 std::vector<std::atomic<std::size_t>>(nodes_.size()), std::vector<std::atomic<bool>>(nodes_.size()),
+                 {nodes_.size()}};
+    for (std::size_t i{0}; i < nodes_.size(); ++i) {
+        state.waiting_for[i].store(OperandsCount_(nodes_[i]), std::memory_order_relaxed);
+        state.readers_left[i].store(nodes_[i].consumers.size(), std::memory_order_relaxed);
+    }
+
+    if (state.in_order) {
+        // nodes only read earlier ones: the recording order is a valid order
+        for (std::size_t i{0}; i < nodes_.size(); ++i)
+            Finish_(state, i);
+    } else {
+        for (std::size_t i{0}; i < nodes_.size(); ++i) {
+            if (OperandsCount_(nodes_[i]) == 0)
+                pool.Submit([this, &state, i] { Finish_(state, i); });
+        }
+        pool.RunUntil([&state] { return state.nodes_left.load(std::memory_order_acquire) == 0; });
+    }
+
+    if (state.error)
+        std::rethrow_exception(state.error);
+}
+
+} // namespace rage
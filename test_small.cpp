@@ -1,5 +1,35 @@
 #include "matrix.hpp"
+#include "fixed_matrix.hpp"
+#include "matrix_batch.hpp"
+#include "mapped_matrix.hpp"
+#include "csv.hpp"
+#include "mdspan_interop.hpp"
+#include "sparse_matrix.hpp"
+#include "reduce.hpp"
+#include "shared_matrix.hpp"
+#include "task_graph.hpp"
 #include <print>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <numeric>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <string>
+#include <cmath>
+#include <tuple>
+#include <limits>
+#include <vector>
+#include <coroutine>
+#include <memory>
+
+template <typename L, typename R>
+concept CanAdd = requires(const L& lhs, const R& rhs) { lhs + rhs; };
+
+template <typename L, typename R>
+concept CanMultiply = requires(const L& lhs, const R& rhs) { lhs * rhs; };
 
 template <typename T, typename M>
 void PrintMatrix(const rage::MatrixView<T, M>& mat, std::string_view title = "Matrix");
@@ -7,6 +37,35 @@ void PrintMatrix(const rage::MatrixView<T, M>& mat, std::string_view title = "Ma
 template <typename T>
 void PrintMatrix(const rage::Matrix<T>& mat, std::string_view title = "Matrix");
 
+//* the smallest coroutine type: starts right away, nobody waits for it
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Detached AwaitSum(rage::Future<rage::Matrix<double>> lhs, rage::Future<rage::Matrix<double>> rhs, rage::Matrix<double>& out, std::atomic<bool>& done);
+
+//* a number whose products throw when a side is negative, to make graph nodes fail
+struct Picky {
+    double value{};
+
+    friend Picky operator+(Picky lhs, Picky rhs) { return {lhs.value + rhs.value}; }
+    friend Picky operator-(Picky lhs, Picky rhs) { return {lhs.value - rhs.value}; }
+    Picky operator-() const { return {-value}; }
+    Picky& operator+=(Picky rhs) { value += rhs.value; return *this; }
+    friend Picky operator*(Picky lhs, Picky rhs) {
+        if (lhs.value < 0 || rhs.value < 0)
+            throw std::domain_error{"negative"};
+        return {lhs.value * rhs.value};
+    }
+    friend bool operator==(Picky, Picky) = default;
+};
+
 int main()
 {
     rage::Matrix<int> water{{{10, 20, 30}, {40, 50, 60}, {70, 80, 90}}};
@@ -69,6 +128,15 @@ int main()
     assert(flame.Add(10).Add(water).Sub(10) == water_plus_flame); // chains!!!
     flame.Sub(water);
 
+    {
+        // the value is added in the common type, like elem += val: -1 + 0.5 truncates to 0, not -1 + 0
+        rage::Matrix<int> halves{{{-1, 1}, {3, -3}}};
+        halves.Add(0.5);
+        assert((halves == rage::Matrix<int>{{{0, 1}, {3, -2}}}));
+        halves.View().Sub(0.5);
+        assert((halves == rage::Matrix<int>{{{0, 0}, {2, -2}}}));
+    }
+
     //*
     //* Views: think of it as a std::span or std::string_view, but for Matrix
 
@@ -101,6 +169,25 @@ int main()
 
     assert(water - flame.View([](const int& elem) { return -elem; }) == water_plus_flame);
     
+    {
+        // morphs keep their concrete type, chaining composes them, no std::function involved
+        auto doubled{water.View([](const int& elem) { return elem * 2; })};
+        auto doubled_plus_one{doubled.View([](const int& elem) { return elem + 1; })};
+        static_assert(std::is_empty_v<internal_impl::DefaultMorph<int>>);
+        static_assert(sizeof(rage::MatrixView<int>) == sizeof(int*) + 3 * sizeof(std::size_t));
+        static_assert(!std::is_same_v<decltype(doubled_plus_one), rage::MatrixView<int>>);
+        assert(doubled_plus_one.At(1, 2) == 121);
+
+        // a sub-view of a morphed view is still morphed
+        auto corner{doubled_plus_one.View({1, 2}, {1, 2})};
+        assert(corner.At(0, 0) == 101 && corner.At(1, 1) == 181);
+
+        const auto& const_water{water.View()};
+        auto const_corner{const_water.View({1, 2}, {1, 2})};
+        static_assert(std::is_same_v<decltype(const_corner), rage::MatrixView<const int>>);
+        assert(const_corner.At(1, 0) == 80);
+    }
+
     {
         auto f5 = flame.View([](const auto& elem){ return elem + 5; });
         assert(f5 == water);
@@ -110,10 +197,1530 @@ int main()
     }
 
 
+    //*
+    //* Lazy: +, - and * by a value build an expression, evaluated in one pass when assigned
+
+    {
+        auto expr{water + flame - water * 2};
+        static_assert(!std::is_same_v<decltype(expr), rage::Matrix<int>>);
+        assert(expr == flame - water);
+
+        rage::Matrix<int> result{expr}; // evaluated here
+        assert(result == flame - water);
+
+        const auto* buffer{result.Data().data()};
+        result = result + water; // same dimensions, written in place
+        assert(result.Data().data() == buffer);
+        assert(result == flame);
+
+        const auto materialized{(water + 1).Eval()};
+        static_assert(std::is_same_v<decltype(materialized), const rage::Matrix<int>>);
+        assert(materialized == water + 1);
+
+        result = water + 1; // same dimensions, written in place
+        auto top_row{result.View({0, 0}, {0, 2})};
+        top_row = flame.View({1, 1}, {0, 2}) + 0; // writes through the view
+        assert(result[0][0] == 35 && result[0][2] == 55 && result[1][0] == 41);
+
+        assert((water + 0) * (flame - 0) == water_times_flame); // matrix product of expressions
+
+        // overlapping sub-views: the rows still to be read are not overwritten first
+        rage::Matrix<int> rows(300, 200);
+        for (std::size_t r{0}; r < rows.RowsCount(); ++r)
+            for (std::size_t c{0}; c < rows.ColsCount(); ++c)
+                rows[r][c] = static_cast<int>(r);
+        rows.View({1, 299}, {0, 199}) = rows.View({0, 298}, {0, 199}) + 10;
+        for (std::size_t r{0}; r < rows.RowsCount(); ++r)
+            assert(rows[r][0] == static_cast<int>(r == 0 ? 0 : r + 9) && rows[r][199] == rows[r][0]);
+
+        // a temporary matrix is moved into the expression, which can outlive the statement
+        auto with_product{water * flame + water_times_flame};
+        auto nested{(with_product - 1) * 2};
+        const rage::Matrix<int> doubled_product{with_product};
+        assert(doubled_product == water_times_flame * 2);
+        assert(rage::Matrix<int>{nested} == (water_times_flame * 2 - 1) * 2);
+    }
+
+    //*
+    //* Bigger multiplications go through the blocked engine, check it against the reference loop
+
+    {
+        rage::Matrix<int> lhs(67, 45);
+        rage::Matrix<int> rhs(45, 83);
+        for (std::size_t r{0}; r < lhs.RowsCount(); ++r)
+            for (std::size_t c{0}; c < lhs.ColsCount(); ++c)
+                lhs[r][c] = static_cast<int>((r * 7 + c * 3) % 11) - 5;
+        for (std::size_t r{0}; r < rhs.RowsCount(); ++r)
+            for (std::size_t c{0}; c < rhs.ColsCount(); ++c)
+                rhs[r][c] = static_cast<int>((r * 5 + c) % 13) - 6;
+
+        assert(lhs * rhs == rage::MultiplyReference(lhs, rhs));
+
+        auto lhs_middle{lhs.View({3, 40}, {2, 30})};
+        auto rhs_middle{rhs.View({1, 29}, {4, 70})};
+        assert(lhs_middle * rhs_middle == rage::MultiplyReference(lhs_middle, rhs_middle));
+
+        auto doubled{lhs.View([](const int& elem) { return elem * 2; })};
+        assert(doubled * rhs == rage::MultiplyReference(doubled, rhs.View()));
+    }
+
+    //*
+    //* Element-wise kernels, every instruction set the CPU has must agree with the scalar loop
+
+    for (auto isa : {internal_impl::simd::Isa::Scalar, internal_impl::simd::Isa::SSE2,
+                     internal_impl::simd::Isa::AVX2, internal_impl::simd::Isa::AVX512}) {
+        internal_impl::simd::ForceIsa(isa);
+
+        rage::Matrix<double> lhs(37, 29);
+        rage::Matrix<double> rhs(37, 29);
+        for (std::size_t r{0}; r < lhs.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < lhs.ColsCount(); ++c) {
+                lhs[r][c] = static_cast<double>(r * 29 + c) * 0.5;
+                rhs[r][c] = static_cast<double>(c) - static_cast<double>(r);
+            }
+        }
+
+        const rage::Matrix<double> sum{lhs + rhs};
+        const rage::Matrix<double> plus_three{lhs + 3.0};
+        const rage::Matrix<double> times_four{lhs * 4.0};
+        for (std::size_t r{0}; r < lhs.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < lhs.ColsCount(); ++c) {
+                assert(sum[r][c] == lhs[r][c] + rhs[r][c]);
+                assert(plus_three[r][c] == lhs[r][c] + 3.0);
+                assert(times_four[r][c] == lhs[r][c] * 4.0);
+            }
+        }
+
+        std::vector<double> difference(lhs.Size());
+        internal_impl::simd::Sub(lhs.RawData(), rhs.RawData(), difference.data(), difference.size());
+        for (std::size_t i{0}; i < difference.size(); ++i)
+            assert(difference[i] == lhs.RawData()[i] - rhs.RawData()[i]);
+
+        // strided: sub-views are done row by row
+        auto lhs_middle{lhs.View({2, 30}, {1, 27})};
+        auto rhs_middle{rhs.View({5, 33}, {0, 26})};
+        const auto middle_sum{(lhs_middle + rhs_middle).Eval()};
+        for (std::size_t r{0}; r < middle_sum.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < middle_sum.ColsCount(); ++c)
+                assert(middle_sum[r][c] == lhs[r + 2][c + 1] + rhs[r + 5][c]);
+        }
+
+        lhs_middle.Add(1.0);
+        assert(lhs[2][1] == 29.5 + 1.0 && lhs[0][0] == 0.0 && lhs[2][28] == 43.0);
+    }
+    internal_impl::simd::ForceIsa(internal_impl::simd::DetectIsa());
+
+    //*
+    //* Thread pool: the parallel paths must give the same results as the serial ones
+
+    {
+        rage::ThreadPool pool{4};
+        assert(pool.ThreadsCount() == 4);
+
+        rage::Matrix<long> lhs(200, 150);
+        rage::Matrix<long> rhs(150, 170);
+        for (std::size_t r{0}; r < lhs.RowsCount(); ++r)
+            for (std::size_t c{0}; c < lhs.ColsCount(); ++c)
+                lhs[r][c] = static_cast<long>((r * 3 + c * 7) % 17) - 8;
+        for (std::size_t r{0}; r < rhs.RowsCount(); ++r)
+            for (std::size_t c{0}; c < rhs.ColsCount(); ++c)
+                rhs[r][c] = static_cast<long>((r + c * 5) % 19) - 9;
+        assert(rage::Multiply(lhs, rhs, pool) == rage::MultiplyReference(lhs, rhs));
+
+        rage::Matrix<double> a(300, 300);
+        rage::Matrix<double> b(300, 300);
+        for (std::size_t r{0}; r < a.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < a.ColsCount(); ++c) {
+                a[r][c] = static_cast<double>(r) + 0.25;
+                b[r][c] = static_cast<double>(c) * 2.0;
+            }
+        }
+        const auto sum{(a + b).Eval(pool)};
+        const auto scaled{(a * 2.0 - 1.0).Eval(pool)}; // no kernel for this one, fused loop in row blocks
+        a.View().Add(b.View());
+        for (std::size_t r{0}; r < a.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < a.ColsCount(); ++c) {
+                assert(sum[r][c] == static_cast<double>(r) + 0.25 + static_cast<double>(c) * 2.0);
+                assert(scaled[r][c] == (static_cast<double>(r) + 0.25) * 2.0 - 1.0);
+                assert(a[r][c] == sum[r][c]);
+            }
+        }
+
+        std::atomic<std::size_t> total{0};
+        pool.ParallelFor(0, 1000, 10, [&](std::size_t first, std::size_t last) {
+            // nested calls run on the same pool, the waiting thread helps instead of blocking
+            pool.ParallelFor(first, last, 1, [&](std::size_t f, std::size_t l) {
+                for (auto i{f}; i < l; ++i)
+                    total += i;
+            });
+        });
+        assert(total == 999 * 1000 / 2);
+
+        bool caught{false};
+        try {
+            pool.ParallelFor(0, 100, 1, [](std::size_t first, std::size_t last) {
+                if (first <= 50 && 50 < last)
+                    throw std::runtime_error{"chunk failed"};
+            });
+        } catch (const std::runtime_error&) {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    //*
+    //* Storage: aligned by default, optionally padded rows and other allocators
+
+    {
+        rage::Matrix<double> plain(5, 7);
+        assert(reinterpret_cast<std::uintptr_t>(plain.RawData()) % 64 == 0);
+        assert(plain.LeadingDimension() == 7);
+
+        static_assert(rage::PaddedLeadingDimension<double>(7) == 8);
+        static_assert(rage::PaddedLeadingDimension<double>(64) == 72); // 512 bytes, one more cache line
+        static_assert(rage::PaddedLeadingDimension<float>(100) == 112);
+
+        const std::size_t rows{70};
+        const std::size_t cols{64};
+        rage::Matrix<double> padded(rows, cols, rage::PaddedLeadingDimension<double>(cols));
+        rage::Matrix<double> other(rows, cols);
+        assert(padded.LeadingDimension() == 72 && padded.View().LeadingDimension() == 72);
+        assert(!padded.View().IsContiguous());
+        for (std::size_t r{0}; r < rows; ++r) {
+            assert(reinterpret_cast<std::uintptr_t>(padded[r].data()) % 64 == 0);
+            for (std::size_t c{0}; c < cols; ++c) {
+                padded[r][c] = static_cast<double>(r * cols + c);
+                other[r][c] = static_cast<double>(r * cols + c);
+            }
+        }
+
+        padded.RawData()[cols] = -1.0; // padding after the first row
+        assert(padded == other);
+        assert(padded.Col(3)[69] == other[69][3]);
+        assert(padded.View({10, 20}, {5, 9}) == other.View({10, 20}, {5, 9}));
+
+        const rage::Matrix<double> sum{padded + other};
+        padded = padded * 2.0; // in place, through the padded stride
+        assert(padded == sum);
+
+        padded.Add(other);
+        assert(padded == sum + other);
+        assert(padded.RawData()[cols] == -1.0); // the kernels leave the padding alone
+
+        rage::Matrix<double> square(cols, 30, rage::PaddedLeadingDimension<double>(30));
+        for (std::size_t r{0}; r < square.RowsCount(); ++r)
+            for (std::size_t c{0}; c < square.ColsCount(); ++c)
+                square[r][c] = static_cast<double>((r + 2 * c) % 7);
+        assert(other * square == rage::MultiplyReference(other, square));
+        assert(sum * square == rage::MultiplyReference(sum, square));
+
+        rage::Matrix<float, rage::HugePageAllocator<float>> huge(1024, 1024); // 4 MiB, huge page backed
+        rage::Matrix<float, rage::AlignedAllocator<float, 128>> wide(1024, 1024);
+        assert(reinterpret_cast<std::uintptr_t>(huge.RawData()) % rage::HugePageAllocator<float>::huge_page_size == 0);
+        assert(reinterpret_cast<std::uintptr_t>(wide.RawData()) % 128 == 0);
+        for (std::size_t r{0}; r < huge.RowsCount(); ++r) {
+            std::fill(huge[r].begin(), huge[r].end(), 1.5f);
+            std::fill(wide[r].begin(), wide[r].end(), 2.0f);
+        }
+        huge = huge + wide;
+        assert(huge[1023][1023] == 3.5f && huge == wide + 1.5f);
+    }
+
+    //*
+    //* Fixed size matrices: on the stack, dimensions checked at compile time
+
+    {
+        constexpr rage::FixedMatrix<int, 2, 3> a{{{1, 2, 3}, {4, 5, 6}}};
+        constexpr rage::FixedMatrix<int, 3, 2> b{{{7, 8}, {9, 10}, {11, 12}}};
+
+        constexpr auto ab{a * b};
+        static_assert(std::is_same_v<decltype(ab), const rage::FixedMatrix<int, 2, 2>>);
+        static_assert(ab.At(0, 0) == 58 && ab.At(0, 1) == 64 && ab.At(1, 0) == 139 && ab.At(1, 1) == 154);
+        static_assert(a + a == a * 2 && 10 - a == -1 * (a - 10));
+        static_assert(sizeof(rage::FixedMatrix<float, 4, 4>) == 16 * sizeof(float));
+
+        static_assert(CanAdd<decltype(a), decltype(a)> && !CanAdd<decltype(a), decltype(b)>);
+        static_assert(CanMultiply<decltype(a), decltype(b)> && !CanMultiply<decltype(a), decltype(a)>);
+
+        // a 4x4 transform: rotate 90 degrees around z, then move by (1, 2, 3); four times is a full turn
+        rage::FixedMatrix<float, 4, 4> transform{{{0, -1, 0, 1}, {1, 0, 0, 2}, {0, 0, 1, 3}, {0, 0, 0, 1}}};
+        rage::FixedMatrix<float, 4, 1> point{{{1}, {0}, {0}, {1}}};
+        for (int i{0}; i < 4; ++i)
+            point = transform * point;
+        assert((point == rage::FixedMatrix<float, 4, 1>{{{1}, {0}, {12}, {1}}}));
+        assert((transform * rage::FixedMatrix<float, 4, 4>::Identity() == transform));
+
+        // with the dynamic types
+        rage::Matrix<int> dynamic(3, 2);
+        for (std::size_t r{0}; r < 3; ++r)
+            std::copy(b[r].begin(), b[r].end(), dynamic[r].begin());
+        assert(a * dynamic == ab);
+        assert(a.View() * b == ab);
+        assert(dynamic == b && b == dynamic.View());
+        assert(b + dynamic == (b * 2).ToMatrix());
+
+        // a temporary FixedMatrix lives in the expression, evaluated after the statement that built it
+        rage::Matrix<int> two_by_two{{{1, 2}, {3, 4}}};
+        auto doubled_plus{(ab * 2) + two_by_two};
+        rage::Matrix<int> doubled_sum{doubled_plus};
+        assert(doubled_sum.At(0, 0) == ab.At(0, 0) * 2 + 1 && doubled_sum.At(1, 1) == ab.At(1, 1) * 2 + 4);
+        assert(two_by_two + (ab * 2) == doubled_sum);
+
+        rage::FixedMatrix<int, 2, 2> from_expression{ab.View() + 1};
+        assert(from_expression.At(1, 1) == 155);
+        from_expression.Add(ab).Sub(1);
+        assert(from_expression == ab * 2);
+
+        int total{0};
+        for (const auto& row : a)
+            for (const auto& elem : row)
+                total += elem;
+        assert(total == 21 && a.Col(2)[1] == 6);
+        assert((a.View({1, 1}, {1, 2}) == rage::FixedMatrix<int, 1, 2>{{{5, 6}}}));
+    }
+
+    //*
+    //* Layouts: column-major storage and zero-copy transposed views
+
+    {
+        using ColMajorMatrix = rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor>;
+
+        ColMajorMatrix cm(5, 3);
+        rage::Matrix<double> rm(5, 3);
+        for (std::size_t r{0}; r < 5; ++r) {
+            for (std::size_t c{0}; c < 3; ++c) {
+                cm.At(r, c) = static_cast<double>(r * 10 + c);
+                rm[r][c] = static_cast<double>(r * 10 + c);
+            }
+        }
+        assert(cm.RawData()[1] == 10.0 && cm.RawData()[5] == 1.0); // columns are contiguous
+        assert(cm == rm && rm == cm.View());
+        assert(cm.Col(2).size() == 5 && cm.Col(2)[4] == 42.0 && cm.Row(4)[2] == 42.0);
+
+        double total{0.0};
+        std::size_t rows_seen{0};
+        for (const auto& row : cm) {
+            for (std::size_t c{0}; c < row.size(); ++c)
+                total += row[c];
+            ++rows_seen;
+        }
+        assert(rows_seen == 5 && total == 315.0);
+
+        // element-wise: kernels when the layouts match, the generic loop when they don't
+        const ColMajorMatrix twice{cm + cm};
+        assert(twice == rm * 2.0);
+        const ColMajorMatrix mixed{cm.View() - rm.View()};
+        assert(mixed == rm * 0.0);
+        cm.Add(1.0).Add(rm);
+        assert(cm == rm * 2.0 + 1.0);
+
+        ColMajorMatrix padded(70, 64, rage::PaddedLeadingDimension<double>(70));
+        rage::Matrix<double> reference(70, 64);
+        for (std::size_t r{0}; r < 70; ++r)
+            for (std::size_t c{0}; c < 64; ++c)
+                reference[r][c] = padded.At(r, c) = static_cast<double>((r * 3 + c) % 17);
+        assert(padded.LeadingDimension() == 72 && padded.Col(5).data() == padded.RawData() + 5 * 72);
+        padded = padded * 3.0;
+        assert(padded == reference * 3.0);
+
+        // transposed views: dimensions and layout swap, the buffer stays
+        auto rm_t{rm.Transposed()};
+        static_assert(std::is_same_v<decltype(rm_t), rage::MatrixView<double, internal_impl::DefaultMorph<double>, rage::ColMajor>>);
+        assert(rm_t.RowsCount() == 3 && rm_t.ColsCount() == 5 && rm_t.RawData() == rm.RawData());
+        assert(rm_t.At(2, 4) == rm[4][2] && rm_t.Transposed() == rm);
+        rm_t.At(0, 1) = -1.0;
+        assert(rm[1][0] == -1.0);
+
+        auto middle_t{rm.View({1, 3}, {1, 2}).Transposed()};
+        assert(middle_t.RowsCount() == 2 && middle_t.ColsCount() == 3 && middle_t.At(1, 2) == rm[3][2]);
+
+        rage::Matrix<double> lhs(37, 53);
+        rage::Matrix<double> rhs(41, 53);
+        for (std::size_t r{0}; r < lhs.RowsCount(); ++r)
+            for (std::size_t c{0}; c < lhs.ColsCount(); ++c)
+                lhs[r][c] = static_cast<double>((r * 7 + c * 3) % 11) - 5;
+        for (std::size_t r{0}; r < rhs.RowsCount(); ++r)
+            for (std::size_t c{0}; c < rhs.ColsCount(); ++c)
+                rhs[r][c] = static_cast<double>((r * 5 + c) % 13) - 6;
+
+        const auto product{lhs * rhs.Transposed()};
+        assert(product.RowsCount() == 37 && product.ColsCount() == 41);
+        assert(product == rage::MultiplyReference(lhs.View(), rhs.Transposed()));
+        assert(lhs.Transposed() * lhs == rage::MultiplyReference(lhs.Transposed(), lhs.View()));
+        assert(padded * padded.Transposed() == rage::MultiplyReference(padded.View(), padded.Transposed()));
+
+        const rage::FixedMatrix<int, 2, 3> fixed{{{1, 2, 3}, {4, 5, 6}}};
+        assert((fixed * fixed.Transposed() == rage::FixedMatrix<int, 2, 2>{{{14, 32}, {32, 77}}}));
+
+        // reading a matrix transposed while assigning to it does not see the elements already written
+        rage::Matrix<long> square(300, 300);
+        for (std::size_t r{0}; r < square.RowsCount(); ++r)
+            for (std::size_t c{0}; c < square.ColsCount(); ++c)
+                square[r][c] = static_cast<long>(r * 1000 + c);
+        const auto* square_data{square.RawData()};
+        square = square + square.Transposed();
+        assert(square.RawData() != square_data); // through a new buffer
+        for (std::size_t r{0}; r < square.RowsCount(); ++r)
+            for (std::size_t c{0}; c < square.ColsCount(); ++c)
+                assert(square[r][c] == static_cast<long>(r * 1000 + c + c * 1000 + r));
+        square_data = square.RawData();
+        square = square + square; // same positions, in place
+        assert(square.RawData() == square_data && square[299][0] == 2 * (299 * 1000 + 299));
+    }
+
+    //*
+    //* Transposition: out of place into a new matrix, or in place
+
+    for (auto isa : {internal_impl::simd::Isa::Scalar, internal_impl::simd::Isa::SSE2, internal_impl::simd::Isa::AVX2}) {
+        internal_impl::simd::ForceIsa(isa);
+
+        rage::Matrix<float> floats(75, 133, rage::PaddedLeadingDimension<float>(133));
+        rage::Matrix<double> doubles(75, 133);
+        rage::Matrix<int> ints(75, 133);
+        for (std::size_t r{0}; r < 75; ++r) {
+            for (std::size_t c{0}; c < 133; ++c) {
+                floats[r][c] = static_cast<float>(r * 1000 + c);
+                doubles[r][c] = static_cast<double>(r * 1000 + c);
+                ints[r][c] = static_cast<int>(r * 1000 + c);
+            }
+        }
+
+        const auto floats_t{rage::Transpose(floats)};
+        const auto doubles_t{rage::Transpose(doubles)};
+        assert(floats_t.RowsCount() == 133 && floats_t.ColsCount() == 75);
+        assert(floats_t == floats.Transposed() && doubles_t == doubles.Transposed());
+        assert(rage::Transpose(ints) == ints.Transposed());
+        assert(rage::Transpose(doubles.View({3, 60}, {7, 99})) == doubles.View({3, 60}, {7, 99}).Transposed());
+        assert(rage::Transpose(doubles_t.Transposed()) == doubles_t); // column-major source
+        assert(rage::Transpose(ints.View([](const int& elem) { return elem * 2; })) == rage::Transpose(ints) * 2);
+
+        // square, padded: swapped across the diagonal, the leading dimension stays
+        rage::Matrix<double> square(70, 70, rage::PaddedLeadingDimension<double>(70));
+        for (std::size_t r{0}; r < 70; ++r)
+            for (std::size_t c{0}; c < 70; ++c)
+                square[r][c] = static_cast<double>(r * 100 + c);
+        const auto square_t{rage::Transpose(square)};
+        square.TransposeInPlace();
+        assert(square == square_t && square.LeadingDimension() == 72);
+        assert(!square.ReinterpretDimensions(35, 140));
+
+        // other shapes: cycle following when unpadded, a new buffer when padded
+        doubles.TransposeInPlace();
+        assert(doubles == doubles_t && doubles.LeadingDimension() == 75);
+        assert(doubles.ReinterpretDimensions(75, 133) && doubles.View().IsContiguous());
+        floats.TransposeInPlace();
+        assert(floats == floats_t && floats.LeadingDimension() == 75);
+        floats.TransposeInPlace().TransposeInPlace();
+        assert(floats == floats_t);
+
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> col_major(9, 4);
+        for (std::size_t r{0}; r < 9; ++r)
+            for (std::size_t c{0}; c < 4; ++c)
+                col_major.At(r, c) = static_cast<double>(r * 10 + c);
+        const auto col_major_t{rage::Transpose(col_major)};
+        col_major.TransposeInPlace();
+        assert(col_major.RowsCount() == 4 && col_major == col_major_t);
+    }
+    internal_impl::simd::ForceIsa(internal_impl::simd::DetectIsa());
+
+    //*
+    //* Iterators: random access rows and columns, contiguous elements
+
+    {
+        using Rows = decltype(std::declval<rage::Matrix<int>&>().begin());
+        using ColMajorRows = decltype(std::declval<rage::Matrix<int, rage::AlignedAllocator<int>, rage::ColMajor>&>().begin());
+        using Col = decltype(std::declval<rage::Matrix<int>&>().Col(0).begin());
+        static_assert(std::random_access_iterator<Rows> && std::sized_sentinel_for<Rows, Rows>);
+        static_assert(std::random_access_iterator<ColMajorRows> && std::random_access_iterator<Col>);
+        static_assert(std::ranges::random_access_range<rage::Matrix<int>> && std::ranges::sized_range<rage::Matrix<int>>);
+        static_assert(std::ranges::contiguous_range<decltype(std::declval<rage::Matrix<int>&>().Elements())>);
+        static_assert(std::ranges::contiguous_range<decltype(std::declval<rage::MatrixView<int>&>().Elements())>);
+
+        rage::Matrix<int> m(6, 4);
+        std::iota(m.Elements().begin(), m.Elements().end(), 0);
+        assert(m[2][3] == 11 && std::ranges::size(m) == 6 && std::ranges::distance(m.Col(1)) == 6);
+
+        auto rows{m.begin()};
+        assert(rows[5][0] == 20 && (*(rows + 3)).size() == 4 && (*(m.end() - 1))[1] == 21);
+        assert(m.end() - m.begin() == 6 && rows < m.end());
+
+        std::ranges::sort(m.Col(1), std::greater<>{});
+        assert(m[0][1] == 21 && m[5][1] == 1 && m[0][0] == 0);
+        assert(std::ranges::max(m.Row(2)) == 13);
+
+        auto doubled{m.View([](const int& elem) { return elem * 2; })};
+        static_assert(std::ranges::random_access_range<decltype(doubled)>);
+        assert((*(doubled.begin() + 4))[3] == 38 && *(doubled.Col(0).begin() + 5) == 40);
+
+        std::ranges::fill(m.View({1, 2}, {0, 3}).Elements(), 7); // two whole rows are contiguous
+        assert(m[1][0] == 7 && m[2][3] == 7 && m[3][0] == 12);
+        std::ranges::transform(m.Elements(), m.Elements().begin(), [](int elem) { return elem + 1; });
+        assert(m[0][0] == 1 && m[1][1] == 8);
+
+        rage::Matrix<int, rage::AlignedAllocator<int>, rage::ColMajor> cm(3, 5);
+        std::iota(cm.Elements().begin(), cm.Elements().end(), 0);
+        assert(cm.At(2, 0) == 2 && cm.At(0, 1) == 3);
+        assert((*(cm.begin() + 2))[4] == 14 && cm.end() - cm.begin() == 3);
+
+        const rage::FixedMatrix<int, 2, 2> fixed{{{4, 3}, {2, 1}}};
+        assert(std::ranges::is_sorted(fixed.Elements(), std::greater<>{}));
+    }
+
+    //*
+    //* Matrix-vector products: y = A x and y = A^T x without building an N x 1 matrix
+
+    for (auto isa : {internal_impl::simd::Isa::Scalar, internal_impl::simd::Isa::SSE2,
+                     internal_impl::simd::Isa::AVX2, internal_impl::simd::Isa::AVX512}) {
+        internal_impl::simd::ForceIsa(isa);
+
+        rage::Matrix<double> a(203, 77, rage::PaddedLeadingDimension<double>(77));
+        rage::Matrix<double> x_matrix(77, 1);
+        rage::Matrix<double> t_matrix(203, 1);
+        std::vector<double> x(77);
+        std::vector<double> t(203);
+        for (std::size_t r{0}; r < a.RowsCount(); ++r)
+            for (std::size_t c{0}; c < a.ColsCount(); ++c)
+                a[r][c] = static_cast<double>((r * 7 + c * 3) % 11) - 5;
+        for (std::size_t i{0}; i < x.size(); ++i)
+            x[i] = x_matrix[i][0] = static_cast<double>(i % 5) - 2;
+        for (std::size_t i{0}; i < t.size(); ++i)
+            t[i] = t_matrix[i][0] = static_cast<double>(i % 7) - 3;
+
+        const auto same{[](const std::vector<double>& y, const rage::Matrix<double>& expected) {
+            if (y.size() != expected.RowsCount()) return false;
+            for (std::size_t i{0}; i < y.size(); ++i)
+                if (y[i] != expected[i][0]) return false;
+            return true;
+        }};
+
+        const auto ax{rage::Multiply(a, std::span<const double>{x})};
+        assert(same(ax, rage::MultiplyReference(a, x_matrix)));
+        assert(same(rage::MultiplyTransposed(a, t), rage::MultiplyReference(a.Transposed(), t_matrix.View())));
+
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> a_col_major(a);
+        assert(same(rage::Multiply(a_col_major, x), rage::MultiplyReference(a, x_matrix)));
+        assert(same(rage::MultiplyTransposed(a_col_major, t), rage::MultiplyReference(a.Transposed(), t_matrix.View())));
+
+        // morphed views, expressions and mixed types go element by element
+        auto halved{a.View([](const double& elem) { return elem / 2; })};
+        assert(same(rage::Multiply(halved * 2.0, x), rage::MultiplyReference(a, x_matrix)));
+        assert(same(rage::MultiplyTransposed(a + a, t), rage::MultiplyReference((a + a).Eval().Transposed(), t_matrix.View())));
+        const std::array<int, 3> small_x{1, 2, 3};
+        const rage::FixedMatrix<int, 2, 3> small{{{1, 0, 2}, {-1, 3, 1}}};
+        assert((rage::Multiply(small, small_x) == std::vector<int>{7, 8}));
+        assert((rage::Multiply(small, std::vector<double>{0.5, 0.0, 1.0}) == std::vector<double>{2.5, 0.5}));
+    }
+    internal_impl::simd::ForceIsa(internal_impl::simd::DetectIsa());
+
+    //*
+    //* Batches: many same-shaped matrices in one buffer
+
+    {
+        rage::MatrixBatch<float> a(1000, 3, 4);
+        rage::MatrixBatch<float> b(1000, 4, 2);
+        assert(a.Count() == 1000 && a.MatrixSize() == 12 && a.Elements().size() == 12000);
+        assert(a.MatrixData(1) == a.RawData() + 12 && a[1].RawData() == a.MatrixData(1));
+        for (std::size_t i{0}; i < a.Elements().size(); ++i)
+            a.Elements()[i] = static_cast<float>(i % 7) - 3;
+        for (std::size_t i{0}; i < b.Elements().size(); ++i)
+            b.Elements()[i] = static_cast<float>(i % 5) - 2;
+
+        const auto product{rage::Multiply(a, b)};
+        assert(product.Count() == 1000 && product.RowsCount() == 3 && product.ColsCount() == 2);
+        for (std::size_t i : {std::size_t{0}, std::size_t{1}, std::size_t{499}, std::size_t{999}})
+            assert(product[i] == rage::MultiplyReference(a[i], b[i]));
+
+        rage::Matrix<float> first(3, 4);
+        for (std::size_t r{0}; r < 3; ++r)
+            std::copy(a[0].Row(r).begin(), a[0].Row(r).end(), first[r].begin());
+
+        a.Add(a).Scale(0.5f).Add(1.0f).Sub(1.0f);
+        assert(a[0] == first);
+        a[0] = a[0] + 1.0f; // a view like any other
+        assert(a[0] == first + 1.0f && a[1].At(0, 0) == 2.0f);
+        a.Sub(a);
+        assert(std::ranges::all_of(a.Elements(), [](float elem) { return elem == 0.0f; }));
+        rage::MatrixBatch<float> ones_twos(1000, 3, 4);
+        for (std::size_t i{0}; i < ones_twos.Elements().size(); ++i)
+            ones_twos.Elements()[i] = static_cast<float>(i % 3);
+        a.Sub(ones_twos);
+        for (std::size_t i{0}; i < a.Elements().size(); ++i)
+            assert(a.Elements()[i] == -static_cast<float>(i % 3));
+    }
+
+    //*
+    //* Views over caller owned memory
+
+    {
+        // 3 x 4 in a buffer with lines of 6, e.g. a frame from somewhere else
+        std::vector<float> frame(3 * 6, -1.0f);
+        for (std::size_t r{0}; r < 3; ++r) {
+            for (std::size_t c{0}; c < 4; ++c)
+                frame[r * 6 + c] = static_cast<float>(r * 4 + c);
+        }
+        auto foreign{rage::MatrixView<float>::FromBuffer(std::span{frame}, 3, 4, 6)};
+        assert(foreign.RowsCount() == 3 && foreign.ColsCount() == 4 && foreign.LeadingDimension() == 6);
+        assert(foreign.RawData() == frame.data() && foreign.At(2, 3) == 11.0f);
+
+        rage::Matrix<float> owned(3, 4);
+        for (std::size_t r{0}; r < 3; ++r) {
+            for (std::size_t c{0}; c < 4; ++c)
+                owned.At(r, c) = static_cast<float>(r * 4 + c);
+        }
+        assert(foreign == owned);
+        rage::Matrix<float> sum = foreign + owned;
+        assert(sum.At(2, 3) == 22.0f);
+        assert(foreign * owned.Transposed() == rage::MultiplyReference(owned.View(), owned.Transposed()));
+        assert(rage::Transpose(foreign) == owned.Transposed());
+
+        foreign.Add(1.0f); // writes go to the caller's buffer, the padding is left alone
+        assert(frame[0] == 1.0f && frame[2 * 6 + 3] == 12.0f && frame[4] == -1.0f && frame[5] == -1.0f);
+        foreign = foreign * 2.0f;
+        assert(frame[2 * 6 + 3] == 24.0f);
+
+        const std::array<int, 6> columns{1, 2, 3, 4, 5, 6}; // 2 x 3, column-major, unpadded
+        const auto col_major{rage::MatrixView<const int, internal_impl::DefaultMorph<const int>, rage::ColMajor>::FromBuffer(columns.data(), 2, 3)};
+        assert(col_major.At(0, 1) == 3 && col_major.At(1, 2) == 6 && col_major.Col(2)[1] == 6);
+        assert((rage::Multiply(col_major, std::vector<int>{1, 1, 1}) == std::vector<int>{9, 12}));
+
+#if defined(__cpp_lib_mdspan)
+        const auto md{rage::ToMdspan(foreign)};
+        assert(md.extent(0) == 3 && md.extent(1) == 4 && md.stride(0) == 6 && (md[2, 3] == 24.0f));
+        assert(rage::FromMdspan(md) == foreign && rage::FromMdspan(md).RawData() == frame.data());
+        assert(rage::FromMdspan<rage::ColMajor>(rage::ToMdspan(col_major)) == col_major);
+        std::mdspan<const int, std::dextents<std::size_t, 2>> right{columns.data(), 3, 2};
+        assert(rage::FromMdspan(right).At(2, 1) == 6);
+        std::mdspan<const int, std::dextents<std::size_t, 2>, std::layout_left> left{columns.data(), 2, 3};
+        assert(rage::FromMdspan(left) == col_major);
+#endif
+    }
+
+    //*
+    //* Sparse matrices
+
+    {
+        // 4 x 5, triplets out of order with a duplicate
+        rage::SparseBuilder<double> builder(4, 5);
+        builder.Add(3, 4, 1.0).Add(0, 1, 2.0).Add(2, 0, -1.0).Add(0, 3, 4.0).Add(3, 4, 2.0).Add(1, 2, 5.0).Add(0, 0, 0.5);
+        const auto csr{builder.Build()};
+        assert(csr.RowsCount() == 4 && csr.ColsCount() == 5 && csr.NonZerosCount() == 6);
+        assert(std::ranges::equal(csr.Offsets(), std::vector<std::size_t>{0, 3, 4, 5, 6}));
+        assert(std::ranges::equal(csr.Indices(), std::vector<std::size_t>{0, 1, 3, 2, 0, 4}));
+        assert(csr.At(3, 4) == 3.0 && csr.At(0, 3) == 4.0 && csr.At(1, 1) == 0.0);
+
+        const auto dense{csr.ToDense()};
+        assert(dense.At(0, 1) == 2.0 && dense.At(3, 4) == 3.0 && dense.At(2, 2) == 0.0);
+        const rage::CsrMatrix<double> from_dense{dense};
+        assert(std::ranges::equal(from_dense.Values(), csr.Values()) && std::ranges::equal(from_dense.Indices(), csr.Indices()));
+
+        const rage::CscMatrix<double> csc{csr};
+        assert(std::ranges::equal(csc.Offsets(), std::vector<std::size_t>{0, 2, 3, 4, 5, 6}));
+        assert(std::ranges::equal(csc.Indices(), std::vector<std::size_t>{0, 2, 0, 1, 0, 3}));
+        assert(csc.ToDense() == dense && builder.Build<rage::ColMajor>().ToDense() == dense);
+        assert(rage::CsrMatrix<double>{csc}.ToDense() == dense);
+
+        const std::vector<double> x{1, 2, 3, 4, 5};
+        const auto y{rage::Multiply(dense, x)};
+        assert(rage::Multiply(csr, x) == y && rage::Multiply(csc, x) == y);
+
+        rage::Matrix<double> b(5, 3);
+        for (std::size_t r{0}; r < 5; ++r) {
+            for (std::size_t c{0}; c < 3; ++c)
+                b.At(r, c) = static_cast<double>(r * 3 + c) - 4;
+        }
+        const auto expected{rage::MultiplyReference(dense.View(), b.View())};
+        assert(rage::Multiply(csr, b) == expected && rage::Multiply(csc, b) == expected);
+        assert(rage::Multiply(csr, b.View([](const double& elem) { return elem; })) == expected); // element by element
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> b_col_major(b);
+        assert(rage::Multiply(csr, b_col_major) == expected);
+
+        const auto b_t{rage::Transpose(b)}; // 3 x 5
+        const auto expected_t{rage::MultiplyReference(b_t.View(), dense.Transposed())};
+        const rage::CsrMatrix<double> csr_t{dense.Transposed()};
+        const rage::CscMatrix<double> csc_t{dense.Transposed()};
+        assert(rage::Multiply(b_t, csr_t) == expected_t && rage::Multiply(b_t, csc_t) == expected_t);
+
+        // big and skewed, the blocks are balanced on non-zeros
+        const std::size_t n{3000};
+        rage::SparseBuilder<float> big_builder(n, n);
+        for (std::size_t r{0}; r < n; ++r) {
+            for (std::size_t c{r % 7}; c < (r < 10 ? n : std::size_t{40}); c += 7)
+                big_builder.Add(r, c, static_cast<float>((r + c) % 5) - 2);
+        }
+        const auto big{big_builder.Build()};
+        std::vector<float> ones(n, 1.0f);
+        rage::ThreadPool pool{4};
+        const auto big_y{rage::Multiply(big, ones, pool)};
+        rage::ThreadPool single{1};
+        assert(big_y == rage::Multiply(big, ones, single));
+        assert(big_y == rage::Multiply(rage::CscMatrix<float>{big}, ones));
+
+        // enough non-zeros for CSC x vector to go parallel, through CSR: the same sums in the same order
+        rage::SparseBuilder<float> band_builder(n, n);
+        for (std::size_t r{0}; r < n; ++r) {
+            for (std::size_t c{r >= 8 ? r - 8 : 0}; c < std::min(r + 9, n); ++c)
+                band_builder.Add(r, c, static_cast<float>((r * 3 + c) % 7) * 0.3f - 1.0f);
+        }
+        const rage::CscMatrix<float> band{band_builder.Build()};
+        assert(band.NonZerosCount() >= rage::ParallelThresholds::elementwise);
+        std::vector<float> tenths(n);
+        for (std::size_t i{0}; i < n; ++i)
+            tenths[i] = static_cast<float>(i % 10) * 0.1f;
+        assert(rage::Multiply(band, tenths, pool) == rage::Multiply(band, tenths, single));
+        assert(rage::Multiply(band, tenths, pool) == rage::Multiply(rage::CsrMatrix<float>{band}, tenths, pool));
+        rage::Matrix<float> tall(n, 4);
+        std::fill(tall.Data().begin(), tall.Data().end(), 1.0f);
+        const auto product{rage::Multiply(big, tall, pool)};
+        for (std::size_t r : {std::size_t{0}, std::size_t{9}, std::size_t{10}, n - 1})
+            assert(product.At(r, 3) == big_y[r]);
+    }
+
+    //*
+    //* Strassen-Winograd
+
+    {
+        // odd and uneven sides, a tiny cutoff so that several levels and every peeling case run
+        rage::Matrix<long> a(37, 41);
+        rage::Matrix<long> b(41, 29);
+        for (std::size_t r{0}; r < 37; ++r) {
+            for (std::size_t c{0}; c < 41; ++c)
+                a.At(r, c) = static_cast<long>((r * 7 + c * 3) % 11) - 5;
+        }
+        for (std::size_t r{0}; r < 41; ++r) {
+            for (std::size_t c{0}; c < 29; ++c)
+                b.At(r, c) = static_cast<long>((r * 5 + c) % 13) - 6;
+        }
+        const auto expected{rage::MultiplyReference(a, b)};
+        rage::ThreadPool pool{3};
+        for (std::size_t cutoff : {std::size_t{2}, std::size_t{4}, std::size_t{9}, std::size_t{64}})
+            assert(rage::MultiplyStrassen(a, b, pool, cutoff) == expected); // exact on integers
+        assert(internal_impl::StrassenWorkspace(64, 64, 64, 8) == 2 * (32 * 32 + 16 * 16 + 8 * 8 + 4 * 4));
+
+        // operands that are not row-major memory are copied first
+        rage::Matrix<long, rage::AlignedAllocator<long>, rage::ColMajor> b_col_major(b);
+        assert(rage::MultiplyStrassen(a, b_col_major, pool, 4) == expected);
+        assert(rage::MultiplyStrassen(a.View([](const long& elem) { return elem * 2; }), b, pool, 4) == rage::MultiplyReference((a + a).Eval().View(), b.View()));
+
+        rage::Matrix<double> square(96, 96);
+        for (std::size_t r{0}; r < 96; ++r) {
+            for (std::size_t c{0}; c < 96; ++c)
+                square.At(r, c) = static_cast<double>((r * 5 + c * 3) % 17) / 17 - 0.5;
+        }
+        const auto reference{rage::MultiplyReference(square, square)};
+        const auto close{[&reference](const rage::Matrix<double>& result) {
+            for (std::size_t r{0}; r < 96; ++r) {
+                for (std::size_t c{0}; c < 96; ++c) {
+                    if (std::abs(result.At(r, c) - reference.At(r, c)) > 1e-12)
+                        return false;
+                }
+            }
+            return true;
+        }};
+        assert(close(rage::MultiplyStrassen(square, square, pool, 16)));
+
+        // operator* switches over by itself above the automatic threshold
+        const auto previous{std::pair{rage::StrassenThresholds::automatic, rage::StrassenThresholds::cutoff}};
+        rage::StrassenThresholds::automatic = 64;
+        rage::StrassenThresholds::cutoff = 16;
+        assert(close(square * square));
+        std::tie(rage::StrassenThresholds::automatic, rage::StrassenThresholds::cutoff) = previous;
+    }
+
+    //*
+    //* Equality fast paths and ApproxEqual
+
+    for (auto isa : {internal_impl::simd::Isa::Scalar, internal_impl::simd::Isa::SSE2,
+                     internal_impl::simd::Isa::AVX2, internal_impl::simd::Isa::AVX512}) {
+        internal_impl::simd::ForceIsa(isa);
+
+        std::vector<float> x(75);
+        for (std::size_t i{0}; i < x.size(); ++i)
+            x[i] = static_cast<float>(i) - 30;
+        // every position, so that the differences fall in the vectors and in the tails
+        for (std::size_t i{0}; i < x.size(); ++i) {
+            auto y{x};
+            y[i] += 1;
+            assert(internal_impl::simd::FirstMismatch(x.data(), y.data(), x.size()) == i);
+            assert(internal_impl::simd::FirstMismatch(x.data(), y.data(), i) == i);
+        }
+        auto y{x};
+        y[3] = -0.0f;
+        x[3] = 0.0f;
+        assert(internal_impl::simd::FirstMismatch(x.data(), y.data(), x.size()) == x.size()); // -0 == +0
+        y[40] = std::numeric_limits<float>::quiet_NaN();
+        x[40] = y[40];
+        assert(internal_impl::simd::FirstMismatch(x.data(), y.data(), x.size()) == 40);       // NaN != NaN
+
+        std::vector<double> u(19, 1.5);
+        std::vector<double> v(19, 1.5);
+        v[17] = 2.5;
+        assert(internal_impl::simd::FirstMismatch(u.data(), v.data(), 19) == 17);
+    }
+    internal_impl::simd::ForceIsa(internal_impl::simd::DetectIsa());
+
+    {
+        rage::Matrix<double> a(13, 21);
+        rage::Matrix<double> b(13, 21);
+        for (std::size_t r{0}; r < 13; ++r) {
+            for (std::size_t c{0}; c < 21; ++c) {
+                a.At(r, c) = static_cast<double>(r * 21 + c) / 7;
+                b.At(r, c) = a.At(r, c);
+            }
+        }
+        assert(a == b && a.View() == b.View());
+        b.At(12, 20) = -1;
+        assert(a != b);
+        assert(a != rage::Matrix<double>(13, 20));
+
+        // padded views: only the viewed elements count
+        std::vector<double> padded(13 * 32, -7);
+        auto view{rage::MatrixView<double>::FromBuffer(padded.data(), 13, 21, 32)};
+        for (std::size_t r{0}; r < 13; ++r) {
+            for (std::size_t c{0}; c < 21; ++c)
+                view.At(r, c) = a.At(r, c);
+        }
+        assert(view == a && a == view);
+        assert(a.View({1, 6}, {2, 9}) == view.View({1, 6}, {2, 9}));
+        assert(a.View({1, 6}, {2, 9}) != view.View({1, 6}, {3, 10}));
+
+        // a different layout, or a morph, goes element by element
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> a_col_major(a);
+        assert(a == a_col_major && b != a_col_major);
+
+        // integers compare bytes
+        rage::Matrix<int> i(9, 33);
+        rage::Matrix<int> j(9, 33);
+        for (std::size_t r{0}; r < 9; ++r) {
+            for (std::size_t c{0}; c < 33; ++c) {
+                i.At(r, c) = static_cast<int>(r * c) - 40;
+                j.At(r, c) = i.At(r, c);
+            }
+        }
+        assert(i == j && i.View({2, 6}, {3, 8}) == j.View({2, 6}, {3, 8}));
+        j.At(4, 31) = 0;
+        assert(i != j && i.View({2, 6}, {3, 8}) == j.View({2, 6}, {3, 8}));
+
+        // ApproxEqual
+        assert(rage::ApproxEqual(a, b.View({0, 13}, {0, 20})).same_shape == false);
+        const auto mismatch{rage::ApproxEqual(a, b)};
+        assert(!mismatch && mismatch.same_shape && mismatch.row == 12 && mismatch.col == 20);
+        b.At(12, 20) = a.At(12, 20);
+        assert(rage::ApproxEqual(a, b));
+
+        b.At(6, 9) = std::nextafter(std::nextafter(a.At(6, 9), 100.0), 100.0);
+        assert(a != b && rage::ApproxEqual(a, b) && !rage::ApproxEqual(a, b, 0, 0, 1));
+        b.At(6, 9) = a.At(6, 9) * (1 + 1e-9);
+        const auto relative{rage::ApproxEqual(a, b)};
+        assert(!relative && relative.row == 6 && relative.col == 9);
+        assert(rage::ApproxEqual(a, b, 0, 1e-8) && rage::ApproxEqual(a, b, 1e-6));
+        assert(rage::ApproxEqual(a_col_major, b, 1e-6) && rage::ApproxEqual(a + a, b + b, 1e-6));
+
+        const auto col_major_mismatch{rage::ApproxEqual(a_col_major, rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor>(b))};
+        assert(col_major_mismatch.row == 6 && col_major_mismatch.col == 9);
+
+        b.At(6, 9) = std::numeric_limits<double>::quiet_NaN();
+        assert(!rage::ApproxEqual(a, b, 1e300));
+    }
+
+    //*
+    //* Reductions, the kernels first: every instruction set must agree with the scalar loops
+
+    for (auto isa : {internal_impl::simd::Isa::Scalar, internal_impl::simd::Isa::SSE2,
+                     internal_impl::simd::Isa::AVX2, internal_impl::simd::Isa::AVX512}) {
+        internal_impl::simd::ForceIsa(isa);
+
+        std::vector<float> x(75);
+        for (std::size_t i{0}; i < x.size(); ++i)
+            x[i] = static_cast<float>(i % 2 == 0 ? i : 100 - i);
+        for (std::size_t n{0}; n <= x.size(); ++n) {
+            float sum{0};
+            float largest{-std::numeric_limits<float>::infinity()};
+            for (std::size_t i{0}; i < n; ++i) {
+                sum += x[i];
+                largest = std::max(largest, x[i]);
+            }
+            assert(internal_impl::simd::Sum(x.data(), n) == sum);
+            assert(internal_impl::simd::KahanSum(x.data(), n) == sum);
+            assert(internal_impl::simd::Max(x.data(), n) == largest);
+        }
+
+        std::vector<double> y(37);
+        for (std::size_t i{0}; i < y.size(); ++i)
+            y[i] = static_cast<double>(i) - 20;
+        assert(internal_impl::simd::Sum(y.data(), y.size()) == 36 * 37 / 2 - 20 * 37);
+        assert(internal_impl::simd::SumAbs(y.data(), y.size()) == 20 * 21 / 2 + 16 * 17 / 2);
+        assert(internal_impl::simd::Min(y.data(), y.size()) == -20 && internal_impl::simd::Max(y.data(), y.size()) == 16);
+        y[5] = std::numeric_limits<double>::quiet_NaN();
+        y[30] = std::numeric_limits<double>::quiet_NaN();
+        assert(internal_impl::simd::Min(y.data(), y.size()) == -20 && internal_impl::simd::Max(y.data(), y.size()) == 16);
+
+        // 2^24 and ones: the ones vanish when added one at a time to the big value, not with Kahan
+        std::vector<float> ones(100001, 1.0f);
+        ones[0] = 16777216.0f;
+        assert(internal_impl::simd::KahanSum(ones.data(), ones.size()) == 16877216.0f);
+    }
+    internal_impl::simd::ForceIsa(internal_impl::simd::DetectIsa());
+
+    {
+        rage::Matrix<long> a(7, 9);
+        for (std::size_t r{0}; r < 7; ++r) {
+            for (std::size_t c{0}; c < 9; ++c)
+                a.At(r, c) = static_cast<long>(r * 9 + c) - 30;
+        }
+        assert(rage::Sum(a) == 62 * 63 / 2 - 30 * 63);
+        assert(rage::Mean(a) == static_cast<double>(62 * 63 / 2 - 30 * 63) / 63);
+        assert(rage::Max(a) == 32 && rage::Min(a) == -30);
+        assert((rage::ArgMax(a) == rage::MatrixIndex{6, 8}) && (rage::ArgMin(a) == rage::MatrixIndex{0, 0}));
+        assert(rage::RowSums(a)[2] == 9 * (18 - 30) + 36 && rage::ColSums(a)[4] == 7 * (4 - 30) + 9 * 21);
+        assert(rage::Sum(a.View([](const long& elem) { return elem * 2; })) == 2 * rage::Sum(a));
+        assert(rage::Sum(a + a) == 2 * rage::Sum(a));
+
+        // norms
+        rage::Matrix<double> small{std::vector<std::vector<double>>{{1, -2}, {3, 4}}};
+        assert(rage::NormL1(small) == 6 && rage::NormInf(small) == 7 && rage::NormFrobenius(small) == std::sqrt(30.0));
+
+        // every layout, padding, morph or expression gives the same answers
+        const std::size_t rows{300};
+        const std::size_t cols{401};
+        rage::Matrix<double> m(rows, cols);
+        std::vector<double> padded(rows * 416);
+        auto view{rage::MatrixView<double>::FromBuffer(padded.data(), rows, cols, 416)};
+        for (std::size_t r{0}; r < rows; ++r) {
+            for (std::size_t c{0}; c < cols; ++c) {
+                m.At(r, c) = static_cast<double>((r * 7 + c * 13) % 101) - 50;
+                view.At(r, c) = m.At(r, c);
+            }
+        }
+        m.At(123, 321) = 1000;
+        view.At(123, 321) = 1000;
+        m.At(200, 7) = 1000;
+        view.At(200, 7) = 1000;
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> m_col_major(m);
+
+        rage::ThreadPool pool{3};
+        rage::ThreadPool single{1};
+        const auto expected_sum{rage::Sum(m, rage::Summation::Plain, single)};
+        std::vector<double> expected_rows(rows, 0);
+        std::vector<double> expected_cols(cols, 0);
+        for (std::size_t r{0}; r < rows; ++r) {
+            for (std::size_t c{0}; c < cols; ++c) {
+                expected_rows[r] += m.At(r, c);
+                expected_cols[c] += m.At(r, c);
+            }
+        }
+        // integer values: every summation order is exact
+        for (auto summation : {rage::Summation::Pairwise, rage::Summation::Plain, rage::Summation::Kahan}) {
+            for (rage::ThreadPool* threads : {&pool, &single}) {
+                assert(rage::Sum(m, summation, *threads) == expected_sum);
+                assert(rage::Sum(view, summation, *threads) == expected_sum);
+                assert(rage::Sum(m_col_major, summation, *threads) == expected_sum);
+                assert(rage::Sum(m.View([](const double& elem) { return -elem; }), summation, *threads) == -expected_sum);
+                assert(rage::RowSums(m, summation, *threads) == expected_rows && rage::ColSums(m, summation, *threads) == expected_cols);
+                assert(rage::RowSums(view, summation, *threads) == expected_rows && rage::ColSums(view, summation, *threads) == expected_cols);
+                assert(rage::RowSums(m_col_major, summation, *threads) == expected_rows);
+                assert(rage::ColSums(m_col_major, summation, *threads) == expected_cols);
+                assert(rage::ColSums(m + m, summation, *threads)[cols - 1] == 2 * expected_cols[cols - 1]);
+            }
+        }
+        assert(rage::Max(m, pool) == 1000 && rage::Max(m_col_major, pool) == 1000);
+        assert((rage::ArgMax(m, pool) == rage::MatrixIndex{123, 321}) && (rage::ArgMax(view, pool) == rage::MatrixIndex{123, 321}));
+        assert((rage::ArgMax(m_col_major, pool) == rage::MatrixIndex{200, 7})); // first in the storage order
+        assert(rage::Min(m, pool) == -50 && rage::Min(m.View([](const double& elem) { return -elem; }), pool) == -1000);
+        assert(rage::NormInf(m, pool) == rage::NormInf(m_col_major, pool) && rage::NormL1(view, pool) == rage::NormL1(m, pool));
+        assert(std::abs(rage::NormFrobenius(m, pool) - rage::NormFrobenius(m_col_major, single)) < 1e-9);
+
+        // the cut in runs does not depend on the threads: same bits with any pool
+        for (std::size_t r{0}; r < rows; ++r) {
+            for (std::size_t c{0}; c < cols; ++c)
+                m.At(r, c) = 1.0 / static_cast<double>(r + c + 1);
+        }
+        for (auto summation : {rage::Summation::Pairwise, rage::Summation::Plain, rage::Summation::Kahan}) {
+            assert(rage::Sum(m, summation, pool) == rage::Sum(m, summation, single));
+            assert(rage::ColSums(m, summation, pool) == rage::ColSums(m, summation, single));
+        }
+
+        // NaNs are skipped by Max and Min, all NaN gives NaN
+        rage::Matrix<float> nans(3, 5);
+        for (std::size_t r{0}; r < 3; ++r) {
+            for (std::size_t c{0}; c < 5; ++c)
+                nans.At(r, c) = std::numeric_limits<float>::quiet_NaN();
+        }
+        assert(std::isnan(rage::Max(nans)) && (rage::ArgMax(nans) == rage::MatrixIndex{0, 0}));
+        nans.At(2, 1) = -std::numeric_limits<float>::infinity();
+        assert(rage::Max(nans) == -std::numeric_limits<float>::infinity() && (rage::ArgMax(nans) == rage::MatrixIndex{2, 1}));
+        nans.At(1, 3) = 2;
+        assert(rage::Min(nans) == -std::numeric_limits<float>::infinity() && (rage::ArgMax(nans) == rage::MatrixIndex{1, 3}));
+        assert(std::isnan(rage::NormInf(nans)));
+    }
+
+    //*
+    //* Copies, moves and destination passing
+    {
+        static_assert(std::is_nothrow_move_constructible_v<rage::Matrix<double>>);
+        static_assert(std::is_nothrow_move_assignable_v<rage::Matrix<double>>);
+
+        rage::ThreadPool pool{4};
+        rage::Matrix<double> a(37, 21);
+        rage::Matrix<double> b(21, 45);
+        for (std::size_t r{0}; r < a.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < a.ColsCount(); ++c)
+                a.At(r, c) = static_cast<double>(r * 3) - static_cast<double>(c);
+        }
+        for (std::size_t r{0}; r < b.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < b.ColsCount(); ++c)
+                b.At(r, c) = static_cast<double>(c % 7) - static_cast<double>(r % 5);
+        }
+
+        // copies are deep, copy assignment reuses a buffer of the right size
+        rage::Matrix<double> copy{a};
+        assert(copy == a && copy.RawData() != a.RawData());
+        copy.At(0, 0) = 1000;
+        assert(a.At(0, 0) == 0);
+        const auto* copy_data{copy.RawData()};
+        copy = a;
+        assert(copy == a && copy.RawData() == copy_data);
+        auto& same{copy};
+        copy = same;
+        assert(copy == a);
+
+        // moves take the buffer and leave the source empty
+        const auto* a_data{a.RawData()};
+        rage::Matrix<double> moved{std::move(a)};
+        assert(moved.RawData() == a_data && moved.RowsCount() == 37 && moved.ColsCount() == 21);
+        assert(a.RawData() == nullptr && a.RowsCount() == 0 && a.ColsCount() == 0);
+        a = std::move(moved);
+        assert(a.RawData() == a_data && a == copy && moved.RawData() == nullptr);
+        rage::Matrix<double> product{a * b};
+        const auto expected{rage::MultiplyReference(a, b)};
+        assert(product == expected);
+
+        // results written in place, the output buffers never move
+        rage::Matrix<double> sum(37, 21);
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> sum_col_major(37, 21);
+        rage::Matrix<double> out(37, 45);
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> out_col_major(37, 45);
+        rage::Matrix<double> padded(40, 50);
+        auto padded_out{padded.View({1, 37}, {2, 46})};
+        const auto* sum_data{sum.RawData()};
+        const auto* out_data{out.RawData()};
+        for (int round{0}; round < 3; ++round) {
+            rage::Add(sum, a, copy, pool);
+            rage::Add(sum_col_major, a, copy);
+            rage::Multiply(out, a, b, pool);
+            rage::Multiply(out_col_major, a, b);
+            rage::Multiply(padded_out, a, b, pool);
+        }
+        assert(sum.RawData() == sum_data && out.RawData() == out_data);
+        assert(sum == a + copy && sum_col_major == a + copy);
+        assert(out == expected && out_col_major == expected && padded_out == expected);
+        rage::Multiply(out, a.View([](const double& elem) { return -elem; }), b);
+        assert(out == -1 * expected);
+        rage::Multiply(out_col_major.View(), a * 1.0, b.Transposed().Transposed() + 0.0, pool);
+        assert(out_col_major == expected);
+
+        // out may be an operand of Add and Scale
+        rage::Scale(sum, a, 2.0);
+        assert(sum == a * 2.0);
+        rage::Add(sum, sum, a);
+        rage::Scale(sum.View(), sum, 1.0 / 3.0, pool);
+        assert(rage::ApproxEqual(sum, a));
+        rage::Matrix<int> counts(4, 4, 6); // padded lines
+        for (std::size_t r{0}; r < 4; ++r) {
+            for (std::size_t c{0}; c < 4; ++c)
+                counts.At(r, c) = 7;
+        }
+        rage::Scale(counts, counts, 3);
+        rage::Add(counts, counts, counts);
+        assert(counts.At(3, 3) == 42 && counts.LeadingDimension() == 6);
+
+        // even transposed or shifted: through a temporary
+        rage::Matrix<int> square(4, 4);
+        for (std::size_t r{0}; r < 4; ++r) {
+            for (std::size_t c{0}; c < 4; ++c)
+                square.At(r, c) = static_cast<int>(r * 4 + c);
+        }
+        const auto original{square};
+        rage::Add(square, square, square.Transposed());
+        assert(square == original + original.Transposed());
+        rage::Scale(square, square.Transposed(), 1);
+        assert(square == original + original.Transposed()); // symmetric
+        square = original;
+        rage::Scale(square, square.Transposed(), 1);
+        assert(square == rage::Transpose(original.View()));
+        square = original;
+        rage::Add(square.View({1, 3}, {0, 3}), square.View({0, 2}, {0, 3}), square.View({1, 3}, {0, 3}));
+        assert(square.At(0, 0) == 0 && square.At(1, 0) == 4 && square.At(3, 3) == 11 + 15 && square.At(2, 1) == 5 + 9);
+    }
+
+    //*
+    //* Fused GEMM: C = epilogue(alpha A B + beta C + bias)
+    {
+        rage::ThreadPool pool{4};
+        const std::size_t m{70};
+        const std::size_t k{300}; // more than one KC block: beta, bias and epilogue only once
+        const std::size_t n{45};
+        rage::Matrix<double> a(m, k);
+        rage::Matrix<double> b(k, n);
+        for (std::size_t r{0}; r < m; ++r) {
+            for (std::size_t c{0}; c < k; ++c)
+                a.At(r, c) = static_cast<double>((r * 7 + c * 3) % 11) - 5;
+        }
+        for (std::size_t r{0}; r < k; ++r) {
+            for (std::size_t c{0}; c < n; ++c)
+                b.At(r, c) = static_cast<double>((r + c * 5) % 9) - 4;
+        }
+        std::vector<double> row_bias(m);
+        std::vector<double> col_bias(n);
+        std::iota(row_bias.begin(), row_bias.end(), -30.0);
+        std::iota(col_bias.begin(), col_bias.end(), 100.0);
+        const auto relu{[](double v) { return v > 0 ? v : 0.0; }};
+
+        const auto product{rage::MultiplyReference(a, b)};
+        rage::Matrix<double> c0(m, n);
+        for (std::size_t r{0}; r < m; ++r) {
+            for (std::size_t c{0}; c < n; ++c)
+                c0.At(r, c) = static_cast<double>(r) - static_cast<double>(c);
+        }
+        const auto expected{[&](double alpha, double beta, bool biased, auto&& f) {
+            rage::Matrix<double> result(m, n);
+            for (std::size_t r{0}; r < m; ++r) {
+                for (std::size_t c{0}; c < n; ++c)
+                    result.At(r, c) = f(alpha * product.At(r, c) + beta * c0.At(r, c) + (biased ? row_bias[r] + col_bias[c] : 0.0));
+            }
+            return result;
+        }};
+
+        rage::Matrix<double> c{c0};
+        rage::Gemm(2.0, a, b, -3.0, c, {.row = row_bias, .col = col_bias}, relu, pool);
+        assert(c == expected(2.0, -3.0, true, relu));
+
+        rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> c_col_major(m, n);
+        for (std::size_t r{0}; r < m; ++r) {
+            for (std::size_t col{0}; col < n; ++col)
+                c_col_major.At(r, col) = c0.At(r, col);
+        }
+        rage::Gemm(0.5, a, b, 1.0, c_col_major, {.row = row_bias, .col = col_bias}, relu);
+        assert(c_col_major == expected(0.5, 1.0, true, relu));
+
+        // beta == 0 does not read C, a padded view as C, expressions and morphed views as operands
+        rage::Matrix<double> padded(m + 2, n + 5);
+        for (std::size_t r{0}; r < padded.RowsCount(); ++r) {
+            for (std::size_t col{0}; col < padded.ColsCount(); ++col)
+                padded.At(r, col) = std::numeric_limits<double>::quiet_NaN();
+        }
+        auto c_view{padded.View({1, m}, {3, n + 2})};
+        rage::Gemm(1.0, a * 1.0, b.View([](const double& elem) { return elem; }), 0.0, c_view, {.col = col_bias}, {}, pool);
+        rage::Matrix<double> no_row_bias{expected(1.0, 0.0, true, std::identity{})};
+        for (std::size_t r{0}; r < m; ++r) {
+            for (std::size_t col{0}; col < n; ++col)
+                no_row_bias.At(r, col) -= row_bias[r];
+        }
+        assert(c_view == no_row_bias && std::isnan(padded.At(0, 0)) && std::isnan(padded.At(m + 1, n + 4)));
+
+        // plain alpha A B + beta C, and k == 0 leaves beta C (+ bias)
+        c = c0;
+        rage::Gemm(1.0, a, b, 1.0, c);
+        assert(c == expected(1.0, 1.0, false, std::identity{}));
+        rage::Matrix<float> empty_a(3, 0);
+        rage::Matrix<float> empty_b(0, 2);
+        rage::Matrix<float> small(3, 2);
+        for (std::size_t r{0}; r < 3; ++r) {
+            for (std::size_t col{0}; col < 2; ++col)
+                small.At(r, col) = 1;
+        }
+        const std::vector<float> small_bias{1, 2};
+        rage::Gemm(5.0f, empty_a, empty_b, 2.0f, small, {.col = small_bias}, [](float v) { return v * 10; });
+        assert(small.At(0, 0) == 30 && small.At(2, 1) == 40);
+    }
+
+    //*
+    //* Copy-on-write: SharedMatrix
+    {
+        rage::Matrix<double> source(6, 5);
+        for (std::size_t r{0}; r < 6; ++r) {
+            for (std::size_t c{0}; c < 5; ++c)
+                source.At(r, c) = static_cast<double>(r * 10 + c);
+        }
+        const auto* source_data{source.RawData()};
+        rage::SharedMatrix<double> shared{std::move(source)};
+        assert(std::as_const(shared).RawData() == source_data && !shared.IsShared());
+
+        // fan-out: every reader sees the same buffer, nothing is copied
+        std::vector<rage::SharedMatrix<double>> readers(8, shared);
+        for (const auto& reader : readers)
+            assert(reader.RawData() == source_data && reader.IsShared() && reader == shared);
+        assert(rage::Sum(readers.back().View()) == rage::Sum(shared.View()));
+        assert(std::as_const(readers[0]).At(5, 4) == 54 && std::as_const(readers[0]).Row(1)[2] == 12); // reads do not copy
+        assert(std::as_const(readers[0]).RawData() == source_data);
+
+        // the first write copies, the others keep the original
+        rage::SharedMatrix<double> writer{readers[3]};
+        writer.At(0, 0) = -1;
+        assert(std::as_const(writer).RawData() != source_data && !writer.IsShared());
+        assert(std::as_const(shared).At(0, 0) == 0 && writer.At(0, 0) == -1 && writer.At(5, 4) == 54);
+        assert(std::as_const(shared).RawData() == source_data);
+        const auto* writer_data{std::as_const(writer).RawData()};
+        writer.Row(2)[3] = 7; // unshared now: no more copies
+        writer.Col(4)[0] = 8;
+        assert(std::as_const(writer).RawData() == writer_data && writer.At(2, 3) == 7 && writer.At(0, 4) == 8);
+        assert(!(writer == shared));
+
+        // destination passing copies a shared buffer once, then reuses it
+        rage::SharedMatrix<double> sum{shared};
+        rage::Add(sum, shared.View(), shared.View());
+        assert(sum.Get() == shared.View() * 2.0 && std::as_const(sum).RawData() != source_data);
+        const auto* sum_data{std::as_const(sum).RawData()};
+        rage::Scale(sum, sum.View(), 0.5, rage::ThreadPool::Default());
+        assert(std::as_const(sum).RawData() == sum_data && sum == shared);
+        rage::SharedMatrix<double> product(6, 6);
+        rage::Multiply(product, shared.View(), shared.View().Transposed());
+        assert(product.Get() == rage::MultiplyReference(shared.Get().View(), shared.Get().View().Transposed()));
+
+        // each copy drops its reference on its own, the last one frees the buffer
+        readers.clear();
+        assert(!shared.IsShared() && std::as_const(shared).RawData() == source_data && shared.At(1, 1) == 11);
+    }
+
+    //*
+    //* Async calls and task graphs
+    {
+        rage::ThreadPool pool{4};
+        rage::ThreadPool single{1};
+        const auto filled{[](std::size_t rows, std::size_t cols, double seed) {
+            rage::Matrix<double> m(rows, cols);
+            for (std::size_t r{0}; r < rows; ++r) {
+                for (std::size_t c{0}; c < cols; ++c)
+                    m.At(r, c) = static_cast<double>((r * 5 + c * 3) % 7) - seed;
+            }
+            return m;
+        }};
+        const auto a{filled(40, 30, 1)};
+        const auto b{filled(30, 50, 2)};
+        const auto c{filled(40, 20, 3)};
+        const auto d{filled(20, 50, 4)};
+        const auto ab{rage::MultiplyReference(a, b)};
+        const auto cd{rage::MultiplyReference(c, d)};
+
+        // futures: values, void, exceptions, move-only callables, waiting from inside a task
+        for (rage::ThreadPool* threads : {&pool, &single}) {
+            auto ab_future{rage::Async([&] { return a * b; }, *threads)};
+            auto cd_future{rage::Async([&] { return c * d; }, *threads)};
+            assert(ab_future.Get() == ab && cd_future.Get() == cd);
+
+            std::atomic<int> calls{0};
+            auto side_effect{rage::Async([&calls] { ++calls; }, *threads)};
+            side_effect.Wait();
+            assert(side_effect.Ready() && calls == 1);
+
+            auto failing{rage::Async([]() -> int { throw std::runtime_error{"no"}; }, *threads)};
+            bool thrown{false};
+            try {
+                failing.Get();
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            assert(thrown);
+
+            auto owned{rage::Async([value = std::make_unique<int>(7)] { return *value; }, *threads)};
+            auto nested{rage::Async([&] { return rage::Matrix<double>{rage::Async([&] { return a * b; }, *threads).Get() + 1.0}; }, *threads)};
+            assert(owned.Get() == 7 && nested.Get() == ab + 1.0);
+
+            // co_await: the coroutine resumes where the products finish
+            rage::Matrix<double> awaited(1, 1);
+            std::atomic<bool> done{false};
+            AwaitSum(rage::Async([&] { return a * b; }, *threads), rage::Async([&] { return c * d; }, *threads), awaited, done);
+            threads->RunUntil([&done] { return done.load(); });
+            assert(awaited == ab + cd);
+        }
+
+        // a graph: the two products are independent, the intermediates are recycled
+        rage::TaskGraph<double> graph;
+        const auto a_node{graph.Input(a)};
+        const auto ab_node{graph.Multiply(a_node, graph.Input(b.View()))};
+        const auto cd_node{graph.Multiply(graph.Input(c), graph.Input(d))};
+        const auto sum_node{graph.Add(ab_node, cd_node)};
+        const auto difference_node{graph.Subtract(graph.Scale(sum_node, 2.0), ab_node)};
+        const auto product_node{graph.Multiply(graph.Scale(difference_node, 0.5), graph.Input(b.Transposed()))};
+        graph.Keep(sum_node);
+        assert(graph.NodesCount() == 12);
+
+        const rage::Matrix<double> expected_half{((ab + cd) * 2.0 - ab) * 0.5};
+        const auto expected_product{rage::MultiplyReference(expected_half.View(), b.Transposed())};
+        for (rage::ThreadPool* threads : {&pool, &single}) {
+            graph.Run(*threads);
+            assert(graph.Result(sum_node) == ab + cd);
+            assert(graph.Result(product_node) == expected_product);
+        }
+        // six 40 x 50 results and a 40 x 30 one: the last ones reuse what ab and 2 sum leave,
+        // and the next runs reuse everything
+        const auto allocated{graph.BuffersAllocated()};
+        assert(allocated < 7);
+        graph.RunAsync(pool).Get();
+        graph.Run(pool);
+        assert(graph.BuffersAllocated() == allocated && graph.Result(product_node) == expected_product);
+
+        // a failure skips what depends on it, not the independent nodes (even recorded after it)
+        rage::Matrix<Picky> x(3, 3);
+        rage::Matrix<Picky> y(3, 3);
+        for (std::size_t i{0}; i < 3; ++i) {
+            for (std::size_t j{0}; j < 3; ++j) {
+                x.At(i, j) = {static_cast<double>(i * 3 + j)};
+                y.At(i, j) = {static_cast<double>(j)};
+            }
+        }
+        rage::TaskGraph<Picky> failing;
+        const auto x_node{failing.Input(x)};
+        const auto negated{failing.Scale(x_node, Picky{-1.0})}; // throws
+        failing.Add(negated, x_node);
+        const auto independent{failing.Subtract(x_node, failing.Input(y))};
+        for (rage::ThreadPool* threads : {&pool, &single}) {
+            bool thrown{false};
+            try {
+                failing.Run(*threads);
+            } catch (const std::domain_error&) {
+                thrown = true;
+            }
+            assert(thrown && failing.Result(independent) == x - y);
+        }
+    }
+
+    //*
+    //* Execution policies: element-wise operations in row blocks of any view, morphs and other layouts included
+
+    {
+        rage::ThreadPool pool{4};
+        rage::Matrix<double> a(300, 260);
+        rage::Matrix<double> b(300, 260);
+        for (std::size_t r{0}; r < a.RowsCount(); ++r) {
+            for (std::size_t c{0}; c < a.ColsCount(); ++c) {
+                a[r][c] = static_cast<double>(r * 7 + c) * 0.5;
+                b[r][c] = static_cast<double>(c % 13) - 6.0;
+            }
+        }
+        const rage::Matrix<double, rage::AlignedAllocator<double>, rage::ColMajor> b_col_major{b};
+        const auto negated{[](const double& elem) { return -elem; }};
+
+        // a strided sub-view: the padding and the elements around it are never written
+        rage::Matrix<double> big(310, 280, 288);
+        rage::Fill(rage::par, big, -1.0);
+        auto inner{big.View({5, 304}, {10, 269})};
+        rage::Copy(rage::par, inner, a);
+        assert(inner == a);
+        assert(big.At(4, 10) == -1.0 && big.At(305, 10) == -1.0 && big.At(5, 9) == -1.0 && big.At(5, 270) == -1.0);
+
+        inner.Add(rage::par, b);
+        assert(inner == a + b);
+        inner.Sub(b, pool);
+        assert(inner == a);
+        inner.Sub(rage::seq, b.View(negated));
+        assert(inner == a + b);
+        inner.Add(rage::par, b_col_major);
+        assert(inner == a + b * 2.0);
+        inner.Sub(rage::par, 1.5).Add(0.5, pool);
+        assert(inner == a + b * 2.0 - 1.0);
+        assert(big.At(4, 10) == -1.0 && big.At(305, 269) == -1.0 && big.At(304, 9) == -1.0 && big.At(304, 270) == -1.0);
+
+        // the same results on the calling thread and on the pool
+        rage::Matrix<double> sequential(300, 260);
+        rage::Matrix<double> parallel(300, 260);
+        rage::Add(rage::seq, sequential, a, b_col_major);
+        rage::Add(rage::par, parallel, a, b_col_major);
+        assert(sequential == parallel && parallel == a + b);
+        rage::Scale(rage::seq, sequential.View(), a.View(negated), 3.0);
+        rage::Scale(rage::par, parallel.View(), a.View(negated), 3.0);
+        assert(sequential == parallel && parallel == a * -3.0);
+        parallel.Add(rage::par, a).Sub(a.View(), pool);
+        assert(parallel == a * -3.0);
+
+        // an operand reading this matrix elsewhere goes through a temporary
+        rage::Matrix<int> self(5, 5);
+        for (std::size_t r{0}; r < 5; ++r) {
+            for (std::size_t c{0}; c < 5; ++c)
+                self.At(r, c) = static_cast<int>(r * 5 + c);
+        }
+        const auto self_before{self};
+        self.Add(rage::seq, self.Transposed());
+        assert(self == self_before + self_before.Transposed());
+        self = self_before;
+        self.Sub(self.Transposed(), pool);
+        assert(self == self_before - self_before.Transposed());
+        self = self_before;
+        self.View({1, 4}, {0, 4}).Add(rage::seq, self.View({0, 3}, {0, 4}));
+        assert(self.At(0, 4) == 4 && self.At(1, 0) == 5 + 0 && self.At(4, 4) == 24 + 19 && self.At(3, 2) == 17 + 12);
+
+        // morphed views and expressions are materialized into out, or into a new matrix with Eval
+        rage::Copy(rage::par, parallel, a.View(negated));
+        assert(parallel == a * -1.0);
+        rage::Copy(parallel, b_col_major, pool);
+        assert(parallel == b);
+        rage::Copy(rage::seq, parallel, a * 2.0 + b);
+        assert(parallel == (a * 2.0 + b).Eval(rage::par));
+        const auto halved{a.View([](const double& elem) { return elem / 2; }).Eval(rage::par)};
+        assert(halved == a * 0.5);
+        const auto col_major_copy{b_col_major.View().Eval(pool)};
+        static_assert(std::is_same_v<decltype(col_major_copy), decltype(b_col_major)>);
+        assert(col_major_copy == b && b.View({1, 2}, {3, 4}).Eval(rage::seq) == b.View({1, 2}, {3, 4}));
+        rage::Fill(rage::seq, parallel.View({0, 9}, {0, 259}), 4.0);
+        assert(parallel.At(9, 259) == 4.0 && parallel.At(10, 0) == a.At(10, 0) * 2.0 + b.At(10, 0));
+
+        // a shared buffer is copied before being written
+        rage::SharedMatrix<double> shared{rage::Matrix<double>{a}};
+        const auto other{shared};
+        rage::Fill(rage::par, shared, 0.0);
+        assert(other.Get() == a && shared.Get() == a * 0.0);
+        rage::Copy(rage::par, shared, other.View());
+        assert(shared == other && !shared.IsShared());
+    }
+
+    //*
+    //* Matrix files: Save, then MapMatrix
+
+    {
+        const auto path{std::filesystem::temp_directory_path() / "rage_test_matrix.bin"};
+        rage::Matrix<double> saved(37, 20, rage::PaddedLeadingDimension<double>(20));
+        for (std::size_t r{0}; r < 37; ++r) {
+            for (std::size_t c{0}; c < 20; ++c)
+                saved.At(r, c) = static_cast<double>(r * 100 + c);
+        }
+        saved.Save(path);
+        assert(std::filesystem::file_size(path) == 64 + 37 * saved.LeadingDimension() * sizeof(double));
+
+        {
+            const auto mapped{rage::MapMatrix<const double>(path)};
+            assert(mapped.RowsCount() == 37 && mapped.ColsCount() == 20 && mapped.LeadingDimension() == saved.LeadingDimension());
+            assert(reinterpret_cast<std::uintptr_t>(mapped.RawData()) % 64 == 0);
+            assert(mapped.View() == saved && mapped.At(36, 19) == 3619.0);
+            assert(rage::Multiply(mapped.View(), std::vector<double>(20, 1.0)) == rage::Multiply(saved, std::vector<double>(20, 1.0)));
+        }
+
+        {
+            auto writable{rage::MapMatrix<double>(path)}; // copy-on-write
+            writable.At(0, 0) = -1.0;
+            writable.View().Add(1.0);
+            assert(writable.At(0, 0) == 0.0 && writable.At(1, 1) == 102.0);
+            auto moved{std::move(writable)};
+            assert(moved.At(1, 1) == 102.0);
+        }
+        assert(rage::MapMatrix<const double>(path).View() == saved); // the file never changed
+
+        rage::Matrix<float, rage::AlignedAllocator<float>, rage::ColMajor> col_major(3, 5);
+        col_major.At(2, 4) = 7.0f;
+        col_major.Save(path);
+        const auto mapped_col_major{rage::MapMatrix<const float, rage::ColMajor>(path)};
+        assert(mapped_col_major.View() == col_major && mapped_col_major.View().Col(4)[2] == 7.0f);
+
+        const auto throws{[](const auto& map) {
+            try {
+                map();
+            } catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        }};
+        assert(throws([&] { return rage::MapMatrix<const double, rage::ColMajor>(path); })); // wrong element type
+        assert(throws([&] { return rage::MapMatrix<const float>(path); }));                 // wrong layout
+
+        //* a 1 x 8 file whose header says otherwise
+        const auto tampered{[&](const auto& tamper) {
+            rage::Matrix<double>(1, 8).Save(path);
+            internal_impl::MatrixFileHeader header{};
+            std::ifstream{path, std::ios::binary}.read(reinterpret_cast<char*>(&header), sizeof(header));
+            tamper(header);
+            std::fstream{path, std::ios::binary | std::ios::in | std::ios::out}.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            return throws([&] { return rage::MapMatrix<const double>(path); });
+        }};
+        assert(!tampered([](auto&) {}));
+        assert(tampered([](auto& header) { header.rows = (std::uint64_t{1} << 61) + 1; })); // 64 + rows * 8 * 8 wraps around to the file size
+        assert(tampered([](auto& header) { header.data_offset = ~std::uint64_t{0} - 63; header.alignment = 64; }));
+        assert(tampered([](auto& header) { header.alignment = 0; }));
+        assert(tampered([](auto& header) { header.alignment = 24; }));
+        assert(tampered([](auto& header) { header.alignment = 4; }));   // below alignof(double)
+        assert(tampered([](auto& header) { header.alignment = 128; })); // data_offset 64 is not a multiple
+        assert(tampered([](auto& header) { header.data_offset = 0; header.alignment = 8; }));
+
+        std::ofstream{path, std::ios::binary} << "not a matrix";
+        assert(throws([&] { return rage::MapMatrix<const float, rage::ColMajor>(path); }));
+        std::filesystem::remove(path);
+        assert(throws([&] { return rage::MapMatrix<const float, rage::ColMajor>(path); })); // std::system_error is a std::runtime_error
+    }
+
+    //*
+    //* CSV: one allocation, chunked input, parallel blocks
+
+    {
+        const std::string text{"a,b,c\r\n1, 2.5 ,-3\r\n\r\n+4,5e-1,6\n7,8,9"};
+        const auto parsed{rage::ParseCsv<double>(text, {.has_header = true})};
+        assert(parsed.RowsCount() == 3 && parsed.ColsCount() == 3); // not square by accident: 3 rows of 3
+        assert(parsed.At(0, 1) == 2.5 && parsed.At(0, 2) == -3.0 && parsed.At(1, 0) == 4.0 && parsed.At(1, 1) == 0.5);
+        assert(parsed.At(2, 2) == 9.0);
+
+        const auto wide{rage::ParseCsv<int>("1;2;3;4\n5;6;7;8\n", {.delimiter = ';'})};
+        assert(wide.RowsCount() == 2 && wide.ColsCount() == 4 && wide.At(1, 3) == 8);
+        assert(rage::ParseCsv<int>("").RowsCount() == 0);
+
+        // any chunking gives the same matrix
+        for (std::size_t chunk_size : {std::size_t{1}, std::size_t{3}, std::size_t{7}, text.size()}) {
+            rage::CsvReader<double> reader{{.has_header = true}};
+            for (std::size_t i{0}; i < text.size(); i += chunk_size)
+                reader.Feed(std::string_view{text}.substr(i, chunk_size));
+            const auto chunked{reader.Finish()};
+            assert(chunked == parsed);
+        }
+
+        // big enough for several blocks
+        std::string big;
+        const std::size_t big_rows{150000};
+        for (std::size_t r{0}; r < big_rows; ++r)
+            big += std::to_string(r) + "," + std::to_string(r % 97) + ".25,-" + std::to_string(r * 3) + "\n";
+        assert(big.size() > 2 * internal_impl::CsvBlockSize);
+        rage::ThreadPool pool{4};
+        const auto in_parallel{rage::ParseCsv<float>(big, {}, pool)};
+        assert(in_parallel.RowsCount() == big_rows && in_parallel.ColsCount() == 3);
+        for (std::size_t r : {std::size_t{0}, std::size_t{12345}, big_rows - 1}) {
+            assert(in_parallel.At(r, 0) == static_cast<float>(r));
+            assert(in_parallel.At(r, 1) == static_cast<float>(r % 97) + 0.25f);
+            assert(in_parallel.At(r, 2) == -static_cast<float>(r * 3));
+        }
+        rage::ThreadPool single{1};
+        assert(rage::ParseCsv<float>(big, {}, single) == in_parallel);
+
+        // no data line and no final newline: nothing to parse, on any pool
+        assert(rage::ParseCsv<double>("a,b", {.has_header = true}, pool).RowsCount() == 0);
+        assert(rage::ParseCsv<double>("  ", {}, pool).RowsCount() == 0);
+        assert(rage::ParseCsv<double>("a,b\n  ", {.has_header = true}, pool).RowsCount() == 0);
+
+        const auto path{std::filesystem::temp_directory_path() / "rage_test_matrix.csv"};
+        std::ofstream{path} << text;
+        assert(rage::ReadCsv<double>(path, {.has_header = true}) == parsed);
+        std::filesystem::remove(path);
+
+        const auto throws{[](std::string_view bad) {
+            try {
+                rage::ParseCsv<int>(bad);
+            } catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        }};
+        assert(throws("1,2\n3\n"));      // ragged
+        assert(throws("1,2\n3,x\n"));    // not a number
+        assert(throws("1,2\n3,4,\n"));   // trailing delimiter
+        assert(throws("1.5,2\n"));       // not an int
+        assert(!throws(" 1 ,\t2 \n"));
+    }
+
     std::println("Completed successfully!");
     return 0;
 }
 
+//*
+//* Async
+Detached AwaitSum(rage::Future<rage::Matrix<double>> lhs, rage::Future<rage::Matrix<double>> rhs, rage::Matrix<double>& out, std::atomic<bool>& done) {
+    const auto left{co_await lhs};
+    out = left + co_await rhs;
+    done.store(true);
+}
+
 //*
 //* Print
 template <typename T, typename M>
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+//* Work-stealing thread pool used by the kernels
+//*
+//* Every worker owns a deque: it pushes and pops its own tasks at the back (LIFO, still hot in cache)
+//* and, when it runs dry, steals from the front of the others. A thread waiting on a ParallelFor
+//* keeps running queued tasks instead of blocking, so nested parallel calls cannot deadlock.
+
+namespace rage {
+
+class ThreadPool
+{
+public:
+    //* threads counts the calling thread too: ThreadPool{1} spawns nothing and runs everything inline
+    explicit ThreadPool(std::size_t threads = DefaultThreadsCount())
+    {
+        const auto workers{threads > 1 ? threads - 1 : 0};
+        for (std::size_t i{0}; i < workers; ++i)
+            queues_.push_back(std::make_unique<Queue_>());
+        for (std::size_t i{0}; i < workers; ++i)
+            workers_.emplace_back([this, i] { WorkerLoop_(i); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock{sleep_mutex_};
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_)
+            worker.join();
+    }
+
+public:
+    constexpr std::size_t ThreadsCount() const { return workers_.size() + 1; }
+
+    //* fire and forget, the task must not throw
+    template <typename F>
+    void Submit(F&& task)
+    {
+        if (workers_.empty()) {
+            std::forward<F>(task)();
+            return;
+        }
+
+        //* a worker keeps what it spawns, anyone else spreads the tasks around
+        const auto index{current_pool_ == this ? current_index_
+                                               : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size()};
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock{queues_[index]->mutex};
+            queues_[index]->tasks.emplace_back(std::forward<F>(task));
+        }
+        {
+            std::lock_guard lock{sleep_mutex_};
+        }
+        wake_.notify_one();
+    }
+
+    //* Calls fn(chunk_first, chunk_last) over [first, last), in chunks of at least grain elements,
+    //* and returns when all of them are done. The first exception thrown by fn is rethrown here.
+    template <typename F>
+    void ParallelFor(std::size_t first, std::size_t last, std::size_t grain, const F& fn)
+    {
+        if (last <= first)
+            return;
+
+        const auto count{last - first};
+        const auto max_chunks{(count + std::max<std::size_t>(grain, 1) - 1) / std::max<std::size_t>(grain, 1)};
+        const auto chunks{std::min(max_chunks, ThreadsCount() * 4)};
+        if (chunks <= 1 || workers_.empty()) {
+            fn(first, last);
+            return;
+        }
+
+        const auto chunk_size{(count + chunks - 1) / chunks};
+        std::atomic<std::size_t> remaining{chunks};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        const auto run{[&](std::size_t chunk) {
+            const auto chunk_first{first + chunk * chunk_size};
+            const auto chunk_last{std::min(last, chunk_first + chunk_size)};
+            try {
+                if (chunk_first < chunk_last)
+                    fn(chunk_first, chunk_last);
+            } catch (...) {
+                std::lock_guard lock{error_mutex};
+                if (!error)
+                    error = std::current_exception();
+            }
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }};
+
+        for (std::size_t chunk{1}; chunk < chunks; ++chunk)
+            Submit([&run, chunk] { run(chunk); });
+        run(0);
+
+        RunUntil([&remaining] { return remaining.load(std::memory_order_acquire) == 0; });
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    //* Waits for done() to return true, running queued tasks meanwhile instead of blocking
+    template <typename Done>
+    void RunUntil(const Done& done)
+    {
+        while (!done()) {
+            if (!TryRunOne_())
+                std::this_thread::yield();
+        }
+    }
+
+//* The library owned pool, used by the operators
+public:
+    static ThreadPool& Default() { return *Default_(); }
+
+    //* Replaces the default pool, it must not be in use by another thread while this runs
+    static void SetDefaultThreadsCount(std::size_t threads) { Default_() = std::make_unique<ThreadPool>(threads); }
+
+    //* No worker: whatever is given to it runs right away on the calling thread (any thread can use it)
+    static ThreadPool& Sequential()
+    {
+        static ThreadPool pool{1};
+        return pool;
+    }
+
+    //* RAGE_NUM_THREADS if set, otherwise every hardware thread
+    static std::size_t DefaultThreadsCount()
+    {
+        if (const char* env{std::getenv("RAGE_NUM_THREADS")}) {
+            try {
+                return std::max<std::size_t>(std::stoul(env), 1);
+            } catch (...) {}
+        }
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+private:
+    struct Queue_ {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    static std::unique_ptr<ThreadPool>& Default_()
+    {
+        static std::unique_ptr<ThreadPool> pool{std::make_unique<ThreadPool>()};
+        return pool;
+    }
+
+    void WorkerLoop_(std::size_t index)
+    {
+        current_pool_ = this;
+        current_index_ = index;
+
+        while (true) {
+            if (TryRunOne_())
+                continue;
+
+            std::unique_lock lock{sleep_mutex_};
+            wake_.wait(lock, [this] { return stop_ || pending_.load(std::memory_order_relaxed) > 0; });
+            if (stop_ && pending_.load(std::memory_order_relaxed) == 0)
+                return;
+        }
+    }
+
+    //* own queue from the back first, then steal from the front of the others
+    bool TryRunOne_()
+    {
+        const auto home{current_pool_ == this ? current_index_ : 0};
+        for (std::size_t i{0}; i < queues_.size(); ++i) {
+            const auto index{(home + i) % queues_.size()};
+            auto task{i == 0 && current_pool_ == this ? PopBack_(index) : PopFront_(index)};
+            if (task) {
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                (*task)();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::optional<std::function<void()>> PopBack_(std::size_t index)
+    {
+        std::lock_guard lock{queues_[index]->mutex};
+        auto& tasks{queues_[index]->tasks};
+        if (tasks.empty())
+            return std::nullopt;
+        auto task{std::move(tasks.back())};
+        tasks.pop_back();
+        return task;
+    }
+
+    std::optional<std::function<void()>> PopFront_(std::size_t index)
+    {
+        std::lock_guard lock{queues_[index]->mutex};
+        auto& tasks{queues_[index]->tasks};
+        if (tasks.empty())
+            return std::nullopt;
+        auto task{std::move(tasks.front())};
+        tasks.pop_front();
+        return task;
+    }
+
+private:
+    std::vector<std::unique_ptr<Queue_>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<std::size_t> pending_{0};
+    std::atomic<std::size_t> next_queue_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_{false};
+
+    static inline thread_local ThreadPool* current_pool_{nullptr};
+    static inline thread_local std::size_t current_index_{0};
+};
+
+//* Below these sizes the work stays on the calling thread
+struct ParallelThresholds {
+    static inline std::size_t gemm_work{64 * 64 * 64};  // rows * cols * inner dimension
+    static inline std::size_t elementwise{1 << 15};     // elements
+};
+
+//* Execution policies, passed first like to the standard algorithms: rage::seq runs on the calling thread,
+//* rage::par on the default pool (row blocks, above ParallelThresholds). A ThreadPool& passed last picks the pool.
+//* std::execution::seq, unseq, par and par_unseq map to these once execution.hpp is included.
+struct SequencedPolicy {};
+struct ParallelPolicy {};
+
+inline constexpr SequencedPolicy seq{};
+inline constexpr ParallelPolicy par{};
+
+} // namespace rage
+
+namespace internal_impl {
+
+//* the pool a policy runs on, specialized for every policy type
+template <typename P> struct ExecutionPolicyTraits_ {};
+
+template <> struct ExecutionPolicyTraits_<rage::SequencedPolicy> {
+    static rage::ThreadPool& Pool() { return rage::ThreadPool::Sequential(); }
+};
+
+template <> struct ExecutionPolicyTraits_<rage::ParallelPolicy> {
+    static rage::ThreadPool& Pool() { return rage::ThreadPool::Default(); }
+};
+
+template <typename P>
+concept ExecutionPolicy = requires { { ExecutionPolicyTraits_<std::remove_cvref_t<P>>::Pool() } -> std::same_as<rage::ThreadPool&>; };
+
+template <ExecutionPolicy P>
+rage::ThreadPool& PoolOf(const P&) { return ExecutionPolicyTraits_<std::remove_cvref_t<P>>::Pool(); }
+
+//* fn(first_row, last_row) over row blocks, in parallel when the matrix is big enough
+template <typename F>
+void ForEachRowBlock(rage::ThreadPool& pool, std::size_t rows, std::size_t cols, const F& fn)
+{
+    if (rows * cols < rage::ParallelThresholds::elementwise || pool.ThreadsCount() == 1 || rows < 2) {
+        fn(std::size_t{0}, rows);
+        return;
+    }
+
+    //* rows per block so that a block is worth scheduling on its own
+    const auto grain{std::max<std::size_t>(rage::ParallelThresholds::elementwise / std::max<std::size_t>(cols, 1) / 4, 1)};
+    pool.ParallelFor(0, rows, grain, fn);
+}
+
+} // namespace internal_impl
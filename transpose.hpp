@@ -0,0 +1,133 @@
+#pragma once
+
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <cstddef>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+//* Physical transposition of a buffer: lines x length becomes length x lines
+//* (rows x cols for row-major storage, the other way around for column-major).
+//*
+//* Cache-oblivious: the longer side is halved until a block fits in L1 (TransposeLeaf x TransposeLeaf),
+//* so at every cache level the rows read and the rows written by a block stay resident, whatever the
+//* cache sizes are. The leaves go through the SIMD register tiles of simd.hpp.
+//*
+//* In place, square buffers swap mirrored blocks across the diagonal (any leading dimension);
+//* other shapes follow the permutation cycles of the flat buffer, which needs it unpadded.
+
+namespace internal_impl {
+
+inline constexpr std::size_t TransposeLeaf{32};
+
+//* base(row, col, rows, cols) on the leaves covering rows x cols starting at (row, col)
+//* Splits stay multiples of 8 so the register tiles line up with the leaves
+template <typename Base>
+void TransposeRecursive_(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols, const Base& base)
+{
+    if (rows <= TransposeLeaf && cols <= TransposeLeaf)
+        return base(row, col, rows, cols);
+
+    if (rows >= cols) {
+        const auto half{rows / 16 * 8};
+        TransposeRecursive_(row, col, half, cols, base);
+        TransposeRecursive_(row + half, col, rows - half, cols, base);
+    } else {
+        const auto half{cols / 16 * 8};
+        TransposeRecursive_(row, col, rows, half, base);
+        TransposeRecursive_(row, col + half, rows, cols - half, base);
+    }
+}
+
+//* dst (cols x rows, ldd) = src (rows x cols, lds)^T, blocks of source rows in parallel
+template <typename T>
+void Transpose(const T* src, std::size_t lds, T* dst, std::size_t ldd, std::size_t rows, std::size_t cols,
+               rage::ThreadPool& pool)
+{
+    ForEachRowBlock(pool, rows, cols, [&](std::size_t first, std::size_t last) {
+        TransposeRecursive_(first, 0, last - first, cols, [&](std::size_t r, std::size_t c, std::size_t block_rows, std::size_t block_cols) {
+            simd::Transpose(src + r * lds + c, lds, dst + c * ldd + r, ldd, block_rows, block_cols);
+        });
+    });
+}
+
+//* dst (cols x rows, ldd) = get(r, c)^T, for sources that are not plain memory (morphed views)
+template <typename T, typename Get>
+void TransposeElements(const Get& get, T* dst, std::size_t ldd, std::size_t rows, std::size_t cols,
+                       rage::ThreadPool& pool)
+{
+    ForEachRowBlock(pool, rows, cols, [&](std::size_t first, std::size_t last) {
+        TransposeRecursive_(first, 0, last - first, cols, [&](std::size_t r, std::size_t c, std::size_t block_rows, std::size_t block_cols) {
+            for (std::size_t i{r}; i < r + block_rows; ++i) {
+                for (std::size_t j{c}; j < c + block_cols; ++j)
+                    dst[j * ldd + i] = static_cast<T>(get(i, j));
+            }
+        });
+    });
+}
+
+//* upper (rows x cols) and lower (cols x rows) become each other's transpose, through a leaf sized tile
+template <typename T>
+void SwapTransposed_(T* upper, T* lower, std::size_t ld, std::size_t rows, std::size_t cols, rage::ThreadPool& pool)
+{
+    ForEachRowBlock(pool, rows, cols, [&](std::size_t first, std::size_t last) {
+        TransposeRecursive_(first, 0, last - first, cols, [&](std::size_t r, std::size_t c, std::size_t block_rows, std::size_t block_cols) {
+            std::array<T, TransposeLeaf * TransposeLeaf> tile;
+            T* upper_block{upper + r * ld + c};
+            T* lower_block{lower + c * ld + r};
+            simd::Transpose(upper_block, ld, tile.data(), block_rows, block_rows, block_cols);
+            simd::Transpose(lower_block, ld, upper_block, ld, block_cols, block_rows);
+            for (std::size_t i{0}; i < block_cols; ++i)
+                std::copy(tile.data() + i * block_rows, tile.data() + (i + 1) * block_rows, lower_block + i * ld);
+        });
+    });
+}
+
+//* n x n at data (ld between rows), in place: the diagonal blocks recursively, the mirrored ones swapped
+template <typename T>
+void TransposeSquareInPlace(T* data, std::size_t ld, std::size_t n, rage::ThreadPool& pool)
+{
+    if (n <= TransposeLeaf) {
+        for (std::size_t r{0}; r < n; ++r) {
+            for (std::size_t c{r + 1}; c < n; ++c)
+                std::swap(data[r * ld + c], data[c * ld + r]);
+        }
+        return;
+    }
+
+    const auto half{n / 16 * 8};
+    TransposeSquareInPlace(data, ld, half, pool);
+    TransposeSquareInPlace(data + half * ld + half, ld, n - half, pool);
+    SwapTransposed_(data + half, data + half * ld, ld, half, n - half, pool);
+}
+
+//* rows x cols, unpadded, in place: the element at (r, c) moves to c * rows + r.
+//* Every permutation cycle is walked once, a bit per element (instead of a copy of the data) marks the visited ones.
+template <typename T>
+void TransposeCyclesInPlace(T* data, std::size_t rows, std::size_t cols)
+{
+    if (rows <= 1 || cols <= 1)
+        return; // same flat buffer
+
+    const auto size{rows * cols};
+    std::vector<bool> visited(size);
+    // the first and the last element never move
+    for (std::size_t start{1}; start + 1 < size; ++start) {
+        if (visited[start])
+            continue;
+
+        T carried{std::move(data[start])};
+        std::size_t i{start};
+        do {
+            const auto next{(i % cols) * rows + i / cols};
+            std::swap(data[next], carried);
+            visited[next] = true;
+            i = next;
+        } while (i != start);
+    }
+}
+
+} // namespace internal_impl